@@ -0,0 +1,83 @@
+#!/bin/bash
+# Generated-code quality: compiles the benchmark programs with --emit-stats=json
+# and compares each module total (runtime calls, heap allocations,
+# statement-expressions, temps, overflow checks) against a committed baseline.
+# Run from the repository root after building the compiler, or with
+# `make bench` from compiler/.
+#
+#   BASELINE_UPDATE=1  rewrite codegen_baseline.txt from this run
+#   PROFILE            --profile passed to the compiler (default debug)
+#   SN                 compiler to measure (default bin/sn)
+#
+# The counts are deterministic, so any increase is reported; a decrease means
+# the baseline should be refreshed to lock in the improvement.
+
+set -euo pipefail
+
+OUT=bin/bench/codegen
+SN="${SN:-bin/sn}"
+PROFILE="${PROFILE:-debug}"
+BASELINE=benchmarks/compiler/codegen_baseline.txt
+FIELDS="runtime_calls heap_allocations stmt_exprs nested_stmt_exprs max_stmt_expr_depth temps overflow_checks"
+
+mkdir -p "$OUT"
+
+# Extracts a numeric field from the "total" object of an --emit-stats=json report.
+total_field() {
+    grep -o '"total": {[^}]*' "$1" | grep -o "\"$2\": [0-9]*" | awk '{ print $2 }'
+}
+
+results=()
+printf "%-14s %9s %11s %10s %7s %9s %7s %9s\n" "program" "rt calls" "heap allocs" "stmt-exprs" "nested" "max depth" "temps" "overflow"
+for source in benchmarks/programs/*.sn; do
+    name=$(basename "$source" .sn)
+    if ! "$SN" "$source" -o "$OUT/$name.c" --profile="$PROFILE" --emit-stats=json 2> "$OUT/$name.json"; then
+        echo "compile failed: $source (see $OUT/$name.json)" >&2
+        exit 1
+    fi
+    values=()
+    for field in $FIELDS; do
+        values+=("$(total_field "$OUT/$name.json" "$field")")
+    done
+    printf "%-14s %9d %11d %10d %7d %9d %7d %9d\n" "$name" "${values[@]}"
+    results+=("$name ${values[*]}")
+done
+
+if [ "${BASELINE_UPDATE:-0}" = "1" ]; then
+    {
+        echo "# program $FIELDS -- written by BASELINE_UPDATE=1 benchmarks/compiler/codegen_stats.sh"
+        printf "%s\n" "${results[@]}"
+    } > "$BASELINE"
+    echo "baseline written to $BASELINE"
+    exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    echo "no baseline at $BASELINE; run with BASELINE_UPDATE=1 to create one"
+    exit 0
+fi
+
+failed=0
+for result in "${results[@]}"; do
+    read -r name current <<< "$result"
+    base=$(awk -v p="$name" '$1 == p { $1 = ""; print }' "$BASELINE")
+    if [ -z "$base" ]; then
+        echo "$name: no baseline entry"
+        continue
+    fi
+    read -r -a current_values <<< "$current"
+    read -r -a base_values <<< "$base"
+    i=0
+    for field in $FIELDS; do
+        if [ "${current_values[$i]}" -gt "${base_values[$i]}" ]; then
+            echo "REGRESSION $name: $field ${current_values[$i]}, baseline ${base_values[$i]}"
+            failed=1
+        fi
+        i=$((i + 1))
+    done
+done
+
+if [ "$failed" = "1" ]; then
+    exit 1
+fi
+echo "no generated-code regressions against $BASELINE"
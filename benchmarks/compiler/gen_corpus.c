@@ -0,0 +1,175 @@
+// gen_corpus.c
+// Writes a synthetic SN program whose size is controlled by one parameter, so
+// compile time can be measured as a function of N.
+//
+//   gen_corpus <shape> <n> <out_dir>
+//
+// Shapes:
+//   functions      n small functions, all called from main
+//   nesting        if/while blocks nested n deep
+//   interpolation  one interpolated string with n holes
+//   imports        n modules, each imported by main
+//   locals         one function with n locals, each using the previous one
+//   concat         one string built from n `+` operands
+//
+// The entry point is always <out_dir>/main.sn.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static FILE *open_output(const char *dir, const char *name)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+    return out;
+}
+
+static void indent(FILE *out, int depth)
+{
+    for (int i = 0; i < depth; i++)
+        fputs("  ", out);
+}
+
+static void gen_functions(FILE *out, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        fprintf(out, "fn f%d(x: int): int =>\n", i);
+        fprintf(out, "  var y: int = x * %d + 1\n", i % 7 + 1);
+        fprintf(out, "  if y > 1000 =>\n");
+        fprintf(out, "    return y - 1000\n");
+        fprintf(out, "  return y\n\n");
+    }
+    fprintf(out, "fn main(): void =>\n");
+    fprintf(out, "  var total: int = 0\n");
+    for (int i = 0; i < n; i++)
+        fprintf(out, "  total = total + f%d(%d)\n", i, i);
+    fprintf(out, "  print($\"{total}\\n\")\n");
+}
+
+static void gen_nesting(FILE *out, int n)
+{
+    fprintf(out, "fn main(): void =>\n");
+    fprintf(out, "  var depth: int = 0\n");
+    for (int i = 0; i < n; i++)
+    {
+        indent(out, i + 1);
+        if (i % 2 == 0)
+            fprintf(out, "if depth == %d =>\n", i);
+        else
+            fprintf(out, "while depth == %d =>\n", i);
+        indent(out, i + 2);
+        fprintf(out, "depth = depth + 1\n");
+    }
+    fprintf(out, "  print($\"{depth}\\n\")\n");
+}
+
+static void gen_interpolation(FILE *out, int n)
+{
+    fprintf(out, "fn main(): void =>\n");
+    fprintf(out, "  var a: int = 7\n");
+    fprintf(out, "  var s: str = \"x\"\n");
+    fprintf(out, "  var line: str = $\"");
+    for (int i = 0; i < n; i++)
+    {
+        if (i % 3 == 0)
+            fprintf(out, "a%d={a + %d} ", i, i);
+        else if (i % 3 == 1)
+            fprintf(out, "s{s}");
+        else
+            fprintf(out, "[{a:>8}]");
+    }
+    fprintf(out, "\"\n");
+    fprintf(out, "  print(line)\n");
+    fprintf(out, "  print(\"\\n\")\n");
+}
+
+static void gen_imports(const char *dir, FILE *out, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "mod%d.sn", i);
+        FILE *module = open_output(dir, name);
+        fprintf(module, "fn m%d(x: int): int =>\n", i);
+        fprintf(module, "  return x + %d\n", i);
+        fclose(module);
+        fprintf(out, "import \"mod%d\"\n", i);
+    }
+    fprintf(out, "\nfn main(): void =>\n");
+    fprintf(out, "  var total: int = 0\n");
+    for (int i = 0; i < n; i++)
+        fprintf(out, "  total = m%d(total)\n", i);
+    fprintf(out, "  print($\"{total}\\n\")\n");
+}
+
+static void gen_locals(FILE *out, int n)
+{
+    fprintf(out, "fn main(): void =>\n");
+    fprintf(out, "  var v0: int = 1\n");
+    for (int i = 1; i < n; i++)
+        fprintf(out, "  var v%d: int = v%d + %d\n", i, i - 1, i % 5);
+    fprintf(out, "  print($\"{v%d}\\n\")\n", n > 0 ? n - 1 : 0);
+}
+
+static void gen_concat(FILE *out, int n)
+{
+    fprintf(out, "fn main(): void =>\n");
+    fprintf(out, "  var n: int = 3\n");
+    fprintf(out, "  var s: str = \"start\"");
+    for (int i = 0; i < n; i++)
+    {
+        if (i % 2 == 0)
+            fprintf(out, " + \"p%d\"", i);
+        else
+            fprintf(out, " + n");
+    }
+    fprintf(out, "\n");
+    fprintf(out, "  print(s)\n");
+    fprintf(out, "  print(\"\\n\")\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s <functions|nesting|interpolation|imports|locals|concat> <n> <out_dir>\n", argv[0]);
+        return 1;
+    }
+    const char *shape = argv[1];
+    int n = atoi(argv[2]);
+    const char *dir = argv[3];
+    if (n < 1)
+    {
+        fprintf(stderr, "n must be positive\n");
+        return 1;
+    }
+
+    FILE *out = open_output(dir, "main.sn");
+    if (strcmp(shape, "functions") == 0)
+        gen_functions(out, n);
+    else if (strcmp(shape, "nesting") == 0)
+        gen_nesting(out, n);
+    else if (strcmp(shape, "interpolation") == 0)
+        gen_interpolation(out, n);
+    else if (strcmp(shape, "imports") == 0)
+        gen_imports(dir, out, n);
+    else if (strcmp(shape, "locals") == 0)
+        gen_locals(out, n);
+    else if (strcmp(shape, "concat") == 0)
+        gen_concat(out, n);
+    else
+    {
+        fprintf(stderr, "Unknown shape: %s\n", shape);
+        fclose(out);
+        return 1;
+    }
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#!/bin/bash
+# Compiler memory benchmark: compiles the generated corpora used by run.sh
+# with --time-passes=json and records peak RSS and the arena high-water mark,
+# normalised per source line. Run from the repository root after building the
+# compiler, or with `make bench` from compiler/.
+#
+#   BASELINE_UPDATE=1  rewrite memory_baseline.txt from this run
+#   MEM_TOLERANCE      allowed growth of arena bytes/line (default 0.10, i.e. 10%)
+#   RSS_TOLERANCE      allowed growth factor of peak-RSS bytes/line (default 1.5)
+#   SN                 compiler to benchmark (default bin/sn)
+#
+# Arena bytes are deterministic for a given compiler and input, so they get a
+# tight threshold. RSS also covers malloc, libc and any sanitizer runtime, and
+# varies between machines, so its threshold is looser.
+
+set -euo pipefail
+
+OUT=bin/bench/compiler
+SN="${SN:-bin/sn}"
+BASELINE=benchmarks/compiler/memory_baseline.txt
+MEM_TOLERANCE="${MEM_TOLERANCE:-0.10}"
+RSS_TOLERANCE="${RSS_TOLERANCE:-1.5}"
+
+SHAPES=(
+    "functions:250 500 1000 2000"
+    "nesting:250 500 1000 2000"
+    "interpolation:100 200 400 800"
+    "imports:250 500 1000 2000"
+    "locals:250 500 1000 2000"
+    "concat:125 250 500 1000"
+)
+
+mkdir -p "$OUT"
+gcc -O2 -std=c99 benchmarks/compiler/gen_corpus.c -o "$OUT/gen_corpus"
+
+# Extracts a numeric field from the "memory" object of a --time-passes=json report.
+memory_field() {
+    grep -o '"memory": {[^}]*}' "$1" | grep -o "\"$2\": [0-9.]*" | awk '{ print $2 }'
+}
+
+results=()
+printf "%-14s %6s %8s %14s %12s %14s\n" "shape" "N" "lines" "arena KiB" "arena B/line" "peak RSS KiB"
+for entry in "${SHAPES[@]}"; do
+    shape="${entry%%:*}"
+    for n in ${entry#*:}; do
+        dir="$OUT/mem-$shape-$n"
+        rm -rf "$dir"
+        mkdir -p "$dir"
+        "$OUT/gen_corpus" "$shape" "$n" "$dir"
+        if ! "$SN" "$dir/main.sn" -o "$dir/main.c" --time-passes=json 2> "$dir/report.json"; then
+            echo "compile failed: $dir/main.sn (see $dir/report.json)" >&2
+            exit 1
+        fi
+        lines=$(memory_field "$dir/report.json" source_lines)
+        arena=$(memory_field "$dir/report.json" arena_reserved_bytes)
+        arena_per_line=$(memory_field "$dir/report.json" arena_bytes_per_line)
+        rss_kb=$(memory_field "$dir/report.json" peak_rss_kb)
+        rss_per_line=$(memory_field "$dir/report.json" rss_bytes_per_line)
+        printf "%-14s %6d %8d %14.1f %12.0f %14d\n" "$shape" "$n" "$lines" \
+            "$(awk -v a="$arena" 'BEGIN { print a / 1024 }')" "$arena_per_line" "$rss_kb"
+        results+=("$shape $n $arena_per_line $rss_per_line")
+    done
+done
+
+if [ "${BASELINE_UPDATE:-0}" = "1" ]; then
+    {
+        echo "# shape n arena_bytes_per_line rss_bytes_per_line -- written by BASELINE_UPDATE=1 benchmarks/compiler/memory.sh"
+        printf "%s\n" "${results[@]}"
+    } > "$BASELINE"
+    echo "baseline written to $BASELINE"
+    exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    echo "no baseline at $BASELINE; run with BASELINE_UPDATE=1 to create one"
+    exit 0
+fi
+
+failed=0
+for result in "${results[@]}"; do
+    read -r shape n arena_per_line rss_per_line <<< "$result"
+    base=$(awk -v s="$shape" -v n="$n" '$1 == s && $2 == n { print $3, $4 }' "$BASELINE")
+    if [ -z "$base" ]; then
+        echo "$shape: no baseline entry for N=$n"
+        continue
+    fi
+    read -r base_arena base_rss <<< "$base"
+    if awk -v v="$arena_per_line" -v b="$base_arena" -v t="$MEM_TOLERANCE" 'BEGIN { exit !(v > b * (1 + t)) }'; then
+        echo "REGRESSION $shape N=$n: $arena_per_line arena bytes/line, baseline $base_arena"
+        failed=1
+    fi
+    if awk -v v="$rss_per_line" -v b="$base_rss" -v t="$RSS_TOLERANCE" 'BEGIN { exit !(v > b * t) }'; then
+        echo "REGRESSION $shape N=$n: $rss_per_line RSS bytes/line, baseline $base_rss"
+        failed=1
+    fi
+done
+
+if [ "$failed" = "1" ]; then
+    exit 1
+fi
+echo "no memory regressions against $BASELINE"
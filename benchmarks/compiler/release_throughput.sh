@@ -0,0 +1,61 @@
+#!/bin/bash
+# Compares compile throughput of the release compiler (bin/release/sn, built by
+# `make release`) with the AddressSanitizer build (bin/sn) on the largest corpus
+# of each shape run.sh uses. Run from the
+# repository root, or with `make release-bench` from compiler/.
+#
+#   BENCH_RUNS  compiles per point, the fastest is kept (default 3)
+
+set -euo pipefail
+
+OUT=bin/bench/release
+DEBUG_SN=bin/sn
+RELEASE_SN=bin/release/sn
+RUNS="${BENCH_RUNS:-3}"
+SHAPES=(functions:2000 nesting:2000 interpolation:800 imports:2000 locals:2000 concat:1000)
+
+mkdir -p "$OUT"
+gcc -O2 -std=c99 benchmarks/compiler/gen_corpus.c -o "$OUT/gen_corpus"
+
+# Prints the fastest of $RUNS compiles of $2/main.sn by compiler $1, in microseconds.
+time_compile() {
+    local sn="$1"
+    local dir="$2"
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local start end
+        start=$(date +%s%N)
+        if ! "$sn" "$dir/main.sn" -o "$dir/main.c" &> "$dir/sn-output.log"; then
+            echo "compile failed: $sn $dir/main.sn (see $dir/sn-output.log)" >&2
+            exit 1
+        fi
+        end=$(date +%s%N)
+        local us=$(( (end - start) / 1000 ))
+        if [ -z "$best" ] || [ "$us" -lt "$best" ]; then
+            best=$us
+        fi
+    done
+    echo "$best"
+}
+
+release_ratios=()
+printf "%-14s %6s %9s %12s %12s %8s\n" "shape" "N" "lines" "debug (us)" "release (us)" "speedup"
+for entry in "${SHAPES[@]}"; do
+    shape="${entry%%:*}"
+    n="${entry#*:}"
+    dir="$OUT/$shape-$n"
+    rm -rf "$dir"
+    mkdir -p "$dir"
+    "$OUT/gen_corpus" "$shape" "$n" "$dir"
+    lines=$(cat "$dir"/*.sn | wc -l)
+    debug_us=$(time_compile "$DEBUG_SN" "$dir")
+    release_us=$(time_compile "$RELEASE_SN" "$dir")
+    ratio=$(awk -v d="$debug_us" -v r="$release_us" 'BEGIN { printf "%.2f", d / (r > 0 ? r : 1) }')
+    printf "%-14s %6d %9d %12d %12d %7sx\n" "$shape" "$n" "$lines" "$debug_us" "$release_us" "$ratio"
+    release_ratios+=("$ratio")
+done
+
+geomean() {
+    printf "%s\n" "$@" | awk '{ sum += log($1); n++ } END { if (n) printf "%.2fx", exp(sum / n) }'
+}
+echo "geometric mean speedup over debug: release $(geomean "${release_ratios[@]}")"
@@ -0,0 +1,119 @@
+#!/bin/bash
+# Compile-throughput benchmark: times the full bin/sn pipeline over generated
+# corpora of doubling size and reports how compile time scales with N.
+# Run from the repository root after building the compiler (make -C compiler),
+# or with `make bench` from compiler/.
+#
+#   BASELINE_UPDATE=1  rewrite baseline.txt from this run instead of checking it
+#   BENCH_TOLERANCE    allowed slowdown against the baseline time (default 2.0)
+#   BENCH_RUNS         compiles per point, the fastest is kept (default 3)
+#   SN                 compiler to benchmark (default bin/sn)
+#
+# The scaling exponent is log2(t(2N) / t(N)) for the two largest sizes: ~1 is
+# linear, ~2 quadratic. It is compared against the baseline as well as the
+# absolute time, since it does not depend on the machine.
+
+set -euo pipefail
+
+OUT=bin/bench/compiler
+SN="${SN:-bin/sn}"
+BASELINE=benchmarks/compiler/baseline.txt
+TOLERANCE="${BENCH_TOLERANCE:-2.0}"
+RUNS="${BENCH_RUNS:-3}"
+EXPONENT_SLACK=0.5
+
+# shape and the sizes it is generated at (each double the previous)
+SHAPES=(
+    "functions:250 500 1000 2000"
+    "nesting:250 500 1000 2000"
+    "interpolation:100 200 400 800"
+    "imports:250 500 1000 2000"
+    "locals:250 500 1000 2000"
+    "concat:125 250 500 1000"
+)
+
+mkdir -p "$OUT"
+gcc -O2 -std=c99 benchmarks/compiler/gen_corpus.c -o "$OUT/gen_corpus"
+
+# Prints the fastest of $RUNS compiles of $1/main.sn, in microseconds.
+time_compile() {
+    local dir="$1"
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local start end
+        start=$(date +%s%N)
+        if ! "$SN" "$dir/main.sn" -o "$dir/main.c" &> "$dir/sn-output.log"; then
+            echo "compile failed: $dir/main.sn (see $dir/sn-output.log)" >&2
+            exit 1
+        fi
+        end=$(date +%s%N)
+        local us=$(( (end - start) / 1000 ))
+        if [ -z "$best" ] || [ "$us" -lt "$best" ]; then
+            best=$us
+        fi
+    done
+    echo "$best"
+}
+
+results=()
+printf "%-14s %6s %12s %9s\n" "shape" "N" "time (us)" "exponent"
+for entry in "${SHAPES[@]}"; do
+    shape="${entry%%:*}"
+    prev=""
+    exponent="-"
+    for n in ${entry#*:}; do
+        dir="$OUT/$shape-$n"
+        rm -rf "$dir"
+        mkdir -p "$dir"
+        "$OUT/gen_corpus" "$shape" "$n" "$dir"
+        us=$(time_compile "$dir")
+        if [ -n "$prev" ]; then
+            exponent=$(awk -v a="$prev" -v b="$us" 'BEGIN { printf "%.2f", log((b > 0 ? b : 1) / (a > 0 ? a : 1)) / log(2) }')
+        fi
+        printf "%-14s %6d %12d %9s\n" "$shape" "$n" "$us" "$exponent"
+        prev=$us
+        last_n=$n
+    done
+    if awk -v e="$exponent" 'BEGIN { exit !(e > 1.5) }'; then
+        echo "  note: $shape scales superlinearly (exponent $exponent)"
+    fi
+    results+=("$shape $last_n $prev $exponent")
+done
+
+if [ "${BASELINE_UPDATE:-0}" = "1" ]; then
+    {
+        echo "# shape largest_n time_us exponent -- written by BASELINE_UPDATE=1 benchmarks/compiler/run.sh"
+        printf "%s\n" "${results[@]}"
+    } > "$BASELINE"
+    echo "baseline written to $BASELINE"
+    exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    echo "no baseline at $BASELINE; run with BASELINE_UPDATE=1 to create one"
+    exit 0
+fi
+
+failed=0
+for result in "${results[@]}"; do
+    read -r shape n us exponent <<< "$result"
+    base=$(awk -v s="$shape" -v n="$n" '$1 == s && $2 == n { print $3, $4 }' "$BASELINE")
+    if [ -z "$base" ]; then
+        echo "$shape: no baseline entry for N=$n"
+        continue
+    fi
+    read -r base_us base_exponent <<< "$base"
+    if awk -v us="$us" -v b="$base_us" -v t="$TOLERANCE" 'BEGIN { exit !(us > b * t) }'; then
+        echo "REGRESSION $shape: ${us} us at N=$n, baseline ${base_us} us (tolerance ${TOLERANCE}x)"
+        failed=1
+    fi
+    if awk -v e="$exponent" -v b="$base_exponent" -v s="$EXPONENT_SLACK" 'BEGIN { exit !(e > b + s) }'; then
+        echo "REGRESSION $shape: scaling exponent $exponent, baseline $base_exponent"
+        failed=1
+    fi
+done
+
+if [ "$failed" = "1" ]; then
+    exit 1
+fi
+echo "no regressions against $BASELINE"
@@ -0,0 +1,35 @@
+#!/bin/bash
+# Times hashed map lookups against a linear scan over the same entries.
+# Run from the repository root after building the compiler (make -C compiler).
+
+set -euo pipefail
+
+OUT=bin/bench/map
+mkdir -p "$OUT"
+
+run() {
+    local name="$1"
+    bin/sn "benchmarks/map/$name.sn" -o "$OUT/$name.c" --profile=release
+    gcc -O2 -std=c99 -D_GNU_SOURCE "$OUT/$name.c" compiler/runtime.c -o "$OUT/$name"
+    local start end
+    start=$(date +%s%N)
+    local result
+    result=$("$OUT/$name")
+    end=$(date +%s%N)
+    echo "$name $result $(( (end - start) / 1000 ))"
+}
+
+hashed=$(run map_lookup)
+linear=$(run map_lookup_linear)
+
+read -r _ hashed_sum hashed_us <<< "$hashed"
+read -r _ linear_sum linear_us <<< "$linear"
+
+if [ "$hashed_sum" != "$linear_sum" ]; then
+    echo "checksum mismatch: $hashed_sum vs $linear_sum" >&2
+    exit 1
+fi
+
+echo "map_lookup:        ${hashed_us} us"
+echo "map_lookup_linear: ${linear_us} us"
+awk -v h="$hashed_us" -v l="$linear_us" 'BEGIN { printf "speedup:           %.1fx\n", l / (h > 0 ? h : 1) }'
@@ -0,0 +1,11 @@
+// Hand-written C counterpart of harmonic.sn.
+#include <stdio.h>
+
+int main(void)
+{
+    double sum = 0.0;
+    for (double k = 1.0; k <= 30000000.0; k += 1.0)
+        sum += 1.0 / k;
+    printf("%.5f\n", sum);
+    return 0;
+}
@@ -0,0 +1,11 @@
+// Hand-written C counterpart of loop_sum.sn.
+#include <stdio.h>
+
+int main(void)
+{
+    long sum = 0;
+    for (long i = 0; i < 50000000; i++)
+        sum = (sum + i * 7) % 1000000007;
+    printf("%ld\n", sum);
+    return 0;
+}
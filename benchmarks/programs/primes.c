@@ -0,0 +1,23 @@
+// Hand-written C counterpart of primes.sn.
+#include <stdio.h>
+
+int main(void)
+{
+    long count = 0;
+    for (long n = 2; n < 1000000; n++)
+    {
+        int prime = 1;
+        for (long d = 2; d * d <= n; d++)
+        {
+            if (n % d == 0)
+            {
+                prime = 0;
+                break;
+            }
+        }
+        if (prime)
+            count++;
+    }
+    printf("%ld\n", count);
+    return 0;
+}
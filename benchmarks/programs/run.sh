@@ -0,0 +1,61 @@
+#!/bin/bash
+# Times each SN program in benchmarks/programs against its hand-written C
+# counterpart and reports how much slower the generated code is.
+# Run from the repository root after building the compiler (make -C compiler).
+#
+#   PROFILE      --profile passed to bin/sn (default release)
+#   BENCH_CFLAGS flags for both C builds (default -O2 -std=c99 -D_GNU_SOURCE)
+#   BENCH_RUNS   runs per binary, the fastest is kept (default 3)
+#
+# Both binaries must print the same output; a mismatch fails the run.
+
+set -euo pipefail
+
+OUT=bin/bench/programs
+PROFILE="${PROFILE:-release}"
+CFLAGS="${BENCH_CFLAGS:--O2 -std=c99 -D_GNU_SOURCE}"
+RUNS="${BENCH_RUNS:-3}"
+
+mkdir -p "$OUT"
+
+# Prints the fastest of $RUNS runs of $1 in microseconds; output goes to $2.
+time_run() {
+    local exe="$1"
+    local output="$2"
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local start end
+        start=$(date +%s%N)
+        "$exe" > "$output"
+        end=$(date +%s%N)
+        local us=$(( (end - start) / 1000 ))
+        if [ -z "$best" ] || [ "$us" -lt "$best" ]; then
+            best=$us
+        fi
+    done
+    echo "$best"
+}
+
+ratios=()
+printf "%-14s %12s %12s %8s\n" "program" "SN (us)" "C (us)" "ratio"
+for source in benchmarks/programs/*.sn; do
+    name=$(basename "$source" .sn)
+    bin/sn "$source" -o "$OUT/$name.sn.c" --profile="$PROFILE" &> "$OUT/$name.sn.log"
+    # shellcheck disable=SC2086
+    gcc $CFLAGS "$OUT/$name.sn.c" compiler/runtime.c -o "$OUT/${name}_sn"
+    # shellcheck disable=SC2086
+    gcc $CFLAGS "benchmarks/programs/$name.c" -o "$OUT/${name}_c"
+
+    sn_us=$(time_run "$OUT/${name}_sn" "$OUT/$name.sn.out")
+    c_us=$(time_run "$OUT/${name}_c" "$OUT/$name.c.out")
+    if ! cmp -s "$OUT/$name.sn.out" "$OUT/$name.c.out"; then
+        echo "output mismatch for $name: see $OUT/$name.sn.out and $OUT/$name.c.out" >&2
+        exit 1
+    fi
+
+    ratio=$(awk -v s="$sn_us" -v c="$c_us" 'BEGIN { printf "%.2f", s / (c > 0 ? c : 1) }')
+    printf "%-14s %12d %12d %7sx\n" "$name" "$sn_us" "$c_us" "$ratio"
+    ratios+=("$ratio")
+done
+
+printf "%s\n" "${ratios[@]}" | awk '{ sum += log($1); n++ } END { if (n) printf "geometric mean slowdown: %.2fx\n", exp(sum / n) }'
@@ -0,0 +1,36 @@
+// Hand-written C counterpart of string_build.sn, using a growing buffer as C
+// code normally would.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(void)
+{
+    size_t capacity = 64;
+    size_t length = 0;
+    char *s = malloc(capacity);
+    if (s == NULL)
+        return 1;
+    s[0] = '\0';
+    for (long i = 0; i < 20000; i++)
+    {
+        char piece[32];
+        int n = snprintf(piece, sizeof(piece), "%ld,", i);
+        if (length + (size_t)n + 1 > capacity)
+        {
+            capacity *= 2;
+            char *grown = realloc(s, capacity);
+            if (grown == NULL)
+            {
+                free(s);
+                return 1;
+            }
+            s = grown;
+        }
+        memcpy(s + length, piece, (size_t)n + 1);
+        length += (size_t)n;
+    }
+    printf("%s\n", s);
+    free(s);
+    return 0;
+}
@@ -0,0 +1,182 @@
+// runtime_bench.c
+// Micro-benchmarks for the rt_* helpers that generated code calls, each run in
+// isolation through the same harness as SN `bench` blocks (warmup, iteration
+// calibration, median/p99/min over up to 100 samples).
+//
+// Build and run with `make runtime-bench` from compiler/. SN_BENCH=<substring>
+// selects benchmarks and SN_BENCH_FORMAT=json switches to JSON lines. Print
+// helpers write into /dev/null; the report goes to the original stdout.
+#include "runtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Inputs are read through volatiles so the compiler cannot constant-fold the
+// calls, and results are stored to volatiles so they are not discarded.
+static volatile long in_a = 123456789L;
+static volatile long in_b = 97L;
+static volatile double in_x = 1234.5678;
+static volatile double in_y = 3.25;
+static volatile long sink_long;
+static volatile double sink_double;
+
+static char *str_8;
+static char *str_64;
+static char *str_1k;
+static char *str_16k;
+static char *str_64_copy;
+static char *str_1k_copy;
+static char *str_1k_late; // Differs from str_1k only in its last character
+
+static char *make_string(size_t length, char last)
+{
+    char *s = malloc(length + 1);
+    if (s == NULL)
+    {
+        perror("malloc");
+        exit(1);
+    }
+    for (size_t i = 0; i < length; i++)
+        s[i] = (char)('a' + i % 26);
+    if (length > 0)
+        s[length - 1] = last;
+    s[length] = '\0';
+    return s;
+}
+
+static void bench_add_long(void) { sink_long = rt_add_long(in_a, in_b); }
+static void bench_sub_long(void) { sink_long = rt_sub_long(in_a, in_b); }
+static void bench_mul_long(void) { sink_long = rt_mul_long(in_a, in_b); }
+static void bench_div_long(void) { sink_long = rt_div_long(in_a, in_b); }
+static void bench_mod_long(void) { sink_long = rt_mod_long(in_a, in_b); }
+static void bench_neg_long(void) { sink_long = rt_neg_long(in_a); }
+static void bench_eq_long(void) { sink_long = rt_eq_long(in_a, in_b); }
+static void bench_add_double(void) { sink_double = rt_add_double(in_x, in_y); }
+static void bench_sub_double(void) { sink_double = rt_sub_double(in_x, in_y); }
+static void bench_mul_double(void) { sink_double = rt_mul_double(in_x, in_y); }
+static void bench_div_double(void) { sink_double = rt_div_double(in_x, in_y); }
+static void bench_lt_double(void) { sink_long = rt_lt_double(in_x, in_y); }
+
+static void bench_post_inc_long(void)
+{
+    long value = in_a;
+    sink_long = rt_post_inc_long(&value) + value;
+}
+
+static void bench_array_index(void) { sink_long = rt_array_index(in_b, in_a); }
+
+static void concat_and_free(const char *left, const char *right)
+{
+    char *s = rt_str_concat(left, right);
+    sink_long = (long)s[0];
+    rt_free_string(s);
+}
+
+static void bench_concat_8(void) { concat_and_free(str_8, str_8); }
+static void bench_concat_64(void) { concat_and_free(str_64, str_64); }
+static void bench_concat_1k(void) { concat_and_free(str_1k, str_1k); }
+static void bench_concat_16k(void) { concat_and_free(str_16k, str_16k); }
+
+static void consume_string(char *s)
+{
+    sink_long = (long)s[0];
+    rt_free_string(s);
+}
+
+static void bench_to_string_long(void) { consume_string(rt_to_string_long(in_a)); }
+static void bench_to_string_double(void) { consume_string(rt_to_string_double(in_x)); }
+static void bench_to_string_char(void) { consume_string(rt_to_string_char((char)in_b)); }
+static void bench_to_string_bool(void) { consume_string(rt_to_string_bool((int)(in_b & 1))); }
+static void bench_to_string_string(void) { consume_string(rt_to_string_string(str_64)); }
+
+static void bench_format_long(void) { consume_string(rt_format_long(in_a, 16, 0, 0, 12, '0', '>')); }
+static void bench_format_double(void) { consume_string(rt_format_double(in_x, 2, 0, 12, ' ', '>')); }
+
+static void bench_print_long(void) { rt_print_long(in_a); }
+static void bench_print_double(void) { rt_print_double(in_x); }
+static void bench_print_char(void) { rt_print_char(in_b); }
+static void bench_print_string(void) { rt_print_string(str_64); }
+static void bench_print_bool(void) { rt_print_bool(in_b); }
+
+static void bench_eq_string_64(void) { sink_long = rt_eq_string(str_64, str_64_copy); }
+static void bench_eq_string_1k(void) { sink_long = rt_eq_string(str_1k, str_1k_copy); }
+static void bench_ne_string_1k_late(void) { sink_long = rt_ne_string(str_1k, str_1k_late); }
+static void bench_lt_string_64(void) { sink_long = rt_lt_string(str_64, str_64_copy); }
+
+typedef struct
+{
+    const char *name;
+    void (*body)(void);
+} RuntimeBench;
+
+static const RuntimeBench benches[] = {
+    {"add_long", bench_add_long},
+    {"sub_long", bench_sub_long},
+    {"mul_long", bench_mul_long},
+    {"div_long", bench_div_long},
+    {"mod_long", bench_mod_long},
+    {"neg_long", bench_neg_long},
+    {"eq_long", bench_eq_long},
+    {"post_inc_long", bench_post_inc_long},
+    {"array_index", bench_array_index},
+    {"add_double", bench_add_double},
+    {"sub_double", bench_sub_double},
+    {"mul_double", bench_mul_double},
+    {"div_double", bench_div_double},
+    {"lt_double", bench_lt_double},
+    {"str_concat_8", bench_concat_8},
+    {"str_concat_64", bench_concat_64},
+    {"str_concat_1k", bench_concat_1k},
+    {"str_concat_16k", bench_concat_16k},
+    {"to_string_long", bench_to_string_long},
+    {"to_string_double", bench_to_string_double},
+    {"to_string_char", bench_to_string_char},
+    {"to_string_bool", bench_to_string_bool},
+    {"to_string_string_64", bench_to_string_string},
+    {"format_long_hex_w12", bench_format_long},
+    {"format_double_p2_w12", bench_format_double},
+    {"print_long", bench_print_long},
+    {"print_double", bench_print_double},
+    {"print_char", bench_print_char},
+    {"print_string_64", bench_print_string},
+    {"print_bool", bench_print_bool},
+    {"eq_string_64", bench_eq_string_64},
+    {"eq_string_1k", bench_eq_string_1k},
+    {"ne_string_1k_last_char", bench_ne_string_1k_late},
+    {"lt_string_64", bench_lt_string_64},
+};
+
+int main(void)
+{
+    str_8 = make_string(8, 'z');
+    str_64 = make_string(64, 'z');
+    str_1k = make_string(1024, 'z');
+    str_16k = make_string(16384, 'z');
+    str_64_copy = make_string(64, 'z');
+    str_1k_copy = make_string(1024, 'z');
+    str_1k_late = make_string(1024, 'y');
+
+    // Keep the report on the real stdout, then point stdout at /dev/null so the
+    // print helpers pay for formatting and buffering but not for a terminal.
+    FILE *report = fdopen(dup(STDOUT_FILENO), "w");
+    if (report == NULL || freopen("/dev/null", "w", stdout) == NULL)
+    {
+        perror("redirecting stdout");
+        return 1;
+    }
+    rt_bench_set_output(report);
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+        rt_bench_run(benches[i].name, benches[i].body);
+
+    fclose(report);
+    free(str_8);
+    free(str_64);
+    free(str_1k);
+    free(str_16k);
+    free(str_64_copy);
+    free(str_1k_copy);
+    free(str_1k_late);
+    return 0;
+}
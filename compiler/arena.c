@@ -31,6 +31,9 @@ void arena_init(Arena *arena, size_t initial_block_size)
     arena->first->next = NULL;
     arena->current = arena->first;
     arena->current_used = 0;
+    arena->total_allocated = 0;
+    arena->total_reserved = initial_block_size;
+    arena->alloc_count = 0;
 }
 
 void *arena_alloc(Arena *arena, size_t size)
@@ -63,10 +66,13 @@ void *arena_alloc(Arena *arena, size_t size)
         arena->current = new_block;
         arena->current_used = 0;
         arena->block_size = new_block_size;
+        arena->total_reserved += new_block_size;
     }
 
     void *ptr = arena->current->data + arena->current_used;
     arena->current_used += size;
+    arena->total_allocated += size;
+    arena->alloc_count++;
     return ptr;
 }
 
@@ -133,4 +139,7 @@ void arena_free(Arena *arena)
     arena->current = NULL;
     arena->current_used = 0;
     arena->block_size = 0;
+    arena->total_allocated = 0;
+    arena->total_reserved = 0;
+    arena->alloc_count = 0;
 }
\ No newline at end of file
@@ -17,6 +17,9 @@ typedef struct
     Block *current;
     size_t current_used;
     size_t block_size;
+    size_t total_allocated; // Aligned bytes handed out over the arena's lifetime
+    size_t total_reserved;  // Bytes of all blocks obtained from malloc (the arena's high-water mark)
+    size_t alloc_count;     // Calls to arena_alloc, strdup and strndup included
 } Arena;
 
 void arena_init(Arena *arena, size_t initial_block_size);
@@ -20,7 +20,8 @@ void ast_print_stmt(Arena *arena, Stmt *stmt, int indent_level)
         break;
 
     case STMT_VAR_DECL:
-        DEBUG_VERBOSE_INDENT(indent_level, "VarDecl: %.*s (type: %s)",
+        DEBUG_VERBOSE_INDENT(indent_level, "%s: %.*s (type: %s)",
+                             stmt->as.var_decl.is_const ? "ConstDecl" : "VarDecl",
                              stmt->as.var_decl.name.length,
                              stmt->as.var_decl.name.start,
                              ast_type_to_string(arena, stmt->as.var_decl.type));
@@ -47,6 +48,10 @@ void ast_print_stmt(Arena *arena, Stmt *stmt, int indent_level)
                                      ast_type_to_string(arena, stmt->as.function.params[i].type));
             }
         }
+        if (stmt->as.function.annotations != FUNC_ANNOTATION_NONE)
+        {
+            DEBUG_VERBOSE_INDENT(indent_level + 1, "Annotations: 0x%x", stmt->as.function.annotations);
+        }
         DEBUG_VERBOSE_INDENT(indent_level + 1, "Body:");
         for (int i = 0; i < stmt->as.function.body_count; i++)
         {
@@ -112,6 +117,48 @@ void ast_print_stmt(Arena *arena, Stmt *stmt, int indent_level)
         ast_print_stmt(arena, stmt->as.for_stmt.body, indent_level + 2);
         break;
 
+    case STMT_VAR_TUPLE:
+        DEBUG_VERBOSE_INDENT(indent_level, "VarTuple:");
+        for (int i = 0; i < stmt->as.var_tuple.name_count; i++)
+        {
+            DEBUG_VERBOSE_INDENT(indent_level + 1, "Name: %.*s",
+                                 stmt->as.var_tuple.names[i].length,
+                                 stmt->as.var_tuple.names[i].start);
+        }
+        DEBUG_VERBOSE_INDENT(indent_level + 1, "Initializer:");
+        ast_print_expr(arena, stmt->as.var_tuple.initializer, indent_level + 2);
+        break;
+
+    case STMT_MATCH:
+        DEBUG_VERBOSE_INDENT(indent_level, "Match:");
+        DEBUG_VERBOSE_INDENT(indent_level + 1, "Subject:");
+        ast_print_expr(arena, stmt->as.match_stmt.subject, indent_level + 2);
+        for (int i = 0; i < stmt->as.match_stmt.case_count; i++)
+        {
+            MatchCase *match_case = &stmt->as.match_stmt.cases[i];
+            DEBUG_VERBOSE_INDENT(indent_level + 1, "Case:");
+            for (int j = 0; j < match_case->value_count; j++)
+            {
+                ast_print_expr(arena, match_case->values[j], indent_level + 2);
+            }
+            DEBUG_VERBOSE_INDENT(indent_level + 1, "Body:");
+            ast_print_stmt(arena, match_case->body, indent_level + 2);
+        }
+        if (stmt->as.match_stmt.else_branch)
+        {
+            DEBUG_VERBOSE_INDENT(indent_level + 1, "Else:");
+            ast_print_stmt(arena, stmt->as.match_stmt.else_branch, indent_level + 2);
+        }
+        break;
+
+    case STMT_BENCH:
+        DEBUG_VERBOSE_INDENT(indent_level, "Bench: %s", stmt->as.bench.name);
+        for (int i = 0; i < stmt->as.bench.body_count; i++)
+        {
+            ast_print_stmt(arena, stmt->as.bench.body[i], indent_level + 1);
+        }
+        break;
+
     case STMT_IMPORT:
         DEBUG_VERBOSE_INDENT(indent_level, "Import: %.*s",
                              stmt->as.import.module_name.length,
@@ -230,6 +277,14 @@ void ast_print_expr(Arena *arena, Expr *expr, int indent_level)
                              expr->as.member.name.length,
                              expr->as.member.name.start);
         break;
+
+    case EXPR_TUPLE:
+        DEBUG_VERBOSE_INDENT(indent_level, "Tuple:");
+        for (int i = 0; i < expr->as.tuple.element_count; i++)
+        {
+            ast_print_expr(arena, expr->as.tuple.elements[i], indent_level + 1);
+        }
+        break;
     }
 }
 
@@ -299,6 +354,25 @@ Type *ast_clone_type(Arena *arena, Type *type)
         clone->as.array.element_type = ast_clone_type(arena, type->as.array.element_type);
         break;
 
+    case TYPE_MAP:
+        clone->as.map.key_type = ast_clone_type(arena, type->as.map.key_type);
+        clone->as.map.value_type = ast_clone_type(arena, type->as.map.value_type);
+        break;
+
+    case TYPE_TUPLE:
+        clone->as.tuple.element_count = type->as.tuple.element_count;
+        clone->as.tuple.element_types = arena_alloc(arena, sizeof(Type *) * type->as.tuple.element_count);
+        if (clone->as.tuple.element_types == NULL)
+        {
+            DEBUG_ERROR("Out of memory when cloning tuple element types");
+            exit(1);
+        }
+        for (int i = 0; i < type->as.tuple.element_count; i++)
+        {
+            clone->as.tuple.element_types[i] = ast_clone_type(arena, type->as.tuple.element_types[i]);
+        }
+        break;
+
     case TYPE_FUNCTION:
         clone->as.function.return_type = ast_clone_type(arena, type->as.function.return_type);
         clone->as.function.param_count = type->as.function.param_count;
@@ -315,6 +389,7 @@ Type *ast_clone_type(Arena *arena, Type *type)
             {
                 clone->as.function.param_types[i] = ast_clone_type(arena, type->as.function.param_types[i]);
             }
+            clone->as.function.param_refs = type->as.function.param_refs;
         }
         else
         {
@@ -353,6 +428,36 @@ Type *ast_create_array_type(Arena *arena, Type *element_type)
     return type;
 }
 
+Type *ast_create_map_type(Arena *arena, Type *key_type, Type *value_type)
+{
+    Type *type = arena_alloc(arena, sizeof(Type));
+    if (type == NULL)
+    {
+        DEBUG_ERROR("Out of memory");
+        exit(1);
+    }
+    memset(type, 0, sizeof(Type));
+    type->kind = TYPE_MAP;
+    type->as.map.key_type = key_type;
+    type->as.map.value_type = value_type;
+    return type;
+}
+
+Type *ast_create_tuple_type(Arena *arena, Type **element_types, int element_count)
+{
+    Type *type = arena_alloc(arena, sizeof(Type));
+    if (type == NULL)
+    {
+        DEBUG_ERROR("Out of memory");
+        exit(1);
+    }
+    memset(type, 0, sizeof(Type));
+    type->kind = TYPE_TUPLE;
+    type->as.tuple.element_types = element_types;
+    type->as.tuple.element_count = element_count;
+    return type;
+}
+
 Type *ast_create_function_type(Arena *arena, Type *return_type, Type **param_types, int param_count)
 {
     Type *type = arena_alloc(arena, sizeof(Type));
@@ -406,6 +511,18 @@ int ast_type_equals(Type *a, Type *b)
     {
     case TYPE_ARRAY:
         return ast_type_equals(a->as.array.element_type, b->as.array.element_type);
+    case TYPE_MAP:
+        return ast_type_equals(a->as.map.key_type, b->as.map.key_type) &&
+               ast_type_equals(a->as.map.value_type, b->as.map.value_type);
+    case TYPE_TUPLE:
+        if (a->as.tuple.element_count != b->as.tuple.element_count)
+            return 0;
+        for (int i = 0; i < a->as.tuple.element_count; i++)
+        {
+            if (!ast_type_equals(a->as.tuple.element_types[i], b->as.tuple.element_types[i]))
+                return 0;
+        }
+        return 1;
     case TYPE_FUNCTION:
         if (!ast_type_equals(a->as.function.return_type, b->as.function.return_type))
             return 0;
@@ -415,6 +532,10 @@ int ast_type_equals(Type *a, Type *b)
         {
             if (!ast_type_equals(a->as.function.param_types[i], b->as.function.param_types[i]))
                 return 0;
+            bool a_ref = a->as.function.param_refs && a->as.function.param_refs[i];
+            bool b_ref = b->as.function.param_refs && b->as.function.param_refs[i];
+            if (a_ref != b_ref)
+                return 0;
         }
         return 1;
     default:
@@ -464,6 +585,49 @@ const char *ast_type_to_string(Arena *arena, Type *type)
         return str;
     }
 
+    case TYPE_MAP:
+    {
+        const char *key_str = ast_type_to_string(arena, type->as.map.key_type);
+        const char *value_str = ast_type_to_string(arena, type->as.map.value_type);
+        size_t len = strlen("map<, >") + strlen(key_str) + strlen(value_str) + 1;
+        char *str = arena_alloc(arena, len);
+        if (str == NULL)
+        {
+            DEBUG_ERROR("Out of memory");
+            exit(1);
+        }
+        snprintf(str, len, "map<%s, %s>", key_str, value_str);
+        return str;
+    }
+
+    case TYPE_TUPLE:
+    {
+        size_t len = strlen("()") + 1;
+        const char **element_strs = arena_alloc(arena, sizeof(char *) * type->as.tuple.element_count);
+        for (int i = 0; i < type->as.tuple.element_count; i++)
+        {
+            element_strs[i] = ast_type_to_string(arena, type->as.tuple.element_types[i]);
+            len += strlen(element_strs[i]) + 2;
+        }
+        char *str = arena_alloc(arena, len);
+        if (str == NULL)
+        {
+            DEBUG_ERROR("Out of memory");
+            exit(1);
+        }
+        strcpy(str, "(");
+        for (int i = 0; i < type->as.tuple.element_count; i++)
+        {
+            if (i > 0)
+            {
+                strcat(str, ", ");
+            }
+            strcat(str, element_strs[i]);
+        }
+        strcat(str, ")");
+        return str;
+    }
+
     case TYPE_FUNCTION:
     {
         size_t params_len = 0;
@@ -709,6 +873,23 @@ Expr *ast_create_array_expr(Arena *arena, Expr **elements, int element_count, co
     return expr;
 }
 
+Expr *ast_create_tuple_expr(Arena *arena, Expr **elements, int element_count, const Token *loc_token)
+{
+    Expr *expr = arena_alloc(arena, sizeof(Expr));
+    if (expr == NULL)
+    {
+        DEBUG_ERROR("Out of memory");
+        exit(1);
+    }
+    memset(expr, 0, sizeof(Expr));
+    expr->type = EXPR_TUPLE;
+    expr->as.tuple.elements = elements;
+    expr->as.tuple.element_count = element_count;
+    expr->expr_type = NULL;
+    expr->token = ast_dup_token(arena, loc_token);
+    return expr;
+}
+
 Expr *ast_create_array_access_expr(Arena *arena, Expr *array, Expr *index, const Token *loc_token)
 {
     if (array == NULL || index == NULL)
@@ -770,7 +951,7 @@ Expr *ast_create_decrement_expr(Arena *arena, Expr *operand, const Token *loc_to
     return expr;
 }
 
-Expr *ast_create_interpolated_expr(Arena *arena, Expr **parts, int part_count, const Token *loc_token)
+Expr *ast_create_interpolated_expr(Arena *arena, Expr **parts, FormatSpec **specs, int part_count, const Token *loc_token)
 {
     Expr *expr = arena_alloc(arena, sizeof(Expr));
     if (expr == NULL)
@@ -781,6 +962,7 @@ Expr *ast_create_interpolated_expr(Arena *arena, Expr **parts, int part_count, c
     memset(expr, 0, sizeof(Expr));
     expr->type = EXPR_INTERPOLATED;
     expr->as.interpol.parts = parts;
+    expr->as.interpol.specs = specs;
     expr->as.interpol.part_count = part_count;
     expr->expr_type = NULL;
     expr->token = ast_dup_token(arena, loc_token);
@@ -882,6 +1064,7 @@ Stmt *ast_create_function_stmt(Arena *arena, Token name, Parameter *params, int
             new_params[i].name.type = params[i].name.type;
             new_params[i].name.filename = params[i].name.filename; // Added for location reporting.
             new_params[i].type = params[i].type;
+            new_params[i].is_ref = params[i].is_ref;
         }
         stmt->as.function.params = new_params;
     }
@@ -992,6 +1175,70 @@ Stmt *ast_create_for_stmt(Arena *arena, Stmt *initializer, Expr *condition, Expr
     return stmt;
 }
 
+Stmt *ast_create_var_tuple_stmt(Arena *arena, Token *names, int name_count, Expr *initializer, const Token *loc_token)
+{
+    if (initializer == NULL)
+    {
+        return NULL;
+    }
+    Stmt *stmt = arena_alloc(arena, sizeof(Stmt));
+    if (stmt == NULL)
+    {
+        DEBUG_ERROR("Out of memory");
+        exit(1);
+    }
+    memset(stmt, 0, sizeof(Stmt));
+    stmt->type = STMT_VAR_TUPLE;
+    stmt->as.var_tuple.names = names;
+    stmt->as.var_tuple.name_count = name_count;
+    stmt->as.var_tuple.initializer = initializer;
+    stmt->token = ast_dup_token(arena, loc_token);
+    return stmt;
+}
+
+Stmt *ast_create_match_stmt(Arena *arena, Expr *subject, MatchCase *cases, int case_count, Stmt *else_branch, const Token *loc_token)
+{
+    if (subject == NULL)
+    {
+        return NULL;
+    }
+    Stmt *stmt = arena_alloc(arena, sizeof(Stmt));
+    if (stmt == NULL)
+    {
+        DEBUG_ERROR("Out of memory");
+        exit(1);
+    }
+    memset(stmt, 0, sizeof(Stmt));
+    stmt->type = STMT_MATCH;
+    stmt->as.match_stmt.subject = subject;
+    stmt->as.match_stmt.cases = cases;
+    stmt->as.match_stmt.case_count = case_count;
+    stmt->as.match_stmt.else_branch = else_branch;
+    stmt->token = ast_dup_token(arena, loc_token);
+    return stmt;
+}
+
+Stmt *ast_create_bench_stmt(Arena *arena, char *name, Stmt **body, int body_count, const Token *loc_token)
+{
+    if (name == NULL)
+    {
+        return NULL;
+    }
+    Stmt *stmt = arena_alloc(arena, sizeof(Stmt));
+    if (stmt == NULL)
+    {
+        DEBUG_ERROR("Out of memory");
+        exit(1);
+    }
+    memset(stmt, 0, sizeof(Stmt));
+    stmt->type = STMT_BENCH;
+    stmt->as.bench.name = name;
+    stmt->as.bench.body = body;
+    stmt->as.bench.body_count = body_count;
+    stmt->token = ast_dup_token(arena, loc_token);
+    return stmt;
+}
+
 Stmt *ast_create_import_stmt(Arena *arena, Token module_name, const Token *loc_token)
 {
     Stmt *stmt = arena_alloc(arena, sizeof(Stmt));
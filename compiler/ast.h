@@ -28,6 +28,8 @@ typedef enum
     TYPE_BOOL,
     TYPE_VOID,
     TYPE_ARRAY,
+    TYPE_MAP,
+    TYPE_TUPLE,
     TYPE_FUNCTION,
     TYPE_NIL,
     TYPE_ANY
@@ -44,10 +46,21 @@ struct Type
             Type *element_type;
         } array;
 
+        struct
+        {
+            Type *key_type;
+            Type *value_type;
+        } map;
+        struct
+        {
+            Type **element_types;
+            int element_count;
+        } tuple;
         struct
         {
             Type *return_type;
             Type **param_types;
+            bool *param_refs; // Which parameters are `ref`, NULL when none are
             int param_count;
         } function;
     } as;
@@ -66,7 +79,8 @@ typedef enum
     EXPR_INCREMENT,
     EXPR_DECREMENT,
     EXPR_INTERPOLATED,
-    EXPR_MEMBER // New: For dot notation member access (e.g., arr.length or arr.push)
+    EXPR_MEMBER, // New: For dot notation member access (e.g., arr.length or arr.push)
+    EXPR_TUPLE
 } ExprType;
 
 typedef struct
@@ -119,9 +133,21 @@ typedef struct
     Expr *index;
 } ArrayAccessExpr;
 
+/* A `{expr:spec}` format spec, fully decoded at compile time. */
+typedef struct
+{
+    char fill;       // Padding character, ' ' unless given
+    char align;      // '<', '>', '^' or '=' (pad after the sign); 0 until the type checker picks a default
+    bool plus;       // Print '+' for non-negative numbers
+    int width;       // Minimum field width, 0 for none
+    int precision;   // Digits after the point, or max characters for strings; -1 for none
+    char conversion; // 'd', 'x', 'X', 'o', 'b', 'f', 's', 'c', or 0 until defaulted
+} FormatSpec;
+
 typedef struct
 {
     Expr **parts;
+    FormatSpec **specs; // NULL, or one entry per part (NULL where the part has no spec)
     int part_count;
 } InterpolExpr;
 
@@ -131,6 +157,12 @@ typedef struct
     Token name;
 } MemberExpr; // New: Represents object.member
 
+typedef struct
+{
+    Expr **elements;
+    int element_count;
+} TupleExpr;
+
 struct Expr
 {
     ExprType type;
@@ -149,6 +181,7 @@ struct Expr
         Expr *operand;
         InterpolExpr interpol;
         MemberExpr member; // New
+        TupleExpr tuple;
     } as;
 
     Type *expr_type;
@@ -158,12 +191,15 @@ typedef enum
 {
     STMT_EXPR,
     STMT_VAR_DECL,
+    STMT_VAR_TUPLE,
     STMT_FUNCTION,
     STMT_RETURN,
     STMT_BLOCK,
     STMT_IF,
     STMT_WHILE,
     STMT_FOR,
+    STMT_MATCH,
+    STMT_BENCH,
     STMT_IMPORT
 } StmtType;
 
@@ -177,14 +213,32 @@ typedef struct
     Token name;
     Type *type;
     Expr *initializer;
+    bool is_const;
 } VarDeclStmt;
 
+typedef struct
+{
+    Token *names; // Destructured variable names, `_` discards an element
+    int name_count;
+    Expr *initializer;
+} VarTupleStmt;
+
 typedef struct
 {
     Token name;
     Type *type;
+    bool is_ref; // Passed as a pointer to the caller's variable
 } Parameter;
 
+typedef enum
+{
+    FUNC_ANNOTATION_NONE = 0,
+    FUNC_ANNOTATION_CHECKED = 1 << 0,   // @checked: keep runtime checks even in the unchecked profile
+    FUNC_ANNOTATION_UNCHECKED = 1 << 1, // @unchecked: drop runtime checks unless the debug profile is used
+    FUNC_ANNOTATION_FASTMATH = 1 << 2,  // @fastmath: inline double arithmetic and allow reassociation
+    FUNC_ANNOTATION_MEMO = 1 << 3       // @memo / @memo(N): cache results of a pure function
+} FunctionAnnotation;
+
 typedef struct
 {
     Token name;
@@ -193,6 +247,8 @@ typedef struct
     Type *return_type;
     Stmt **body;
     int body_count;
+    int annotations; // Bitmask of FunctionAnnotation
+    int memo_limit;  // Maximum cached results for @memo(N), 0 when unbounded
 } FunctionStmt;
 
 typedef struct
@@ -228,6 +284,25 @@ typedef struct
     Stmt *body;
 } ForStmt;
 
+typedef struct
+{
+    Expr **values; // Literal values selecting this case
+    int value_count;
+    Stmt *body;
+} MatchCase;
+typedef struct
+{
+    Expr *subject;
+    MatchCase *cases;
+    int case_count;
+    Stmt *else_branch;
+} MatchStmt;
+typedef struct
+{
+    char *name; // Label reported by the harness
+    Stmt **body;
+    int body_count;
+} BenchStmt;
 typedef struct
 {
     Token module_name;
@@ -242,12 +317,15 @@ struct Stmt
     {
         ExprStmt expression;
         VarDeclStmt var_decl;
+        VarTupleStmt var_tuple;
         FunctionStmt function;
         ReturnStmt return_stmt;
         BlockStmt block;
         IfStmt if_stmt;
         WhileStmt while_stmt;
         ForStmt for_stmt;
+        MatchStmt match_stmt;
+        BenchStmt bench;
         ImportStmt import;
     } as;
 };
@@ -268,6 +346,8 @@ Token *ast_clone_token(Arena *arena, const Token *src);
 Type *ast_clone_type(Arena *arena, Type *type);
 Type *ast_create_primitive_type(Arena *arena, TypeKind kind);
 Type *ast_create_array_type(Arena *arena, Type *element_type);
+Type *ast_create_map_type(Arena *arena, Type *key_type, Type *value_type);
+Type *ast_create_tuple_type(Arena *arena, Type **element_types, int element_count);
 Type *ast_create_function_type(Arena *arena, Type *return_type, Type **param_types, int param_count);
 int ast_type_equals(Type *a, Type *b);
 const char *ast_type_to_string(Arena *arena, Type *type);
@@ -279,10 +359,11 @@ Expr *ast_create_variable_expr(Arena *arena, Token name, const Token *loc_token)
 Expr *ast_create_assign_expr(Arena *arena, Token name, Expr *value, const Token *loc_token);
 Expr *ast_create_call_expr(Arena *arena, Expr *callee, Expr **arguments, int arg_count, const Token *loc_token);
 Expr *ast_create_array_expr(Arena *arena, Expr **elements, int element_count, const Token *loc_token);
+Expr *ast_create_tuple_expr(Arena *arena, Expr **elements, int element_count, const Token *loc_token);
 Expr *ast_create_array_access_expr(Arena *arena, Expr *array, Expr *index, const Token *loc_token);
 Expr *ast_create_increment_expr(Arena *arena, Expr *operand, const Token *loc_token);
 Expr *ast_create_decrement_expr(Arena *arena, Expr *operand, const Token *loc_token);
-Expr *ast_create_interpolated_expr(Arena *arena, Expr **parts, int part_count, const Token *loc_token);
+Expr *ast_create_interpolated_expr(Arena *arena, Expr **parts, FormatSpec **specs, int part_count, const Token *loc_token);
 Expr *ast_create_comparison_expr(Arena *arena, Expr *left, Expr *right, TokenType comparison_type, const Token *loc_token);
 Expr *ast_create_member_expr(Arena *arena, Expr *object, Token name, const Token *loc_token); // New
 
@@ -295,6 +376,9 @@ Stmt *ast_create_block_stmt(Arena *arena, Stmt **statements, int count, const To
 Stmt *ast_create_if_stmt(Arena *arena, Expr *condition, Stmt *then_branch, Stmt *else_branch, const Token *loc_token);
 Stmt *ast_create_while_stmt(Arena *arena, Expr *condition, Stmt *body, const Token *loc_token);
 Stmt *ast_create_for_stmt(Arena *arena, Stmt *initializer, Expr *condition, Expr *increment, Stmt *body, const Token *loc_token);
+Stmt *ast_create_var_tuple_stmt(Arena *arena, Token *names, int name_count, Expr *initializer, const Token *loc_token);
+Stmt *ast_create_match_stmt(Arena *arena, Expr *subject, MatchCase *cases, int case_count, Stmt *else_branch, const Token *loc_token);
+Stmt *ast_create_bench_stmt(Arena *arena, char *name, Stmt **body, int body_count, const Token *loc_token);
 Stmt *ast_create_import_stmt(Arena *arena, Token module_name, const Token *loc_token);
 
 void ast_init_module(Arena *arena, Module *module, const char *filename);
@@ -1,4 +1,5 @@
 // code_gen.c
+#define DEBUG_CATEGORY DEBUG_CAT_CODEGEN
 #include "code_gen.h"
 #include "debug.h"
 #include "parser.h"
@@ -6,6 +7,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include "arena.h"
+#include "runtime.h"
 
 static char *code_gen_expression(CodeGen *gen, Expr *expr);
 static char *code_gen_binary_expression(CodeGen *gen, BinaryExpr *expr);
@@ -19,6 +21,7 @@ static char *code_gen_array_expression(CodeGen *gen, ArrayExpr *expr);
 static char *code_gen_array_access_expression(CodeGen *gen, ArrayAccessExpr *expr);
 static char *code_gen_increment_expression(CodeGen *gen, Expr *expr);
 static char *code_gen_decrement_expression(CodeGen *gen, Expr *expr);
+static char *code_gen_tuple_expression(CodeGen *gen, Expr *expr);
 static bool expression_produces_temp(Expr *expr);
 
 static char *arena_vsprintf(Arena *arena, const char *fmt, va_list args)
@@ -100,7 +103,74 @@ static char *escape_c_string(Arena *arena, const char *str)
     return buf;
 }
 
-static const char *get_c_type(Type *type)
+// Points the C lines that follow at `token`'s SN source line. The C compiler
+// counts on from there, so a directive only covers the one line after it.
+static void code_gen_line_directive(CodeGen *gen, Token *token)
+{
+    DEBUG_VERBOSE("Entering code_gen_line_directive");
+    if (!gen->line_directives || token == NULL || token->line <= 0 || token->filename == NULL)
+    {
+        return;
+    }
+    if (token->filename != gen->line_filename)
+    {
+        gen->line_filename = token->filename;
+        gen->line_filename_c = escape_c_string(gen->arena, token->filename);
+    }
+    fprintf(gen->output, "#line %d %s\n", token->line, gen->line_filename_c);
+}
+
+// Maps the C lines that follow back to the generated file itself, for glue
+// that has no SN source line. Only runs once per module, so finding the
+// current line by reading the output back is cheap enough.
+static void code_gen_line_reset(CodeGen *gen)
+{
+    DEBUG_VERBOSE("Entering code_gen_line_reset");
+    if (gen->line_filename == NULL)
+    {
+        return;
+    }
+    fflush(gen->output);
+    FILE *written = fopen(gen->output_file, "r");
+    if (written == NULL)
+    {
+        return;
+    }
+    long lines = 0;
+    int c;
+    while ((c = getc(written)) != EOF)
+    {
+        if (c == '\n')
+        {
+            lines++;
+        }
+    }
+    fclose(written);
+    // The directive is line lines + 1, so the line after it is lines + 2.
+    fprintf(gen->output, "#line %ld %s\n", lines + 2, escape_c_string(gen->arena, gen->output_file));
+    gen->line_filename = NULL;
+}
+
+// Maps the next C line to the statement being generated; called before every
+// line of a statement after its first, so that none drift onto later SN lines.
+static void code_gen_restate_line(CodeGen *gen)
+{
+    code_gen_line_directive(gen, gen->line_token);
+}
+
+static char *get_tuple_c_name(Arena *arena, Type *type)
+{
+    char *name = arena_strdup(arena, "SnTuple_");
+    for (int i = 0; i < type->as.tuple.element_count; i++)
+    {
+        TypeKind kind = type->as.tuple.element_types[i]->kind;
+        const char *code = kind == TYPE_STRING ? "s" : (kind == TYPE_DOUBLE ? "d" : "l");
+        name = arena_sprintf(arena, "%s%s", name, code);
+    }
+    return name;
+}
+
+static const char *get_c_type(Arena *arena, Type *type)
 {
     DEBUG_VERBOSE("Entering get_c_type");
     if (type == NULL)
@@ -118,6 +188,10 @@ static const char *get_c_type(Type *type)
         return "double";
     case TYPE_STRING:
         return "char *";
+    case TYPE_MAP:
+        return "RtMap *";
+    case TYPE_TUPLE:
+        return get_tuple_c_name(arena, type);
     case TYPE_NIL:
         return "long";
     case TYPE_VOID:
@@ -142,19 +216,58 @@ static const char *get_rt_to_string_func(TypeKind kind)
         return "rt_to_string_char";
     case TYPE_BOOL:
         return "rt_to_string_bool";
+    case TYPE_STRING:
+        return "rt_to_string_string";
     default:
         exit(1);
     }
     return NULL;
 }
 
+static const char *get_rt_print_func(TypeKind kind)
+{
+    DEBUG_VERBOSE("Entering get_rt_print_func");
+    switch (kind)
+    {
+    case TYPE_INT:
+    case TYPE_LONG:
+        return "rt_print_long";
+    case TYPE_DOUBLE:
+        return "rt_print_double";
+    case TYPE_CHAR:
+        return "rt_print_char";
+    case TYPE_BOOL:
+        return "rt_print_bool";
+    default:
+        return "rt_print_string";
+    }
+}
+
+// Field of the runtime's RtValue union that holds a value of this type.
+static const char *get_rt_value_field(Type *type)
+{
+    switch (type->kind)
+    {
+    case TYPE_STRING:
+        return "s";
+    case TYPE_DOUBLE:
+        return "d";
+    default:
+        return "l";
+    }
+}
+
 static const char *get_default_value(Type *type)
 {
     DEBUG_VERBOSE("Entering get_default_value");
-    if (type->kind == TYPE_STRING)
+    if (type->kind == TYPE_STRING || type->kind == TYPE_MAP)
     {
         return "NULL";
     }
+    else if (type->kind == TYPE_TUPLE)
+    {
+        return "{0}";
+    }
     else
     {
         return "0";
@@ -181,9 +294,31 @@ void code_gen_init(Arena *arena, CodeGen *gen, SymbolTable *symbol_table, const
     gen->label_count = 0;
     gen->symbol_table = symbol_table;
     gen->output = fopen(output_file, "w");
+    gen->output_file = arena_strdup(arena, output_file);
     gen->current_function = NULL;
     gen->current_return_type = NULL;
     gen->temp_count = 0;
+    gen->profile = PROFILE_DEBUG;
+    gen->checks_enabled = true;
+    gen->fast_math = false;
+    gen->has_benches = false;
+    gen->bench_count = 0;
+    gen->stats = NULL;
+    gen->instrument = false;
+    gen->trace = TRACE_OFF;
+    gen->line_directives = true;
+    gen->line_token = NULL;
+    gen->line_filename = NULL;
+    gen->line_filename_c = NULL;
+    gen->functions = NULL;
+    gen->function_count = 0;
+    gen->function_capacity = 0;
+    gen->coverage = false;
+    gen->use_profile = NULL;
+    gen->coverage_ordinal = 0;
+    gen->coverage_sites = NULL;
+    gen->coverage_site_count = 0;
+    gen->coverage_site_capacity = 0;
     if (gen->output == NULL)
     {
         exit(1);
@@ -249,18 +384,72 @@ static void code_gen_externs(CodeGen *gen)
     fprintf(gen->output, "extern long rt_not_bool(long);\n");
     fprintf(gen->output, "extern long rt_post_inc_long(long *);\n");
     fprintf(gen->output, "extern long rt_post_dec_long(long *);\n");
+    fprintf(gen->output, "extern long rt_array_index(long, long);\n");
     fprintf(gen->output, "extern char *rt_to_string_long(long);\n");
     fprintf(gen->output, "extern char *rt_to_string_double(double);\n");
     fprintf(gen->output, "extern char *rt_to_string_char(long);\n");
     fprintf(gen->output, "extern char *rt_to_string_bool(long);\n");
     fprintf(gen->output, "extern char *rt_to_string_string(char *);\n");
+    fprintf(gen->output, "extern char *rt_format_long(long, long, long, long, long, long, long);\n");
+    fprintf(gen->output, "extern char *rt_format_double(double, long, long, long, long, long);\n");
+    fprintf(gen->output, "extern char *rt_format_string(char *, long, long, long, long);\n");
+    fprintf(gen->output, "extern char *rt_format_char(long, long, long, long);\n");
     fprintf(gen->output, "extern long rt_eq_string(char *, char *);\n");
     fprintf(gen->output, "extern long rt_ne_string(char *, char *);\n");
     fprintf(gen->output, "extern long rt_lt_string(char *, char *);\n");
     fprintf(gen->output, "extern long rt_le_string(char *, char *);\n");
     fprintf(gen->output, "extern long rt_gt_string(char *, char *);\n");
     fprintf(gen->output, "extern long rt_ge_string(char *, char *);\n");
-    fprintf(gen->output, "extern void rt_free_string(char *);\n\n");
+    fprintf(gen->output, "extern void rt_free_string(char *);\n");
+    fprintf(gen->output, "extern unsigned long rt_str_hash_seeded(unsigned long, const char *);\n");
+    fprintf(gen->output, "extern long rt_bench_requested(void);\n");
+    fprintf(gen->output, "extern void rt_bench_run(char *, void (*)(void));\n");
+    fprintf(gen->output, "typedef struct RtProfFunction RtProfFunction;\n");
+    fprintf(gen->output, "extern void rt_prof_enter(RtProfFunction **, const char *);\n");
+    fprintf(gen->output, "extern void rt_prof_exit(void);\n");
+    fprintf(gen->output, "extern long rt_trace_begin(long *, const char *);\n");
+    fprintf(gen->output, "extern void rt_trace_end(long);\n");
+    fprintf(gen->output, "typedef struct { const char *name; void *start; } RtSampleFunction;\n");
+    fprintf(gen->output, "typedef struct { void *start; void *end; } RtSampleRange;\n");
+    fprintf(gen->output, "extern void rt_sample_register(const RtSampleFunction *, long, const RtSampleRange *, long);\n");
+    fprintf(gen->output, "extern void rt_cov_register(long *, const char *const *, long);\n");
+    if (gen->coverage)
+    {
+        // Defined once the number of sites is known, at the end of the module.
+        fprintf(gen->output, "extern long __sn_cov[];\n");
+        fprintf(gen->output, "#define SN_COV(c, i) ((c) ? (__sn_cov[i]++, 1) : (__sn_cov[(i) + 1]++, 0))\n");
+    }
+    // SN functions live in SN-owned sections so the sampling profiler knows where generated code starts and
+    // ends. An explicit section overrides GCC's .text.hot/.text.unlikely placement, so functions --use-profile
+    // marks hot or cold get sections of their own; those may be empty, hence the weak bounds.
+    fprintf(gen->output, "#ifdef __ELF__\n");
+    fprintf(gen->output, "#define SN_TEXT __attribute__((section(\"sn_text\")))\n");
+    fprintf(gen->output, "#define SN_TEXT_HOT __attribute__((hot, section(\"sn_text_hot\")))\n");
+    fprintf(gen->output, "#define SN_TEXT_COLD __attribute__((cold, noinline, section(\"sn_text_unlikely\")))\n");
+    fprintf(gen->output, "extern char __start_sn_text[], __stop_sn_text[];\n");
+    fprintf(gen->output, "extern char __start_sn_text_hot[] __attribute__((weak)), __stop_sn_text_hot[] __attribute__((weak));\n");
+    fprintf(gen->output, "extern char __start_sn_text_unlikely[] __attribute__((weak)), "
+                         "__stop_sn_text_unlikely[] __attribute__((weak));\n");
+    fprintf(gen->output, "#else\n");
+    fprintf(gen->output, "#define SN_TEXT\n");
+    fprintf(gen->output, "#define SN_TEXT_HOT __attribute__((hot))\n");
+    fprintf(gen->output, "#define SN_TEXT_COLD __attribute__((cold, noinline))\n");
+    fprintf(gen->output, "#endif\n");
+    fprintf(gen->output, "typedef union { long l; double d; char *s; } RtValue;\n");
+    fprintf(gen->output, "typedef struct RtMemo RtMemo;\n");
+    fprintf(gen->output, "extern RtMemo *rt_memo_create(long, long, long, long);\n");
+    fprintf(gen->output, "extern long rt_memo_get(RtMemo *, RtValue *, RtValue *);\n");
+    fprintf(gen->output, "extern void rt_memo_put(RtMemo *, RtValue *, RtValue);\n");
+    fprintf(gen->output, "typedef struct RtMap RtMap;\n");
+    fprintf(gen->output, "extern RtMap *rt_map_create(long, long);\n");
+    fprintf(gen->output, "extern void rt_map_free(RtMap *);\n");
+    fprintf(gen->output, "extern long rt_map_length(RtMap *);\n");
+    fprintf(gen->output, "extern long rt_map_contains(RtMap *, RtValue);\n");
+    fprintf(gen->output, "extern RtValue rt_map_get(RtMap *, RtValue);\n");
+    fprintf(gen->output, "extern void rt_map_set(RtMap *, RtValue, RtValue);\n");
+    fprintf(gen->output, "extern long rt_map_remove(RtMap *, RtValue);\n");
+    fprintf(gen->output, "extern RtValue rt_map_key_at(RtMap *, long);\n");
+    fprintf(gen->output, "extern RtValue rt_map_value_at(RtMap *, long);\n\n");
 }
 
 static char *code_gen_binary_op_str(TokenType op)
@@ -296,6 +485,54 @@ static char *code_gen_binary_op_str(TokenType op)
     return NULL;
 }
 
+static char *code_gen_c_operator(TokenType op)
+{
+    DEBUG_VERBOSE("Entering code_gen_c_operator");
+    switch (op)
+    {
+    case TOKEN_PLUS:
+        return "+";
+    case TOKEN_MINUS:
+        return "-";
+    case TOKEN_STAR:
+        return "*";
+    case TOKEN_SLASH:
+        return "/";
+    case TOKEN_MODULO:
+        return "%";
+    case TOKEN_EQUAL_EQUAL:
+        return "==";
+    case TOKEN_BANG_EQUAL:
+        return "!=";
+    case TOKEN_LESS:
+        return "<";
+    case TOKEN_LESS_EQUAL:
+        return "<=";
+    case TOKEN_GREATER:
+        return ">";
+    case TOKEN_GREATER_EQUAL:
+        return ">=";
+    default:
+        exit(1);
+    }
+    return NULL;
+}
+
+static bool code_gen_checks_for_function(BuildProfile profile, int annotations)
+{
+    DEBUG_VERBOSE("Entering code_gen_checks_for_function");
+    switch (profile)
+    {
+    case PROFILE_RELEASE:
+        return (annotations & FUNC_ANNOTATION_UNCHECKED) == 0;
+    case PROFILE_UNCHECKED:
+        return (annotations & FUNC_ANNOTATION_CHECKED) != 0;
+    case PROFILE_DEBUG:
+    default:
+        return true;
+    }
+}
+
 static char *code_gen_type_suffix(Type *type)
 {
     DEBUG_VERBOSE("Entering code_gen_type_suffix");
@@ -330,6 +567,7 @@ static bool expression_produces_temp(Expr *expr)
     case EXPR_BINARY:
     case EXPR_CALL:
     case EXPR_INTERPOLATED:
+    case EXPR_ARRAY_ACCESS:
         return true;
     default:
         return false;
@@ -353,15 +591,32 @@ static char *code_gen_binary_expression(CodeGen *gen, BinaryExpr *expr)
     }
     char *op_str = code_gen_binary_op_str(op);
     char *suffix = code_gen_type_suffix(type);
-    if (op == TOKEN_PLUS && type->kind == TYPE_STRING)
+    if (op == TOKEN_PLUS && (type->kind == TYPE_STRING || expr->right->expr_type->kind == TYPE_STRING))
     {
         bool free_left = expression_produces_temp(expr->left);
         bool free_right = expression_produces_temp(expr->right);
+        // `str + n` and `n + str` convert the non-string side to a fresh string first
+        if (expr->left->expr_type->kind != TYPE_STRING)
+        {
+            left_str = arena_sprintf(gen->arena, "%s(%s)", get_rt_to_string_func(expr->left->expr_type->kind), left_str);
+            free_left = true;
+        }
+        if (expr->right->expr_type->kind != TYPE_STRING)
+        {
+            right_str = arena_sprintf(gen->arena, "%s(%s)", get_rt_to_string_func(expr->right->expr_type->kind), right_str);
+            free_right = true;
+        }
         char *free_l_str = free_left ? "rt_free_string(_left); " : "";
         char *free_r_str = free_right ? "rt_free_string(_right); " : "";
         return arena_sprintf(gen->arena, "({ char *_left = %s; char *_right = %s; char *_res = rt_str_concat(_left, _right); %s%s _res; })",
                              left_str, right_str, free_l_str, free_r_str);
     }
+    else if ((!gen->checks_enabled || (gen->fast_math && type->kind == TYPE_DOUBLE)) &&
+             type->kind != TYPE_STRING && !(op == TOKEN_MODULO && type->kind == TYPE_DOUBLE))
+    {
+        // Unchecked: plain C arithmetic, no overflow or division-by-zero checks.
+        return arena_sprintf(gen->arena, "(%s %s %s)", left_str, code_gen_c_operator(op), right_str);
+    }
     else
     {
         return arena_sprintf(gen->arena, "rt_%s_%s(%s, %s)", op_str, suffix, left_str, right_str);
@@ -376,6 +631,10 @@ static char *code_gen_unary_expression(CodeGen *gen, UnaryExpr *expr)
     switch (expr->operator)
     {
     case TOKEN_MINUS:
+        if (!gen->checks_enabled || (gen->fast_math && type->kind == TYPE_DOUBLE))
+        {
+            return arena_sprintf(gen->arena, "(-%s)", operand_str);
+        }
         if (type->kind == TYPE_DOUBLE)
         {
             return arena_sprintf(gen->arena, "rt_neg_double(%s)", operand_str);
@@ -420,16 +679,30 @@ static char *code_gen_literal_expression(CodeGen *gen, LiteralExpr *expr)
     return NULL;
 }
 
+// Ref parameters are pointers to the caller's variable, so every read and
+// write goes through a dereference.
+static char *code_gen_var_access(CodeGen *gen, Token name)
+{
+    DEBUG_VERBOSE("Entering code_gen_var_access");
+    char *var_name = get_var_name(gen->arena, name);
+    Symbol *symbol = symbol_table_lookup_symbol(gen->symbol_table, name);
+    if (symbol && symbol->kind == SYMBOL_REF_PARAM)
+    {
+        return arena_sprintf(gen->arena, "(*%s)", var_name);
+    }
+    return var_name;
+}
+
 static char *code_gen_variable_expression(CodeGen *gen, VariableExpr *expr)
 {
     DEBUG_VERBOSE("Entering code_gen_variable_expression");
-    return get_var_name(gen->arena, expr->name);
+    return code_gen_var_access(gen, expr->name);
 }
 
 static char *code_gen_assign_expression(CodeGen *gen, AssignExpr *expr)
 {
     DEBUG_VERBOSE("Entering code_gen_assign_expression");
-    char *var_name = get_var_name(gen->arena, expr->name);
+    char *var_name = code_gen_var_access(gen, expr->name);
     char *value_str = code_gen_expression(gen, expr->value);
     Symbol *symbol = symbol_table_lookup_symbol(gen->symbol_table, expr->name);
     if (symbol == NULL)
@@ -448,6 +721,47 @@ static char *code_gen_assign_expression(CodeGen *gen, AssignExpr *expr)
     }
 }
 
+// Lowers a hole with a format spec to the matching runtime formatter. The spec
+// was completed by the type checker, so every argument is a constant here.
+static char *code_gen_format_part(CodeGen *gen, Expr *part, char *part_str, FormatSpec *spec)
+{
+    DEBUG_VERBOSE("Entering code_gen_format_part");
+    long fill = (long)(unsigned char)spec->fill;
+    long align = (long)(unsigned char)spec->align;
+    switch (part->expr_type->kind)
+    {
+    case TYPE_INT:
+    case TYPE_LONG:
+    {
+        int base = spec->conversion == 'b' ? 2 : spec->conversion == 'o' ? 8
+                 : (spec->conversion == 'x' || spec->conversion == 'X') ? 16 : 10;
+        return arena_sprintf(gen->arena, "rt_format_long(%s, %dL, %dL, %dL, %dL, %ldL, %ldL)", part_str, base,
+                             spec->conversion == 'X', spec->plus, spec->width, fill, align);
+    }
+    case TYPE_DOUBLE:
+        return arena_sprintf(gen->arena, "rt_format_double(%s, %dL, %dL, %dL, %ldL, %ldL)", part_str,
+                             spec->precision, spec->plus, spec->width, fill, align);
+    case TYPE_CHAR:
+        return arena_sprintf(gen->arena, "rt_format_char(%s, %dL, %ldL, %ldL)", part_str, spec->width, fill, align);
+    case TYPE_BOOL:
+        return arena_sprintf(gen->arena, "rt_format_string((%s) ? \"true\" : \"false\", %dL, %dL, %ldL, %ldL)",
+                             part_str, spec->precision, spec->width, fill, align);
+    case TYPE_STRING:
+        if (expression_produces_temp(part))
+        {
+            return arena_sprintf(gen->arena,
+                                 "({ char *_src = %s; char *_fmt = rt_format_string(_src, %dL, %dL, %ldL, %ldL); "
+                                 "rt_free_string(_src); _fmt; })",
+                                 part_str, spec->precision, spec->width, fill, align);
+        }
+        return arena_sprintf(gen->arena, "rt_format_string(%s, %dL, %dL, %ldL, %ldL)", part_str, spec->precision,
+                             spec->width, fill, align);
+    default:
+        exit(1);
+    }
+    return NULL;
+}
+
 static char *code_gen_interpolated_expression(CodeGen *gen, InterpolExpr *expr)
 {
     DEBUG_VERBOSE("Entering code_gen_interpolated_expression");
@@ -456,41 +770,38 @@ static char *code_gen_interpolated_expression(CodeGen *gen, InterpolExpr *expr)
     {
         return arena_strdup(gen->arena, "rt_to_string_string(\"\")");
     }
+    // Every part becomes a string; free_parts marks the ones this expression owns.
     char **part_strs = arena_alloc(gen->arena, count * sizeof(char *));
-    Type **part_types = arena_alloc(gen->arena, count * sizeof(Type *));
     bool *free_parts = arena_alloc(gen->arena, count * sizeof(bool));
     for (int i = 0; i < count; i++)
     {
-        part_strs[i] = code_gen_expression(gen, expr->parts[i]);
-        part_types[i] = expr->parts[i]->expr_type;
-        free_parts[i] = (part_types[i]->kind == TYPE_STRING ? expression_produces_temp(expr->parts[i]) : true);
-    }
-    char *result = arena_sprintf(gen->arena, "({ ");
-    char *first_str;
-    if (part_types[0]->kind == TYPE_STRING)
-    {
-        first_str = part_strs[0];
-    }
-    else
-    {
-        const char *to_str_func = get_rt_to_string_func(part_types[0]->kind);
-        first_str = arena_sprintf(gen->arena, "%s(%s)", to_str_func, part_strs[0]);
-    }
-    result = arena_sprintf(gen->arena, "%schar *_res = %s; ", result, first_str);
-    for (int i = 1; i < count; i++)
-    {
-        char *next_str;
-        if (part_types[i]->kind == TYPE_STRING)
+        Expr *part = expr->parts[i];
+        char *value_str = code_gen_expression(gen, part);
+        FormatSpec *spec = expr->specs ? expr->specs[i] : NULL;
+        if (spec != NULL)
+        {
+            part_strs[i] = code_gen_format_part(gen, part, value_str, spec);
+            free_parts[i] = true;
+        }
+        else if (part->expr_type->kind == TYPE_STRING)
         {
-            next_str = part_strs[i];
+            part_strs[i] = value_str;
+            free_parts[i] = expression_produces_temp(part);
         }
         else
         {
-            const char *to_str_func = get_rt_to_string_func(part_types[i]->kind);
-            next_str = arena_sprintf(gen->arena, "%s(%s)", to_str_func, part_strs[i]);
+            const char *to_str_func = get_rt_to_string_func(part->expr_type->kind);
+            part_strs[i] = arena_sprintf(gen->arena, "%s(%s)", to_str_func, value_str);
+            free_parts[i] = true;
         }
+    }
+    // The result is freed by its consumer, so a borrowed first part must be copied.
+    char *first_str = free_parts[0] ? part_strs[0] : arena_sprintf(gen->arena, "rt_to_string_string(%s)", part_strs[0]);
+    char *result = arena_sprintf(gen->arena, "({ char *_res = %s; ", first_str);
+    for (int i = 1; i < count; i++)
+    {
         result = arena_sprintf(gen->arena, "%schar *_next%d = %s; char *_new%d = rt_str_concat(_res, _next%d); rt_free_string(_res); ",
-                               result, i, next_str, i, i);
+                               result, i, part_strs[i], i, i);
         if (free_parts[i])
         {
             result = arena_sprintf(gen->arena, "%srt_free_string(_next%d); ", result, i);
@@ -501,17 +812,110 @@ static char *code_gen_interpolated_expression(CodeGen *gen, InterpolExpr *expr)
     return result;
 }
 
+// Map methods lower to rt_map_* calls on boxed RtValue keys and values. String
+// temporaries passed in are freed afterwards, since the map keeps its own copies.
+static char *code_gen_map_method_call(CodeGen *gen, Expr *expr)
+{
+    DEBUG_VERBOSE("Entering code_gen_map_method_call");
+    CallExpr *call = &expr->as.call;
+    MemberExpr *member = &call->callee->as.member;
+    Type *map_type = member->object->expr_type;
+    const char *key_field = get_rt_value_field(map_type->as.map.key_type);
+    const char *value_field = get_rt_value_field(map_type->as.map.value_type);
+    char *map_str = code_gen_expression(gen, member->object);
+    const char *method = member->name.start;
+
+    char *prefix = arena_strdup(gen->arena, "");
+    char *frees = arena_strdup(gen->arena, "");
+    char **args = arena_alloc(gen->arena, sizeof(char *) * (call->arg_count > 0 ? call->arg_count : 1));
+    for (int i = 0; i < call->arg_count; i++)
+    {
+        args[i] = code_gen_expression(gen, call->arguments[i]);
+        if (expression_produces_temp(call->arguments[i]))
+        {
+            prefix = arena_sprintf(gen->arena, "%schar *_map_arg%d = %s; ", prefix, i, args[i]);
+            frees = arena_sprintf(gen->arena, "%srt_free_string(_map_arg%d); ", frees, i);
+            args[i] = arena_sprintf(gen->arena, "_map_arg%d", i);
+        }
+    }
+
+    char *call_str;
+    if (strcmp(method, "get") == 0)
+        call_str = arena_sprintf(gen->arena, "rt_map_get(%s, (RtValue){.%s = %s}).%s", map_str, key_field, args[0], value_field);
+    else if (strcmp(method, "set") == 0)
+        call_str = arena_sprintf(gen->arena, "rt_map_set(%s, (RtValue){.%s = %s}, (RtValue){.%s = %s})",
+                                 map_str, key_field, args[0], value_field, args[1]);
+    else if (strcmp(method, "remove") == 0)
+        call_str = arena_sprintf(gen->arena, "rt_map_remove(%s, (RtValue){.%s = %s})", map_str, key_field, args[0]);
+    else if (strcmp(method, "contains") == 0)
+        call_str = arena_sprintf(gen->arena, "rt_map_contains(%s, (RtValue){.%s = %s})", map_str, key_field, args[0]);
+    else if (strcmp(method, "key_at") == 0)
+        call_str = arena_sprintf(gen->arena, "rt_map_key_at(%s, %s).%s", map_str, args[0], key_field);
+    else if (strcmp(method, "value_at") == 0)
+        call_str = arena_sprintf(gen->arena, "rt_map_value_at(%s, %s).%s", map_str, args[0], value_field);
+    else
+        exit(1);
+
+    if (frees[0] == '\0')
+    {
+        return call_str;
+    }
+    if (expr->expr_type->kind == TYPE_VOID)
+    {
+        return arena_sprintf(gen->arena, "({ %s%s; %s})", prefix, call_str, frees);
+    }
+    return arena_sprintf(gen->arena, "({ %s%s _map_res = %s; %s_map_res; })",
+                         prefix, get_c_type(gen->arena, expr->expr_type), call_str, frees);
+}
+
+static Symbol *code_gen_const_array(CodeGen *gen, Expr *expr)
+{
+    if (expr->type != EXPR_VARIABLE)
+    {
+        return NULL;
+    }
+    Symbol *sym = symbol_table_lookup_symbol(gen->symbol_table, expr->as.variable.name);
+    if (sym == NULL || sym->const_value == NULL || sym->const_value->type != EXPR_ARRAY)
+    {
+        return NULL;
+    }
+    return sym;
+}
+
+static char *code_gen_member_expression(CodeGen *gen, MemberExpr *expr)
+{
+    DEBUG_VERBOSE("Entering code_gen_member_expression");
+    char *object_str = code_gen_expression(gen, expr->object);
+    if (expr->object->expr_type && expr->object->expr_type->kind == TYPE_MAP &&
+        strcmp(expr->name.start, "length") == 0)
+    {
+        return arena_sprintf(gen->arena, "rt_map_length(%s)", object_str);
+    }
+    Symbol *sym = code_gen_const_array(gen, expr->object);
+    if (sym && strcmp(expr->name.start, "length") == 0)
+    {
+        return arena_sprintf(gen->arena, "%dL", sym->const_value->as.array.element_count);
+    }
+    exit(1);
+}
+
 static char *code_gen_call_expression(CodeGen *gen, Expr *expr) {
     DEBUG_VERBOSE("Entering code_gen_call_expression");
     CallExpr *call = &expr->as.call;
+    if (call->callee->type == EXPR_MEMBER && call->callee->as.member.object->expr_type &&
+        call->callee->as.member.object->expr_type->kind == TYPE_MAP) {
+        return code_gen_map_method_call(gen, expr);
+    }
     char *callee_str = code_gen_expression(gen, call->callee);
 
-    // Special case for builtin 'print': map to rt_print_string if callee is VariableExpr named "print".
-    // Assume type-checker ensured 1 arg of type string.
+    // Builtins 'print' and 'to_string' dispatch on the argument type (the type checker ensured 1 arg).
     if (call->callee->type == EXPR_VARIABLE) {
         char *callee_name = get_var_name(gen->arena, call->callee->as.variable.name);
+        TypeKind arg_kind = call->arg_count > 0 && call->arguments[0]->expr_type ? call->arguments[0]->expr_type->kind : TYPE_STRING;
         if (strcmp(callee_name, "print") == 0) {
-            callee_str = arena_strdup(gen->arena, "rt_print_string");
+            callee_str = arena_strdup(gen->arena, get_rt_print_func(arg_kind));
+        } else if (strcmp(callee_name, "to_string") == 0) {
+            callee_str = arena_strdup(gen->arena, get_rt_to_string_func(arg_kind));
         }
     }
 
@@ -522,7 +926,18 @@ static char *code_gen_call_expression(CodeGen *gen, Expr *expr) {
     char **arg_strs = arena_alloc(gen->arena, sizeof(char *) * call->arg_count);
     bool *arg_is_temp = arena_alloc(gen->arena, sizeof(bool) * call->arg_count);
     bool has_temps = false;
+    Type *callee_type = call->callee->expr_type;
+    bool *param_refs = callee_type && callee_type->kind == TYPE_FUNCTION ? callee_type->as.function.param_refs : NULL;
     for (int i = 0; i < call->arg_count; i++) {
+        if (param_refs && param_refs[i]) {
+            // The type checker guarantees a local or a ref parameter; the latter is already a pointer.
+            Token name = call->arguments[i]->as.variable.name;
+            Symbol *sym = symbol_table_lookup_symbol(gen->symbol_table, name);
+            char *var_name = get_var_name(gen->arena, name);
+            arg_strs[i] = sym && sym->kind == SYMBOL_REF_PARAM ? var_name : arena_sprintf(gen->arena, "&%s", var_name);
+            arg_is_temp[i] = false;
+            continue;
+        }
         arg_strs[i] = code_gen_expression(gen, call->arguments[i]);
         arg_is_temp[i] = (call->arguments[i]->expr_type && call->arguments[i]->expr_type->kind == TYPE_STRING &&
                           expression_produces_temp(call->arguments[i]));
@@ -555,7 +970,7 @@ static char *code_gen_call_expression(CodeGen *gen, Expr *expr) {
     }
 
     // Temps present: continue building statement expression.
-    const char *ret_c = get_c_type(expr->expr_type);
+    const char *ret_c = get_c_type(gen->arena, expr->expr_type);
     if (returns_void) {
         result = arena_sprintf(gen->arena, "%s%s(%s); ", result, callee_str, args_list);
     } else {
@@ -590,9 +1005,43 @@ static char *code_gen_array_expression(CodeGen *gen, ArrayExpr *expr)
 static char *code_gen_array_access_expression(CodeGen *gen, ArrayAccessExpr *expr)
 {
     DEBUG_VERBOSE("Entering code_gen_array_access_expression");
-    (void)gen;
-    (void)expr;
-    return arena_strdup(gen->arena, "0L");
+    Symbol *sym = code_gen_const_array(gen, expr->array);
+    if (sym == NULL)
+    {
+        return arena_strdup(gen->arena, "0L");
+    }
+    char *array_name = get_var_name(gen->arena, sym->name);
+    char *index_str = code_gen_expression(gen, expr->index);
+    if (gen->checks_enabled)
+    {
+        index_str = arena_sprintf(gen->arena, "rt_array_index(%s, %dL)", index_str,
+                                  sym->const_value->as.array.element_count);
+    }
+    char *element = arena_sprintf(gen->arena, "%s[%s]", array_name, index_str);
+    if (sym->type->as.array.element_type->kind == TYPE_STRING)
+    {
+        // Elements live in read-only data; callers get their own copy to free.
+        return arena_sprintf(gen->arena, "rt_to_string_string(%s)", element);
+    }
+    return element;
+}
+
+static char *code_gen_tuple_expression(CodeGen *gen, Expr *expr)
+{
+    DEBUG_VERBOSE("Entering code_gen_tuple_expression");
+    char *result = arena_sprintf(gen->arena, "((%s){", get_c_type(gen->arena, expr->expr_type));
+    for (int i = 0; i < expr->as.tuple.element_count; i++)
+    {
+        Expr *element = expr->as.tuple.elements[i];
+        char *element_str = code_gen_expression(gen, element);
+        if (element->expr_type->kind == TYPE_STRING && !expression_produces_temp(element))
+        {
+            // The tuple owns its strings, so borrowed ones are copied in.
+            element_str = arena_sprintf(gen->arena, "rt_to_string_string(%s)", element_str);
+        }
+        result = arena_sprintf(gen->arena, "%s%s%s", result, i > 0 ? ", " : "", element_str);
+    }
+    return arena_sprintf(gen->arena, "%s})", result);
 }
 
 static char *code_gen_increment_expression(CodeGen *gen, Expr *expr)
@@ -602,7 +1051,11 @@ static char *code_gen_increment_expression(CodeGen *gen, Expr *expr)
     {
         exit(1);
     }
-    char *var_name = get_var_name(gen->arena, expr->as.operand->as.variable.name);
+    char *var_name = code_gen_var_access(gen, expr->as.operand->as.variable.name);
+    if (!gen->checks_enabled)
+    {
+        return arena_sprintf(gen->arena, "(%s++)", var_name);
+    }
     return arena_sprintf(gen->arena, "rt_post_inc_long(&%s)", var_name);
 }
 
@@ -613,7 +1066,11 @@ static char *code_gen_decrement_expression(CodeGen *gen, Expr *expr)
     {
         exit(1);
     }
-    char *var_name = get_var_name(gen->arena, expr->as.operand->as.variable.name);
+    char *var_name = code_gen_var_access(gen, expr->as.operand->as.variable.name);
+    if (!gen->checks_enabled)
+    {
+        return arena_sprintf(gen->arena, "(%s--)", var_name);
+    }
     return arena_sprintf(gen->arena, "rt_post_dec_long(&%s)", var_name);
 }
 
@@ -648,6 +1105,10 @@ static char *code_gen_expression(CodeGen *gen, Expr *expr)
         return code_gen_decrement_expression(gen, expr);
     case EXPR_INTERPOLATED:
         return code_gen_interpolated_expression(gen, &expr->as.interpol);
+    case EXPR_MEMBER:
+        return code_gen_member_expression(gen, &expr->as.member);
+    case EXPR_TUPLE:
+        return code_gen_tuple_expression(gen, expr);
     default:
         exit(1);
     }
@@ -658,11 +1119,31 @@ static void code_gen_expression_statement(CodeGen *gen, ExprStmt *stmt)
 {
     DEBUG_VERBOSE("Entering code_gen_expression_statement");
     char *expr_str = code_gen_expression(gen, stmt->expression);
-    if (stmt->expression->expr_type->kind == TYPE_STRING && expression_produces_temp(stmt->expression))
+    Type *type = stmt->expression->expr_type;
+    if (type->kind == TYPE_TUPLE)
+    {
+        // Discarded tuples still own their strings.
+        fprintf(gen->output, "{\n");
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    %s _tmp = %s;\n", get_c_type(gen->arena, type), expr_str);
+        fprintf(gen->output, "    (void)_tmp;\n");
+        for (int i = 0; i < type->as.tuple.element_count; i++)
+        {
+            if (type->as.tuple.element_types[i]->kind == TYPE_STRING)
+            {
+                code_gen_restate_line(gen);
+                fprintf(gen->output, "    rt_free_string(_tmp.f%d);\n", i);
+            }
+        }
+        fprintf(gen->output, "}\n");
+    }
+    else if (type->kind == TYPE_STRING && expression_produces_temp(stmt->expression))
     {
         fprintf(gen->output, "{\n");
+        code_gen_restate_line(gen);
         fprintf(gen->output, "    char *_tmp = %s;\n", expr_str);
         fprintf(gen->output, "    (void)_tmp;\n");
+        code_gen_restate_line(gen);
         fprintf(gen->output, "    rt_free_string(_tmp);\n");
         fprintf(gen->output, "}\n");
     }
@@ -672,14 +1153,61 @@ static void code_gen_expression_statement(CodeGen *gen, ExprStmt *stmt)
     }
 }
 
+/* Scalar consts are folded into every use by the type checker and need no storage;
+ * const arrays become static read-only tables. */
+static void code_gen_const_declaration(CodeGen *gen, VarDeclStmt *stmt)
+{
+    DEBUG_VERBOSE("Entering code_gen_const_declaration");
+    symbol_table_add_symbol_with_kind(gen->symbol_table, stmt->name, stmt->type, SYMBOL_GLOBAL);
+    Symbol *sym = symbol_table_lookup_symbol_current(gen->symbol_table, stmt->name);
+    sym->const_value = stmt->initializer;
+    if (stmt->type->kind != TYPE_ARRAY)
+    {
+        return;
+    }
+
+    ArrayExpr *array = &stmt->initializer->as.array;
+    Type *element_type = stmt->type->as.array.element_type;
+    char *var_name = get_var_name(gen->arena, stmt->name);
+    if (element_type->kind == TYPE_STRING)
+    {
+        fprintf(gen->output, "static char *const %s[%d] = {", var_name, array->element_count);
+    }
+    else
+    {
+        fprintf(gen->output, "static const %s %s[%d] = {", get_c_type(gen->arena, element_type), var_name,
+                array->element_count);
+    }
+    for (int i = 0; i < array->element_count; i++)
+    {
+        LiteralExpr *element = &array->elements[i]->as.literal;
+        char *value_str = element->type->kind == TYPE_STRING
+                              ? escape_c_string(gen->arena, element->value.string_value)
+                              : code_gen_literal_expression(gen, element);
+        fprintf(gen->output, "%s%s", i == 0 ? "" : ", ", value_str);
+    }
+    fprintf(gen->output, "};\n");
+}
+
 static void code_gen_var_declaration(CodeGen *gen, VarDeclStmt *stmt)
 {
     DEBUG_VERBOSE("Entering code_gen_var_declaration");
+    if (stmt->is_const)
+    {
+        code_gen_const_declaration(gen, stmt);
+        return;
+    }
     symbol_table_add_symbol_with_kind(gen->symbol_table, stmt->name, stmt->type, SYMBOL_LOCAL);
-    const char *type_c = get_c_type(stmt->type);
+    const char *type_c = get_c_type(gen->arena, stmt->type);
     char *var_name = get_var_name(gen->arena, stmt->name);
     char *init_str;
-    if (stmt->initializer)
+    if (stmt->type->kind == TYPE_MAP)
+    {
+        init_str = arena_sprintf(gen->arena, "rt_map_create(%dL, %dL)",
+                                 stmt->type->as.map.key_type->kind == TYPE_STRING,
+                                 stmt->type->as.map.value_type->kind == TYPE_STRING);
+    }
+    else if (stmt->initializer)
     {
         init_str = code_gen_expression(gen, stmt->initializer);
     }
@@ -690,24 +1218,62 @@ static void code_gen_var_declaration(CodeGen *gen, VarDeclStmt *stmt)
     fprintf(gen->output, "%s %s = %s;\n", type_c, var_name, init_str);
 }
 
+static void code_gen_var_tuple_declaration(CodeGen *gen, VarTupleStmt *stmt)
+{
+    DEBUG_VERBOSE("Entering code_gen_var_tuple_declaration");
+    Type *type = stmt->initializer->expr_type;
+    char *tuple_name = arena_sprintf(gen->arena, "_tuple%d", code_gen_new_label(gen));
+    char *init_str = code_gen_expression(gen, stmt->initializer);
+    fprintf(gen->output, "%s %s = %s;\n", get_c_type(gen->arena, type), tuple_name, init_str);
+    for (int i = 0; i < stmt->name_count; i++)
+    {
+        Token name = stmt->names[i];
+        Type *element_type = type->as.tuple.element_types[i];
+        if (name.length == 1 && name.start[0] == '_')
+        {
+            if (element_type->kind == TYPE_STRING)
+            {
+                code_gen_restate_line(gen);
+                fprintf(gen->output, "rt_free_string(%s.f%d);\n", tuple_name, i);
+            }
+            continue;
+        }
+        // Each variable takes ownership of its element, strings included.
+        symbol_table_add_symbol_with_kind(gen->symbol_table, name, element_type, SYMBOL_LOCAL);
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "%s %s = %s.f%d;\n", get_c_type(gen->arena, element_type),
+                get_var_name(gen->arena, name), tuple_name, i);
+    }
+}
+
 static void code_gen_free_locals(CodeGen *gen, Scope *scope, bool is_function)
 {
     DEBUG_VERBOSE("Entering code_gen_free_locals");
     Symbol *sym = scope->symbols;
     while (sym)
     {
-        if (sym->type && sym->type->kind == TYPE_STRING && sym->kind == SYMBOL_LOCAL)
+        if (sym->type && sym->type->kind == TYPE_MAP && sym->kind == SYMBOL_LOCAL)
+        {
+            char *var_name = get_var_name(gen->arena, sym->name);
+            code_gen_restate_line(gen);
+            fprintf(gen->output, "rt_map_free(%s);\n", var_name);
+        }
+        else if (sym->type && sym->type->kind == TYPE_STRING && sym->kind == SYMBOL_LOCAL)
         {
             char *var_name = get_var_name(gen->arena, sym->name);
+            code_gen_restate_line(gen);
             fprintf(gen->output, "if (%s) {\n", var_name);
             if (is_function && gen->current_return_type && gen->current_return_type->kind == TYPE_STRING)
             {
+                code_gen_restate_line(gen);
                 fprintf(gen->output, "    if (%s != _return_value) {\n", var_name);
+                code_gen_restate_line(gen);
                 fprintf(gen->output, "        rt_free_string(%s);\n", var_name);
                 fprintf(gen->output, "    }\n");
             }
             else
             {
+                code_gen_restate_line(gen);
                 fprintf(gen->output, "    rt_free_string(%s);\n", var_name);
             }
             fprintf(gen->output, "}\n");
@@ -730,62 +1296,428 @@ void code_gen_block(CodeGen *gen, BlockStmt *stmt)
     symbol_table_pop_scope(gen->symbol_table);
 }
 
-// code_gen.c (updated code_gen_function, without 'static')
-void code_gen_function(CodeGen *gen, FunctionStmt *stmt)
+static void code_gen_param_list(CodeGen *gen, FunctionStmt *stmt)
 {
-    DEBUG_VERBOSE("Entering code_gen_function");
-    char *old_function = gen->current_function;
-    Type *old_return_type = gen->current_return_type;
-    gen->current_function = get_var_name(gen->arena, stmt->name);
-    gen->current_return_type = stmt->return_type;
-    bool is_main = strcmp(gen->current_function, "main") == 0;
-    // Special case for main: always use "int" return type in C for standard entry point.
-    const char *ret_c = is_main ? "int" : get_c_type(gen->current_return_type);
-    // Determine if we need a _return_value variable: only for non-void or main.
-    bool has_return_value = (gen->current_return_type && gen->current_return_type->kind != TYPE_VOID) || is_main;
-    symbol_table_push_scope(gen->symbol_table);
-    for (int i = 0; i < stmt->param_count; i++)
-    {
-        symbol_table_add_symbol_with_kind(gen->symbol_table, stmt->params[i].name, stmt->params[i].type, SYMBOL_PARAM);
-    }
-    fprintf(gen->output, "%s %s(", ret_c, gen->current_function);
     for (int i = 0; i < stmt->param_count; i++)
     {
-        const char *param_type_c = get_c_type(stmt->params[i].type);
+        const char *param_type_c = get_c_type(gen->arena, stmt->params[i].type);
         char *param_name = get_var_name(gen->arena, stmt->params[i].name);
-        fprintf(gen->output, "%s %s", param_type_c, param_name);
+        if (stmt->params[i].is_ref)
+        {
+            bool is_pointer = param_type_c[strlen(param_type_c) - 1] == '*';
+            param_type_c = arena_sprintf(gen->arena, is_pointer ? "%s*" : "%s *", param_type_c);
+        }
+        fprintf(gen->output, "%s%s%s", param_type_c, param_type_c[strlen(param_type_c) - 1] == '*' ? "" : " ",
+                param_name);
         if (i < stmt->param_count - 1)
         {
             fprintf(gen->output, ", ");
         }
     }
-    fprintf(gen->output, ") {\n");
-    // Add _return_value only if needed (non-void or main).
-    if (has_return_value)
+}
+
+// Remembers a top-level function for the address table emitted by code_gen_sample_table.
+static void code_gen_record_function(CodeGen *gen, const char *c_name)
+{
+    DEBUG_VERBOSE("Entering code_gen_record_function");
+    if (gen->function_count >= gen->function_capacity)
     {
-        const char *default_val = is_main ? "0" : get_default_value(gen->current_return_type);
-        fprintf(gen->output, "    %s _return_value = %s;\n", ret_c, default_val);
+        int new_capacity = gen->function_capacity == 0 ? 16 : gen->function_capacity * 2;
+        char **new_functions = arena_alloc(gen->arena, sizeof(char *) * new_capacity);
+        if (gen->function_count > 0)
+        {
+            memcpy(new_functions, gen->functions, sizeof(char *) * gen->function_count);
+        }
+        gen->functions = new_functions;
+        gen->function_capacity = new_capacity;
     }
-    for (int i = 0; i < stmt->body_count; i++)
+    gen->functions[gen->function_count++] = arena_strdup(gen->arena, c_name);
+}
+
+// Numbers the next profiling site in the current function. With --coverage the
+// site also gets a pair of counters and the index of the first is returned,
+// otherwise -1; with --use-profile, *profiled is set to its counts or NULL.
+static int code_gen_coverage_site(CodeGen *gen, CoverageKind kind, int line, CoverageSite **profiled)
+{
+    DEBUG_VERBOSE("Entering code_gen_coverage_site");
+    *profiled = NULL;
+    if (gen->current_function == NULL)
     {
-        code_gen_statement(gen, stmt->body[i]);
+        return -1;
     }
-    fprintf(gen->output, "goto %s_return;\n", gen->current_function);
-    fprintf(gen->output, "%s_return:\n", gen->current_function);
-    code_gen_free_locals(gen, gen->symbol_table->current, true);
-    // Return _return_value only if needed; otherwise, plain return.
-    if (has_return_value)
+    int ordinal = gen->coverage_ordinal++;
+    if (gen->use_profile != NULL)
     {
-        fprintf(gen->output, "    return _return_value;\n");
+        *profiled = coverage_profile_site(gen->use_profile, gen->current_function, ordinal, kind, line);
+    }
+    if (!gen->coverage)
+    {
+        return -1;
+    }
+    if (gen->coverage_site_count >= gen->coverage_site_capacity)
+    {
+        int new_capacity = gen->coverage_site_capacity == 0 ? 64 : gen->coverage_site_capacity * 2;
+        char **new_sites = arena_alloc(gen->arena, sizeof(char *) * new_capacity);
+        if (gen->coverage_site_count > 0)
+        {
+            memcpy(new_sites, gen->coverage_sites, sizeof(char *) * gen->coverage_site_count);
+        }
+        gen->coverage_sites = new_sites;
+        gen->coverage_site_capacity = new_capacity;
+    }
+    gen->coverage_sites[gen->coverage_site_count] =
+        arena_sprintf(gen->arena, "%s %d %s %d", gen->current_function, ordinal, coverage_kind_name(kind), line);
+    return 2 * gen->coverage_site_count++;
+}
+
+// Counts a branch or loop condition's outcomes under --coverage, and wraps it
+// in __builtin_expect when the profile shows it going one way almost always.
+static char *code_gen_profiled_condition(CodeGen *gen, char *cond_str, Expr *condition, CoverageKind kind)
+{
+    DEBUG_VERBOSE("Entering code_gen_profiled_condition");
+    CoverageSite *profiled;
+    int slot = code_gen_coverage_site(gen, kind, condition->token != NULL ? condition->token->line : 0, &profiled);
+    int expected = coverage_site_expectation(profiled);
+    if (expected >= 0)
+    {
+        cond_str = arena_sprintf(gen->arena, "__builtin_expect(!!(%s), %d)", cond_str, expected);
+    }
+    if (slot >= 0)
+    {
+        cond_str = arena_sprintf(gen->arena, "SN_COV(%s, %d)", cond_str, slot);
+    }
+    return cond_str;
+}
+
+// With --use-profile, a function the training run never entered is cold and
+// kept out of line in its callers, and the few functions that account for most
+// of the profile are hot and optimized (and inlined into) more aggressively.
+// Each kind is grouped in its own section, away from the rest.
+static const char *code_gen_text_section(CodeGen *gen)
+{
+    DEBUG_VERBOSE("Entering code_gen_text_section");
+    if (gen->use_profile == NULL)
+    {
+        return "SN_TEXT";
+    }
+    CoverageFunction *fn = coverage_profile_function(gen->use_profile, gen->current_function);
+    if (fn == NULL)
+    {
+        return "SN_TEXT";
+    }
+    if (fn->entries == 0)
+    {
+        return "SN_TEXT_COLD";
+    }
+    if (fn->hot)
+    {
+        return "SN_TEXT_HOT";
+    }
+    return "SN_TEXT";
+}
+
+static void code_gen_function_definition(CodeGen *gen, FunctionStmt *stmt, const char *c_name, bool is_static)
+{
+    DEBUG_VERBOSE("Entering code_gen_function_definition");
+    char *old_function = gen->current_function;
+    if (old_function == NULL)
+    {
+        code_gen_record_function(gen, c_name);
+    }
+    Type *old_return_type = gen->current_return_type;
+    bool old_checks_enabled = gen->checks_enabled;
+    bool old_fast_math = gen->fast_math;
+    int old_coverage_ordinal = gen->coverage_ordinal;
+    Token *old_line_token = gen->line_token;
+    // The prologue and shared epilogue belong to the function as a whole, so map them to its declaration.
+    gen->line_token = &stmt->name;
+    gen->current_function = arena_strdup(gen->arena, c_name);
+    gen->coverage_ordinal = 0;
+    gen->checks_enabled = code_gen_checks_for_function(gen->profile, stmt->annotations);
+    gen->fast_math = (stmt->annotations & FUNC_ANNOTATION_FASTMATH) != 0;
+    gen->current_return_type = stmt->return_type;
+    bool is_main = strcmp(gen->current_function, "main") == 0;
+    // Special case for main: always use "int" return type in C for standard entry point.
+    const char *ret_c = is_main ? "int" : get_c_type(gen->arena, gen->current_return_type);
+    // Determine if we need a _return_value variable: only for non-void or main.
+    bool has_return_value = (gen->current_return_type && gen->current_return_type->kind != TYPE_VOID) || is_main;
+    symbol_table_push_scope(gen->symbol_table);
+    for (int i = 0; i < stmt->param_count; i++)
+    {
+        symbol_table_add_symbol_with_kind(gen->symbol_table, stmt->params[i].name, stmt->params[i].type,
+                                          stmt->params[i].is_ref ? SYMBOL_REF_PARAM : SYMBOL_PARAM);
+    }
+    if (gen->instrument)
+    {
+        // Filled in by the runtime on the first call, so later calls skip the lookup.
+        fprintf(gen->output, "static RtProfFunction *__sn_prof_%s;\n", gen->current_function);
+    }
+    CoverageSite *profiled;
+    int entry_slot = code_gen_coverage_site(gen, COVERAGE_FUNCTION, stmt->name.line, &profiled);
+    const char *section = code_gen_text_section(gen);
+    if (gen->fast_math)
+    {
+        // Let GCC reassociate, vectorize and contract into FMA within this function only.
+        fprintf(gen->output, "__attribute__((optimize(\"fast-math\"))) ");
+    }
+    fprintf(gen->output, "%s %s%s %s(", section, is_static ? "static " : "", ret_c, gen->current_function);
+    code_gen_param_list(gen, stmt);
+    fprintf(gen->output, ") {\n");
+    // Add _return_value only if needed (non-void or main).
+    if (has_return_value)
+    {
+        const char *default_val = is_main ? "0" : get_default_value(gen->current_return_type);
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    %s _return_value = %s;\n", ret_c, default_val);
+    }
+    if (entry_slot >= 0)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    __sn_cov[%d]++;\n", entry_slot);
+    }
+    if (gen->instrument)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    rt_prof_enter(&__sn_prof_%s, \"%s\");\n", gen->current_function, gen->current_function);
+    }
+    if (gen->trace != TRACE_OFF)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    static long __sn_trace_site = 0;\n");
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    long __sn_trace_depth = rt_trace_begin(&__sn_trace_site, \"%s\");\n", gen->current_function);
+    }
+    if (is_main && gen->has_benches)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    if (rt_bench_requested()) { __sn_run_benches(); return 0; }\n");
+    }
+    for (int i = 0; i < stmt->body_count; i++)
+    {
+        code_gen_statement(gen, stmt->body[i]);
+    }
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "goto %s_return;\n", gen->current_function);
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "%s_return:\n", gen->current_function);
+    code_gen_free_locals(gen, gen->symbol_table->current, true);
+    if (gen->trace != TRACE_OFF)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    rt_trace_end(__sn_trace_depth);\n");
+    }
+    if (gen->instrument)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    rt_prof_exit();\n");
+    }
+    // Return _return_value only if needed; otherwise, plain return.
+    if (has_return_value)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    return _return_value;\n");
     }
     else
     {
+        code_gen_restate_line(gen);
         fprintf(gen->output, "    return;\n");
     }
     fprintf(gen->output, "}\n\n");
     symbol_table_pop_scope(gen->symbol_table);
     gen->current_function = old_function;
     gen->current_return_type = old_return_type;
+    gen->checks_enabled = old_checks_enabled;
+    gen->fast_math = old_fast_math;
+    gen->coverage_ordinal = old_coverage_ordinal;
+    gen->line_token = old_line_token;
+}
+
+// A @memo function is emitted as a static implementation plus a public wrapper
+// that consults a per-function runtime memo table. Recursive calls in the body
+// resolve to the wrapper, so subproblems are memoized too.
+static void code_gen_memo_function(CodeGen *gen, FunctionStmt *stmt)
+{
+    DEBUG_VERBOSE("Entering code_gen_memo_function");
+    char *name = get_var_name(gen->arena, stmt->name);
+    char *impl_name = arena_sprintf(gen->arena, "__sn_memo_%s", name);
+    const char *ret_c = get_c_type(gen->arena, stmt->return_type);
+    bool str_result = stmt->return_type->kind == TYPE_STRING;
+    const char *result_field = str_result ? "s" : (stmt->return_type->kind == TYPE_DOUBLE ? "d" : "l");
+    long str_mask = 0;
+    for (int i = 0; i < stmt->param_count; i++)
+    {
+        if (stmt->params[i].type->kind == TYPE_STRING)
+        {
+            str_mask |= 1L << i;
+        }
+    }
+
+    fprintf(gen->output, "%s %s(", ret_c, name);
+    code_gen_param_list(gen, stmt);
+    fprintf(gen->output, ");\n\n");
+
+    code_gen_function_definition(gen, stmt, impl_name, true);
+    code_gen_record_function(gen, name);
+
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "SN_TEXT %s %s(", ret_c, name);
+    code_gen_param_list(gen, stmt);
+    fprintf(gen->output, ") {\n");
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    static RtMemo *__memo_table = NULL;\n");
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    if (__memo_table == NULL) __memo_table = rt_memo_create(%d, %ldL, %dL, %dL);\n",
+            stmt->param_count, str_mask, str_result ? 1 : 0, stmt->memo_limit);
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    RtValue __memo_key[%d];\n", stmt->param_count > 0 ? stmt->param_count : 1);
+    for (int i = 0; i < stmt->param_count; i++)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "    __memo_key[%d].%s = %s;\n", i,
+                stmt->params[i].type->kind == TYPE_STRING ? "s" : "l",
+                get_var_name(gen->arena, stmt->params[i].name));
+    }
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    RtValue __memo_result;\n");
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    if (rt_memo_get(__memo_table, __memo_key, &__memo_result)) return __memo_result.%s;\n", result_field);
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    __memo_result.%s = %s(", result_field, impl_name);
+    for (int i = 0; i < stmt->param_count; i++)
+    {
+        fprintf(gen->output, "%s%s", i > 0 ? ", " : "", get_var_name(gen->arena, stmt->params[i].name));
+    }
+    fprintf(gen->output, ");\n");
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    rt_memo_put(__memo_table, __memo_key, __memo_result);\n");
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    return __memo_result.%s;\n", result_field);
+    fprintf(gen->output, "}\n\n");
+}
+
+// With --emit-stats, a function is emitted into a memory buffer that is scanned
+// for metrics and then copied to the real output. Returns the real output, or
+// NULL when stats are off (or a buffer could not be opened). A nested function
+// is counted as part of the top-level function whose buffer it lands in.
+static FILE *code_gen_stats_begin(CodeGen *gen, char **buffer, size_t *size)
+{
+    DEBUG_VERBOSE("Entering code_gen_stats_begin");
+    if (gen->stats == NULL || gen->current_function != NULL)
+    {
+        return NULL;
+    }
+    FILE *output = gen->output;
+    gen->output = open_memstream(buffer, size);
+    if (gen->output == NULL)
+    {
+        DEBUG_WARNING("Cannot buffer generated code for --emit-stats; function left out of the report");
+        gen->output = output;
+        return NULL;
+    }
+    return output;
+}
+
+static void code_gen_stats_end(CodeGen *gen, FILE *output, const char *name, char **buffer, size_t *size)
+{
+    DEBUG_VERBOSE("Entering code_gen_stats_end");
+    if (output == NULL)
+    {
+        return;
+    }
+    // Closing the stream is what publishes the final buffer and size.
+    fclose(gen->output);
+    gen->output = output;
+    emit_stats_scan_function(gen->stats, name, *buffer, *size);
+    fwrite(*buffer, 1, *size, gen->output);
+    free(*buffer);
+}
+
+void code_gen_function(CodeGen *gen, FunctionStmt *stmt)
+{
+    DEBUG_VERBOSE("Entering code_gen_function");
+    char *name = get_var_name(gen->arena, stmt->name);
+    char *buffer = NULL;
+    size_t size = 0;
+    FILE *output = code_gen_stats_begin(gen, &buffer, &size);
+    if (stmt->annotations & FUNC_ANNOTATION_MEMO)
+    {
+        code_gen_memo_function(gen, stmt);
+    }
+    else
+    {
+        code_gen_function_definition(gen, stmt, name, false);
+    }
+    code_gen_stats_end(gen, output, name, &buffer, &size);
+}
+
+// A bench body becomes a static void function that the runtime harness calls
+// in a timed loop. Locals still in scope at the end are fed to an empty asm so
+// the C compiler cannot discard the work that produced them.
+void code_gen_bench(CodeGen *gen, BenchStmt *stmt)
+{
+    DEBUG_VERBOSE("Entering code_gen_bench");
+    char *old_function = gen->current_function;
+    Type *old_return_type = gen->current_return_type;
+    bool old_checks_enabled = gen->checks_enabled;
+    bool old_fast_math = gen->fast_math;
+    int old_coverage_ordinal = gen->coverage_ordinal;
+    char *buffer = NULL;
+    size_t size = 0;
+    FILE *output = code_gen_stats_begin(gen, &buffer, &size);
+    gen->current_function = arena_sprintf(gen->arena, "__sn_bench_%d", gen->bench_count++);
+    gen->coverage_ordinal = 0;
+    gen->current_return_type = ast_create_primitive_type(gen->arena, TYPE_VOID);
+    code_gen_record_function(gen, gen->current_function);
+    gen->checks_enabled = code_gen_checks_for_function(gen->profile, FUNC_ANNOTATION_NONE);
+    gen->fast_math = false;
+    symbol_table_push_scope(gen->symbol_table);
+    fprintf(gen->output, "SN_TEXT static void %s(void) {\n", gen->current_function);
+    for (int i = 0; i < stmt->body_count; i++)
+    {
+        code_gen_statement(gen, stmt->body[i]);
+    }
+    for (Symbol *sym = gen->symbol_table->current->symbols; sym != NULL; sym = sym->next)
+    {
+        if (sym->kind == SYMBOL_LOCAL)
+        {
+            code_gen_restate_line(gen);
+            fprintf(gen->output, "__asm__ __volatile__(\"\" : : \"g\"(%s) : \"memory\");\n",
+                    get_var_name(gen->arena, sym->name));
+        }
+    }
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "goto %s_return;\n", gen->current_function);
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "%s_return:\n", gen->current_function);
+    code_gen_free_locals(gen, gen->symbol_table->current, true);
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "    return;\n");
+    fprintf(gen->output, "}\n\n");
+    code_gen_stats_end(gen, output, gen->current_function, &buffer, &size);
+    symbol_table_pop_scope(gen->symbol_table);
+    gen->current_function = old_function;
+    gen->current_return_type = old_return_type;
+    gen->checks_enabled = old_checks_enabled;
+    gen->fast_math = old_fast_math;
+    gen->coverage_ordinal = old_coverage_ordinal;
+}
+
+// Runs every bench block in source order; main calls this when SN_BENCH is set.
+static void code_gen_bench_runner(CodeGen *gen, Module *module)
+{
+    DEBUG_VERBOSE("Entering code_gen_bench_runner");
+    code_gen_record_function(gen, "__sn_run_benches");
+    fprintf(gen->output, "SN_TEXT static void __sn_run_benches(void) {\n");
+    int index = 0;
+    for (int i = 0; i < module->count; i++)
+    {
+        if (module->statements[i]->type == STMT_BENCH)
+        {
+            fprintf(gen->output, "    rt_bench_run(%s, __sn_bench_%d);\n",
+                    escape_c_string(gen->arena, module->statements[i]->as.bench.name), index++);
+        }
+    }
+    fprintf(gen->output, "}\n\n");
 }
 
 void code_gen_return_statement(CodeGen *gen, ReturnStmt *stmt)
@@ -794,7 +1726,18 @@ void code_gen_return_statement(CodeGen *gen, ReturnStmt *stmt)
     if (stmt->value)
     {
         char *value_str = code_gen_expression(gen, stmt->value);
+        if (stmt->value->type == EXPR_VARIABLE && stmt->value->expr_type &&
+            stmt->value->expr_type->kind == TYPE_STRING)
+        {
+            // Callers own returned strings, so a borrowed parameter must be copied.
+            Symbol *sym = symbol_table_lookup_symbol(gen->symbol_table, stmt->value->as.variable.name);
+            if (sym && (sym->kind == SYMBOL_PARAM || sym->kind == SYMBOL_REF_PARAM))
+            {
+                value_str = arena_sprintf(gen->arena, "rt_to_string_string(%s)", value_str);
+            }
+        }
         fprintf(gen->output, "_return_value = %s;\n", value_str);
+        code_gen_restate_line(gen);
     }
     fprintf(gen->output, "goto %s_return;\n", gen->current_function);
 }
@@ -803,6 +1746,7 @@ void code_gen_if_statement(CodeGen *gen, IfStmt *stmt)
 {
     DEBUG_VERBOSE("Entering code_gen_if_statement");
     char *cond_str = code_gen_expression(gen, stmt->condition);
+    cond_str = code_gen_profiled_condition(gen, cond_str, stmt->condition, COVERAGE_IF);
     fprintf(gen->output, "if (%s) {\n", cond_str);
     code_gen_statement(gen, stmt->then_branch);
     fprintf(gen->output, "}\n");
@@ -818,6 +1762,7 @@ void code_gen_while_statement(CodeGen *gen, WhileStmt *stmt)
 {
     DEBUG_VERBOSE("Entering code_gen_while_statement");
     char *cond_str = code_gen_expression(gen, stmt->condition);
+    cond_str = code_gen_profiled_condition(gen, cond_str, stmt->condition, COVERAGE_WHILE);
     fprintf(gen->output, "while (%s) {\n", cond_str);
     code_gen_statement(gen, stmt->body);
     fprintf(gen->output, "}\n");
@@ -836,12 +1781,15 @@ void code_gen_for_statement(CodeGen *gen, ForStmt *stmt)
     if (stmt->condition)
     {
         cond_str = code_gen_expression(gen, stmt->condition);
+        cond_str = code_gen_profiled_condition(gen, cond_str, stmt->condition, COVERAGE_FOR);
     }
+    code_gen_restate_line(gen);
     fprintf(gen->output, "while (%s) {\n", cond_str ? cond_str : "1");
     code_gen_statement(gen, stmt->body);
     if (stmt->increment)
     {
         char *inc_str = code_gen_expression(gen, stmt->increment);
+        code_gen_restate_line(gen);
         fprintf(gen->output, "%s;\n", inc_str);
     }
     fprintf(gen->output, "}\n");
@@ -850,9 +1798,219 @@ void code_gen_for_statement(CodeGen *gen, ForStmt *stmt)
     symbol_table_pop_scope(gen->symbol_table);
 }
 
+static char *code_gen_match_label(CodeGen *gen, Expr *value)
+{
+    if (value->type == EXPR_UNARY)
+    {
+        return arena_sprintf(gen->arena, "-%ldL", (long)value->as.unary.operand->as.literal.value.int_value);
+    }
+    return code_gen_literal_expression(gen, &value->as.literal);
+}
+
+static void code_gen_match_body(CodeGen *gen, Stmt *body)
+{
+    DEBUG_VERBOSE("Entering code_gen_match_body");
+    if (body->type == STMT_BLOCK)
+    {
+        code_gen_statement(gen, body);
+        return;
+    }
+    symbol_table_push_scope(gen->symbol_table);
+    fprintf(gen->output, "{\n");
+    code_gen_statement(gen, body);
+    code_gen_free_locals(gen, gen->symbol_table->current, false);
+    fprintf(gen->output, "}\n");
+    symbol_table_pop_scope(gen->symbol_table);
+}
+
+/* Find a seed and power-of-two mask under which every string case value hashes
+ * to its own bucket, so dispatch costs one hash and at most one strcmp. */
+static bool code_gen_match_perfect_hash(MatchStmt *stmt, int value_count, unsigned long *seed_out,
+                                        unsigned long *mask_out)
+{
+    DEBUG_VERBOSE("Entering code_gen_match_perfect_hash");
+    unsigned long size = 1;
+    while (size < (unsigned long)value_count * 2)
+    {
+        size <<= 1;
+    }
+    for (; size <= (unsigned long)value_count * 64 + 64; size <<= 1)
+    {
+        unsigned char *used = calloc(size, 1);
+        for (unsigned long seed = 0; seed < 4096; seed++)
+        {
+            memset(used, 0, size);
+            bool collision = false;
+            for (int i = 0; !collision && i < stmt->case_count; i++)
+            {
+                for (int j = 0; !collision && j < stmt->cases[i].value_count; j++)
+                {
+                    const char *str = stmt->cases[i].values[j]->as.literal.value.string_value;
+                    unsigned long bucket = rt_str_hash_seeded(seed, str) & (size - 1);
+                    collision = used[bucket];
+                    used[bucket] = 1;
+                }
+            }
+            if (!collision)
+            {
+                free(used);
+                *seed_out = seed;
+                *mask_out = size - 1;
+                return true;
+            }
+        }
+        free(used);
+    }
+    return false;
+}
+
+static void code_gen_match_string_dispatch(CodeGen *gen, MatchStmt *stmt)
+{
+    DEBUG_VERBOSE("Entering code_gen_match_string_dispatch");
+    int value_count = 0;
+    for (int i = 0; i < stmt->case_count; i++)
+    {
+        value_count += stmt->cases[i].value_count;
+    }
+    unsigned long seed = 0;
+    unsigned long mask = 0;
+    bool perfect = value_count > 0 && code_gen_match_perfect_hash(stmt, value_count, &seed, &mask);
+
+    if (perfect)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "switch (rt_str_hash_seeded(%luUL, _match_subject) & %luUL) {\n", seed, mask);
+    }
+    for (int i = 0; i < stmt->case_count; i++)
+    {
+        for (int j = 0; j < stmt->cases[i].value_count; j++)
+        {
+            const char *str = stmt->cases[i].values[j]->as.literal.value.string_value;
+            char *escaped = escape_c_string(gen->arena, str);
+            if (perfect)
+            {
+                code_gen_restate_line(gen);
+                fprintf(gen->output, "case %luUL: if (strcmp(_match_subject, %s) == 0) _match_case = %d; break;\n",
+                        rt_str_hash_seeded(seed, str) & mask, escaped, i);
+            }
+            else
+            {
+                code_gen_restate_line(gen);
+                fprintf(gen->output, "if (_match_case < 0 && strcmp(_match_subject, %s) == 0) _match_case = %d;\n",
+                        escaped, i);
+            }
+        }
+    }
+    if (perfect)
+    {
+        fprintf(gen->output, "}\n");
+    }
+}
+
+void code_gen_match_statement(CodeGen *gen, MatchStmt *stmt)
+{
+    DEBUG_VERBOSE("Entering code_gen_match_statement");
+    char *subject_str = code_gen_expression(gen, stmt->subject);
+    fprintf(gen->output, "{\n");
+    if (stmt->subject->expr_type->kind == TYPE_STRING)
+    {
+        /* Strings are resolved to a case index first, then dispatched like integers. */
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "char *_match_subject = %s;\n", subject_str);
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "long _match_case = -1;\n");
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "if (_match_subject != NULL) {\n");
+        code_gen_match_string_dispatch(gen, stmt);
+        fprintf(gen->output, "}\n");
+        if (expression_produces_temp(stmt->subject))
+        {
+            code_gen_restate_line(gen);
+            fprintf(gen->output, "rt_free_string(_match_subject);\n");
+        }
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "switch (_match_case) {\n");
+        for (int i = 0; i < stmt->case_count; i++)
+        {
+            code_gen_restate_line(gen);
+            fprintf(gen->output, "case %d:\n", i);
+            code_gen_match_body(gen, stmt->cases[i].body);
+            code_gen_restate_line(gen);
+            fprintf(gen->output, "break;\n");
+        }
+    }
+    else
+    {
+        /* Case values are literals, so gcc can lower a dense switch to a jump table. */
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "switch (%s) {\n", subject_str);
+        for (int i = 0; i < stmt->case_count; i++)
+        {
+            for (int j = 0; j < stmt->cases[i].value_count; j++)
+            {
+                code_gen_restate_line(gen);
+                fprintf(gen->output, "case %s:\n", code_gen_match_label(gen, stmt->cases[i].values[j]));
+            }
+            code_gen_match_body(gen, stmt->cases[i].body);
+            code_gen_restate_line(gen);
+            fprintf(gen->output, "break;\n");
+        }
+    }
+    if (stmt->else_branch)
+    {
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "default:\n");
+        code_gen_match_body(gen, stmt->else_branch);
+        code_gen_restate_line(gen);
+        fprintf(gen->output, "break;\n");
+    }
+    fprintf(gen->output, "}\n");
+    fprintf(gen->output, "}\n");
+}
+
+// With --trace=loops a loop runs inside its own span. A return out of the loop
+// skips rt_trace_end here, but the function's rt_trace_end closes it.
+static void code_gen_loop_trace_begin(CodeGen *gen, Stmt *stmt, const char *kind)
+{
+    DEBUG_VERBOSE("Entering code_gen_loop_trace_begin");
+    if (gen->trace != TRACE_LOOPS || gen->current_function == NULL)
+    {
+        return;
+    }
+    fprintf(gen->output, "{\n");
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "static long __sn_trace_site = 0;\n");
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "long __sn_trace_loop = rt_trace_begin(&__sn_trace_site, \"%s %s line %d\");\n",
+            gen->current_function, kind, stmt->token != NULL ? stmt->token->line : 0);
+}
+
+static void code_gen_loop_trace_end(CodeGen *gen)
+{
+    DEBUG_VERBOSE("Entering code_gen_loop_trace_end");
+    if (gen->trace != TRACE_LOOPS || gen->current_function == NULL)
+    {
+        return;
+    }
+    code_gen_restate_line(gen);
+    fprintf(gen->output, "rt_trace_end(__sn_trace_loop);\n");
+    fprintf(gen->output, "}\n");
+}
+
 void code_gen_statement(CodeGen *gen, Stmt *stmt)
 {
     DEBUG_VERBOSE("Entering code_gen_statement");
+    if (stmt->type == STMT_IMPORT)
+    {
+        return;
+    }
+    // Blocks the parser synthesized have no token and stay under their owner.
+    Token *old_line_token = gen->line_token;
+    if (stmt->token != NULL)
+    {
+        gen->line_token = stmt->token;
+    }
+    code_gen_line_directive(gen, stmt->token);
     switch (stmt->type)
     {
     case STMT_EXPR:
@@ -861,6 +2019,9 @@ void code_gen_statement(CodeGen *gen, Stmt *stmt)
     case STMT_VAR_DECL:
         code_gen_var_declaration(gen, &stmt->as.var_decl);
         break;
+    case STMT_VAR_TUPLE:
+        code_gen_var_tuple_declaration(gen, &stmt->as.var_tuple);
+        break;
     case STMT_FUNCTION:
         code_gen_function(gen, &stmt->as.function);
         break;
@@ -874,14 +2035,170 @@ void code_gen_statement(CodeGen *gen, Stmt *stmt)
         code_gen_if_statement(gen, &stmt->as.if_stmt);
         break;
     case STMT_WHILE:
+        code_gen_loop_trace_begin(gen, stmt, "while");
         code_gen_while_statement(gen, &stmt->as.while_stmt);
+        code_gen_loop_trace_end(gen);
         break;
     case STMT_FOR:
+        code_gen_loop_trace_begin(gen, stmt, "for");
         code_gen_for_statement(gen, &stmt->as.for_stmt);
+        code_gen_loop_trace_end(gen);
+        break;
+    case STMT_MATCH:
+        code_gen_match_statement(gen, &stmt->as.match_stmt);
+        break;
+    case STMT_BENCH:
+        code_gen_bench(gen, &stmt->as.bench);
         break;
     case STMT_IMPORT:
         break;
     }
+    gen->line_token = old_line_token;
+}
+
+// Emits the struct for one tuple shape, unless an earlier use already did.
+static void code_gen_tuple_typedef(CodeGen *gen, Type *type, char ***emitted, int *emitted_count,
+                                   int *emitted_capacity)
+{
+    DEBUG_VERBOSE("Entering code_gen_tuple_typedef");
+    if (type == NULL || type->kind != TYPE_TUPLE)
+    {
+        return;
+    }
+
+    char *name = get_tuple_c_name(gen->arena, type);
+    for (int j = 0; j < *emitted_count; j++)
+    {
+        if (strcmp((*emitted)[j], name) == 0)
+        {
+            return;
+        }
+    }
+    if (*emitted_count >= *emitted_capacity)
+    {
+        *emitted_capacity = *emitted_capacity == 0 ? 8 : *emitted_capacity * 2;
+        char **new_emitted = arena_alloc(gen->arena, sizeof(char *) * *emitted_capacity);
+        if (*emitted_count > 0)
+        {
+            memcpy(new_emitted, *emitted, sizeof(char *) * *emitted_count);
+        }
+        *emitted = new_emitted;
+    }
+    (*emitted)[(*emitted_count)++] = name;
+
+    fprintf(gen->output, "typedef struct { ");
+    for (int j = 0; j < type->as.tuple.element_count; j++)
+    {
+        fprintf(gen->output, "%s f%d; ", get_c_type(gen->arena, type->as.tuple.element_types[j]), j);
+    }
+    fprintf(gen->output, "} %s;\n", name);
+}
+
+/* Tuple values only appear as function results, destructuring initializers
+ * and discarded expression statements, so those are the shapes to declare. */
+static void code_gen_tuple_typedefs(CodeGen *gen, Stmt **statements, int count, char ***emitted,
+                                    int *emitted_count, int *emitted_capacity)
+{
+    DEBUG_VERBOSE("Entering code_gen_tuple_typedefs");
+    for (int i = 0; i < count; i++)
+    {
+        Stmt *stmt = statements[i];
+        if (stmt == NULL)
+        {
+            continue;
+        }
+        switch (stmt->type)
+        {
+        case STMT_FUNCTION:
+            code_gen_tuple_typedef(gen, stmt->as.function.return_type, emitted, emitted_count, emitted_capacity);
+            code_gen_tuple_typedefs(gen, stmt->as.function.body, stmt->as.function.body_count, emitted,
+                                    emitted_count, emitted_capacity);
+            break;
+        case STMT_VAR_TUPLE:
+            code_gen_tuple_typedef(gen, stmt->as.var_tuple.initializer->expr_type, emitted, emitted_count,
+                                   emitted_capacity);
+            break;
+        case STMT_EXPR:
+            code_gen_tuple_typedef(gen, stmt->as.expression.expression->expr_type, emitted, emitted_count,
+                                   emitted_capacity);
+            break;
+        case STMT_BLOCK:
+            code_gen_tuple_typedefs(gen, stmt->as.block.statements, stmt->as.block.count, emitted,
+                                    emitted_count, emitted_capacity);
+            break;
+        case STMT_IF:
+            code_gen_tuple_typedefs(gen, &stmt->as.if_stmt.then_branch, 1, emitted, emitted_count,
+                                    emitted_capacity);
+            code_gen_tuple_typedefs(gen, &stmt->as.if_stmt.else_branch, 1, emitted, emitted_count,
+                                    emitted_capacity);
+            break;
+        case STMT_WHILE:
+            code_gen_tuple_typedefs(gen, &stmt->as.while_stmt.body, 1, emitted, emitted_count, emitted_capacity);
+            break;
+        case STMT_FOR:
+            code_gen_tuple_typedefs(gen, &stmt->as.for_stmt.body, 1, emitted, emitted_count, emitted_capacity);
+            break;
+        case STMT_MATCH:
+            for (int j = 0; j < stmt->as.match_stmt.case_count; j++)
+            {
+                code_gen_tuple_typedefs(gen, &stmt->as.match_stmt.cases[j].body, 1, emitted, emitted_count,
+                                        emitted_capacity);
+            }
+            code_gen_tuple_typedefs(gen, &stmt->as.match_stmt.else_branch, 1, emitted, emitted_count,
+                                    emitted_capacity);
+            break;
+        case STMT_BENCH:
+            code_gen_tuple_typedefs(gen, stmt->as.bench.body, stmt->as.bench.body_count, emitted, emitted_count,
+                                    emitted_capacity);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Registers the start address of every emitted function, and the bounds of
+// the sn_text sections they live in, with the sampling profiler.
+static void code_gen_sample_table(CodeGen *gen)
+{
+    DEBUG_VERBOSE("Entering code_gen_sample_table");
+    fprintf(gen->output, "\n#ifdef __ELF__\n");
+    fprintf(gen->output, "__attribute__((constructor)) static void __sn_register_functions(void) {\n");
+    fprintf(gen->output, "    static const RtSampleFunction functions[] = {\n");
+    for (int i = 0; i < gen->function_count; i++)
+    {
+        fprintf(gen->output, "        {\"%s\", (void *)%s},\n", gen->functions[i], gen->functions[i]);
+    }
+    fprintf(gen->output, "    };\n");
+    fprintf(gen->output, "    static const RtSampleRange ranges[] = {\n");
+    fprintf(gen->output, "        {__start_sn_text, __stop_sn_text},\n");
+    fprintf(gen->output, "        {__start_sn_text_hot, __stop_sn_text_hot},\n");
+    fprintf(gen->output, "        {__start_sn_text_unlikely, __stop_sn_text_unlikely},\n");
+    fprintf(gen->output, "    };\n");
+    fprintf(gen->output, "    rt_sample_register(functions, %d, ranges, 3);\n", gen->function_count);
+    fprintf(gen->output, "}\n");
+    fprintf(gen->output, "#endif\n");
+}
+
+// Defines the --coverage counters and registers them, with a description of
+// each site, so the runtime can write the profile at exit.
+static void code_gen_coverage_table(CodeGen *gen)
+{
+    DEBUG_VERBOSE("Entering code_gen_coverage_table");
+    if (!gen->coverage || gen->coverage_site_count == 0)
+    {
+        return;
+    }
+    fprintf(gen->output, "\nlong __sn_cov[%d];\n", 2 * gen->coverage_site_count);
+    fprintf(gen->output, "static const char *const __sn_cov_sites[] = {\n");
+    for (int i = 0; i < gen->coverage_site_count; i++)
+    {
+        fprintf(gen->output, "    %s,\n", escape_c_string(gen->arena, gen->coverage_sites[i]));
+    }
+    fprintf(gen->output, "};\n");
+    fprintf(gen->output, "__attribute__((constructor)) static void __sn_register_coverage(void) {\n");
+    fprintf(gen->output, "    rt_cov_register(__sn_cov, __sn_cov_sites, %d);\n", gen->coverage_site_count);
+    fprintf(gen->output, "}\n");
 }
 
 void code_gen_module(CodeGen *gen, Module *module)
@@ -889,6 +2206,23 @@ void code_gen_module(CodeGen *gen, Module *module)
     DEBUG_VERBOSE("Entering code_gen_module");
     code_gen_headers(gen);
     code_gen_externs(gen);
+    // Small structs are returned in registers under the SysV ABI (up to two eightbytes).
+    char **emitted = NULL;
+    int emitted_count = 0;
+    int emitted_capacity = 0;
+    code_gen_tuple_typedefs(gen, module->statements, module->count, &emitted, &emitted_count, &emitted_capacity);
+    gen->checks_enabled = code_gen_checks_for_function(gen->profile, FUNC_ANNOTATION_NONE);
+    for (int i = 0; i < module->count; i++)
+    {
+        if (module->statements[i]->type == STMT_BENCH)
+        {
+            gen->has_benches = true;
+        }
+    }
+    if (gen->has_benches)
+    {
+        fprintf(gen->output, "static void __sn_run_benches(void);\n\n");
+    }
     bool has_main = false;
     for (int i = 0; i < module->count; i++)
     {
@@ -902,11 +2236,24 @@ void code_gen_module(CodeGen *gen, Module *module)
         }
         code_gen_statement(gen, module->statements[i]);
     }
+    code_gen_line_reset(gen);
     if (!has_main)
     {
         // If no main is defined, add a dummy int main() for valid C program entry point.
-        fprintf(gen->output, "int main() {\n");
+        code_gen_record_function(gen, "main");
+        fprintf(gen->output, "SN_TEXT int main() {\n");
+        if (gen->has_benches)
+        {
+            fprintf(gen->output, "    if (rt_bench_requested()) __sn_run_benches();\n");
+        }
         fprintf(gen->output, "    return 0;\n");
         fprintf(gen->output, "}\n");
     }
+    if (gen->has_benches)
+    {
+        fprintf(gen->output, "\n");
+        code_gen_bench_runner(gen, module);
+    }
+    code_gen_sample_table(gen);
+    code_gen_coverage_table(gen);
 }
\ No newline at end of file
@@ -3,17 +3,55 @@
 
 #include "arena.h"
 #include "ast.h"
+#include "coverage.h"
+#include "emit_stats.h"
 #include "symbol_table.h"
 #include <stdio.h>
 
+typedef enum
+{
+    PROFILE_DEBUG,     // Runtime checks everywhere (default)
+    PROFILE_RELEASE,   // Runtime checks unless a function is marked @unchecked
+    PROFILE_UNCHECKED  // No runtime checks unless a function is marked @checked
+} BuildProfile;
+
+typedef enum
+{
+    TRACE_OFF,
+    TRACE_FUNCTIONS, // --trace: a span per function call
+    TRACE_LOOPS      // --trace=loops: also a span around each while/for loop
+} TraceMode;
+
 typedef struct {
     Arena *arena;
     int label_count;
     SymbolTable *symbol_table;
     FILE *output;
+    const char *output_file;
     char *current_function;
     Type *current_return_type;
     int temp_count;  // Add this line
+    BuildProfile profile;
+    bool checks_enabled;  // Whether the current function emits checked runtime arithmetic
+    bool fast_math;       // Whether the current function inlines double arithmetic (@fastmath)
+    bool has_benches;     // Module defines bench blocks, so main dispatches to the harness
+    int bench_count;      // Bench functions emitted so far
+    EmitStats *stats;     // Generated-code metrics for --emit-stats, NULL when off
+    bool instrument;      // Functions call rt_prof_enter/rt_prof_exit (--instrument)
+    TraceMode trace;      // Spans recorded by rt_trace_begin/rt_trace_end (--trace)
+    bool line_directives; // Emit #line so debuggers and profilers report SN source lines
+    Token *line_token;    // SN statement the C being emitted belongs to, for #line
+    const char *line_filename;   // Last filename given a #line, and its escaped form
+    char *line_filename_c;
+    char **functions;     // C names of emitted top-level functions, for the sampling profiler's address table
+    int function_count;
+    int function_capacity;
+    bool coverage;        // Count function entries and condition outcomes (--coverage)
+    CoverageProfile *use_profile; // Counts from a --coverage run (--use-profile), NULL when off
+    int coverage_ordinal; // Next site number in the current function
+    char **coverage_sites; // "<function> <ordinal> <kind> <line>" for each counter pair
+    int coverage_site_count;
+    int coverage_site_capacity;
 } CodeGen;
 
 void code_gen_init(Arena *arena, CodeGen *gen, SymbolTable *symbol_table, const char *output_file);
@@ -27,5 +65,7 @@ void code_gen_return_statement(CodeGen *gen, ReturnStmt *stmt);
 void code_gen_if_statement(CodeGen *gen, IfStmt *stmt);
 void code_gen_while_statement(CodeGen *gen, WhileStmt *stmt);
 void code_gen_for_statement(CodeGen *gen, ForStmt *stmt);
+void code_gen_match_statement(CodeGen *gen, MatchStmt *stmt);
+void code_gen_bench(CodeGen *gen, BenchStmt *stmt);
 
 #endif
\ No newline at end of file
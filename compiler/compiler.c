@@ -1,6 +1,7 @@
 #include "compiler.h"
 #include "debug.h"
 #include "type_checker.h"
+#include "timing.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -18,6 +19,15 @@ void compiler_init(CompilerOptions *options, int argc, char **argv)
     options->source = NULL;
     options->verbose = 0;
     options->log_level = DEBUG_LEVEL_ERROR;
+    options->profile = PROFILE_DEBUG;
+    options->time_passes = TIMING_OFF;
+    options->perf_counters = 0;
+    options->emit_stats = EMIT_STATS_OFF;
+    options->instrument = 0;
+    options->trace = TRACE_OFF;
+    options->line_directives = 1;
+    options->coverage = 0;
+    options->use_profile = NULL;
 
     if (!compiler_parse_args(argc, argv, options))
     {
@@ -26,6 +36,16 @@ void compiler_init(CompilerOptions *options, int argc, char **argv)
     }
 
     symbol_table_init(&options->arena, &options->symbol_table);
+    // --perf-counters extends the --time-passes report, and turns it on if needed
+    if (options->perf_counters && options->time_passes == TIMING_OFF)
+    {
+        options->time_passes = TIMING_TEXT;
+    }
+    timing_init(options->time_passes);
+    if (options->perf_counters)
+    {
+        timing_enable_perf();
+    }
 }
 
 void compiler_cleanup(CompilerOptions *options)
@@ -35,6 +55,7 @@ void compiler_cleanup(CompilerOptions *options)
         return;
     }
 
+    timing_cleanup();
     symbol_table_cleanup(&options->symbol_table);
     arena_free(&options->arena);
 
@@ -48,10 +69,20 @@ int compiler_parse_args(int argc, char **argv, CompilerOptions *options)
     if (argc < 2)
     {
         DEBUG_ERROR(
-            "Usage: %s <source_file> [-o <output_file>] [-v] [-l <level>]\n"
+            "Usage: %s <source_file> [-o <output_file>] [-v] [-l <level>] [--profile=<profile>] [--log-categories=<list>] [--time-passes[=json]] [--perf-counters] [--emit-stats[=json]] [--instrument] [--trace[=loops]] [--no-line-directives] [--coverage] [--use-profile=<file>]\n"
             "  -o <output_file>   Specify output file (default is source_file.s)\n"
             "  -v                 Verbose mode\n"
-            "  -l <level>         Set log level (0=none, 1=error, 2=warning, 3=info, 4=verbose)",
+            "  -l <level>         Set log level (0=none, 1=error, 2=warning, 3=info, 4=verbose)\n"
+            "  --profile=<name>   Runtime checks: debug (default), release (honours @unchecked), unchecked (honours @checked)\n"
+            "  --log-categories=  Limit info/verbose logging to lexer, parser, symtab, codegen and/or general (comma-separated)\n"
+            "  --time-passes      Report per-phase time, throughput and arena bytes on stderr (=json for JSON)\n"
+            "  --perf-counters    Add cycles, instructions, IPC and cache/branch misses per phase to the report\n"
+            "  --emit-stats       Report runtime calls, allocations, statement-expressions, temps and overflow checks per generated function on stderr (=json for JSON)\n"
+            "  --instrument       Count calls and self/total time per function in the generated program; written at exit to sn-prof.*.txt (SN_PROF_OUT sets the prefix)\n"
+            "  --trace            Record function spans in the generated program as Chrome trace JSON (=loops adds while/for spans; see SN_TRACE_* in README)\n"
+            "  --no-line-directives  Omit #line directives that map the generated C back to SN source lines\n"
+            "  --coverage         Count function entries and branch/loop outcomes in the generated program; written at exit to sn-coverage.profile (SN_COV_OUT)\n"
+            "  --use-profile=<file>  Use a --coverage profile for __builtin_expect on biased branches and hot/cold function attributes",
             argv[0]);
         return 0;
     }
@@ -107,6 +138,79 @@ int compiler_parse_args(int argc, char **argv, CompilerOptions *options)
             options->log_level = log_level;
             init_debug(log_level); // Update debug level if changed
         }
+        else if (strncmp(argv[i], "--profile=", 10) == 0)
+        {
+            const char *profile = argv[i] + 10;
+            if (strcmp(profile, "debug") == 0)
+            {
+                options->profile = PROFILE_DEBUG;
+            }
+            else if (strcmp(profile, "release") == 0)
+            {
+                options->profile = PROFILE_RELEASE;
+            }
+            else if (strcmp(profile, "unchecked") == 0)
+            {
+                options->profile = PROFILE_UNCHECKED;
+            }
+            else
+            {
+                DEBUG_ERROR("Invalid profile: %s (expected debug, release or unchecked)", profile);
+                return 0;
+            }
+        }
+        else if (strncmp(argv[i], "--log-categories=", 17) == 0)
+        {
+            if (!debug_parse_categories(argv[i] + 17, &debug_categories))
+            {
+                DEBUG_ERROR("Invalid log categories: %s (expected a comma-separated list of general, lexer, parser, symtab, codegen or all)", argv[i] + 17);
+                return 0;
+            }
+        }
+        else if (strcmp(argv[i], "--perf-counters") == 0)
+        {
+            options->perf_counters = 1;
+        }
+        else if (strcmp(argv[i], "--instrument") == 0)
+        {
+            options->instrument = 1;
+        }
+        else if (strcmp(argv[i], "--no-line-directives") == 0)
+        {
+            options->line_directives = 0;
+        }
+        else if (strcmp(argv[i], "--coverage") == 0)
+        {
+            options->coverage = 1;
+        }
+        else if (strncmp(argv[i], "--use-profile=", 14) == 0 && argv[i][14] != '\0')
+        {
+            options->use_profile = arena_strdup(&options->arena, argv[i] + 14);
+        }
+        else if (strcmp(argv[i], "--trace") == 0)
+        {
+            options->trace = TRACE_FUNCTIONS;
+        }
+        else if (strcmp(argv[i], "--trace=loops") == 0)
+        {
+            options->trace = TRACE_LOOPS;
+        }
+        else if (strcmp(argv[i], "--emit-stats") == 0)
+        {
+            options->emit_stats = EMIT_STATS_TEXT;
+        }
+        else if (strcmp(argv[i], "--emit-stats=json") == 0)
+        {
+            options->emit_stats = EMIT_STATS_JSON;
+        }
+        else if (strcmp(argv[i], "--time-passes") == 0)
+        {
+            options->time_passes = TIMING_TEXT;
+        }
+        else if (strcmp(argv[i], "--time-passes=json") == 0)
+        {
+            options->time_passes = TIMING_JSON;
+        }
         else
         {
             DEBUG_ERROR("Unknown option: %s", argv[i]);
@@ -123,14 +227,21 @@ Module* compiler_compile(CompilerOptions *options)
     int imported_count = 0;
     int imported_capacity = 0;
 
+    timing_begin(PHASE_IMPORTS, &options->arena);
     Module *module = parse_module_with_imports(&options->arena, &options->symbol_table, options->source_file, &imported, &imported_count, &imported_capacity);
+    timing_end(PHASE_IMPORTS, &options->arena);
     if (!module)
     {
         DEBUG_ERROR("Failed to parse module with imports");
         return NULL;
     }
 
-    if (!type_check_module(module, &options->symbol_table))
+    timing_count_nodes(PHASE_IMPORTS, module);
+    timing_begin(PHASE_TYPE_CHECK, &options->arena);
+    int type_ok = type_check_module(module, &options->symbol_table);
+    timing_end(PHASE_TYPE_CHECK, &options->arena);
+    timing_count_nodes(PHASE_TYPE_CHECK, module);
+    if (!type_ok)
     {
         DEBUG_ERROR("Type checking failed");
         return NULL;
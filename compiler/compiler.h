@@ -6,6 +6,8 @@
 #include "lexer.h"
 #include "parser.h"
 #include "code_gen.h"
+#include "emit_stats.h"
+#include "timing.h"
 #include <stdio.h>
 
 typedef struct
@@ -17,6 +19,15 @@ typedef struct
     char *source;
     int verbose;
     int log_level;
+    BuildProfile profile;
+    TimingFormat time_passes;
+    int perf_counters;
+    EmitStatsFormat emit_stats;
+    int instrument;
+    TraceMode trace;
+    int line_directives;
+    int coverage;
+    char *use_profile;
 } CompilerOptions;
 
 void compiler_init(CompilerOptions *options, int argc, char **argv);
@@ -0,0 +1,238 @@
+#include "coverage.h"
+#include "debug.h"
+#include "file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A condition needs this many evaluations before its bias is trusted.
+#define COVERAGE_MIN_EVALUATIONS 16
+// GCC assumes a __builtin_expect hint holds 90% of the time, so only conditions
+// at least that biased get one.
+#define COVERAGE_BIAS_PERCENT 90
+// The heaviest functions that together make up this share of the profile are hot.
+#define COVERAGE_HOT_PERMILLE 900
+
+static const char *kind_names[] = {"fn", "if", "while", "for"};
+
+const char *coverage_kind_name(CoverageKind kind)
+{
+    return kind_names[kind];
+}
+
+void coverage_profile_init(CoverageProfile *profile, Arena *arena)
+{
+    DEBUG_VERBOSE("Entering coverage_profile_init");
+    profile->arena = arena;
+    profile->sites = NULL;
+    profile->site_count = 0;
+    profile->site_capacity = 0;
+    profile->functions = NULL;
+    profile->function_count = 0;
+    profile->stale_sites = 0;
+}
+
+static bool parse_kind(const char *word, CoverageKind *kind)
+{
+    for (size_t i = 0; i < sizeof(kind_names) / sizeof(kind_names[0]); i++)
+    {
+        if (strcmp(word, kind_names[i]) == 0)
+        {
+            *kind = (CoverageKind)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void add_site(CoverageProfile *profile, CoverageSite *site)
+{
+    if (profile->site_count >= profile->site_capacity)
+    {
+        int new_capacity = profile->site_capacity == 0 ? 64 : profile->site_capacity * 2;
+        CoverageSite *new_sites = arena_alloc(profile->arena, sizeof(CoverageSite) * new_capacity);
+        if (profile->site_count > 0)
+        {
+            memcpy(new_sites, profile->sites, sizeof(CoverageSite) * profile->site_count);
+        }
+        profile->sites = new_sites;
+        profile->site_capacity = new_capacity;
+    }
+    profile->sites[profile->site_count++] = *site;
+}
+
+static int compare_sites(const void *a, const void *b)
+{
+    const CoverageSite *left = a;
+    const CoverageSite *right = b;
+    int by_name = strcmp(left->function, right->function);
+    if (by_name != 0)
+    {
+        return by_name;
+    }
+    return (left->ordinal > right->ordinal) - (left->ordinal < right->ordinal);
+}
+
+static int compare_weights(const void *a, const void *b)
+{
+    const CoverageFunction *left = *(CoverageFunction *const *)a;
+    const CoverageFunction *right = *(CoverageFunction *const *)b;
+    return (left->weight < right->weight) - (left->weight > right->weight);
+}
+
+// Sorts the sites, folds repeated ones together and derives the per-function
+// totals and hot set.
+static void finish_profile(CoverageProfile *profile)
+{
+    qsort(profile->sites, (size_t)profile->site_count, sizeof(CoverageSite), compare_sites);
+    int merged = 0;
+    for (int i = 0; i < profile->site_count; i++)
+    {
+        CoverageSite *site = &profile->sites[i];
+        if (merged > 0 && compare_sites(&profile->sites[merged - 1], site) == 0)
+        {
+            profile->sites[merged - 1].taken += site->taken;
+            profile->sites[merged - 1].not_taken += site->not_taken;
+            continue;
+        }
+        profile->sites[merged++] = *site;
+    }
+    profile->site_count = merged;
+
+    // Sites are grouped by function, so each run of equal names is one function.
+    profile->functions = arena_alloc(profile->arena, sizeof(CoverageFunction) * (merged > 0 ? merged : 1));
+    profile->function_count = 0;
+    long total = 0;
+    for (int i = 0; i < merged; i++)
+    {
+        CoverageSite *site = &profile->sites[i];
+        CoverageFunction *fn = profile->function_count > 0 ? &profile->functions[profile->function_count - 1] : NULL;
+        if (fn == NULL || strcmp(fn->name, site->function) != 0)
+        {
+            fn = &profile->functions[profile->function_count++];
+            fn->name = site->function;
+            fn->entries = 0;
+            fn->weight = 0;
+            fn->hot = false;
+        }
+        if (site->kind == COVERAGE_FUNCTION)
+        {
+            fn->entries += site->taken;
+        }
+        fn->weight += site->taken + site->not_taken;
+        total += site->taken + site->not_taken;
+    }
+
+    CoverageFunction **by_weight = arena_alloc(profile->arena, sizeof(CoverageFunction *) * (merged > 0 ? merged : 1));
+    for (int i = 0; i < profile->function_count; i++)
+    {
+        by_weight[i] = &profile->functions[i];
+    }
+    qsort(by_weight, (size_t)profile->function_count, sizeof(CoverageFunction *), compare_weights);
+    long covered = 0;
+    for (int i = 0; i < profile->function_count && by_weight[i]->weight > 0; i++)
+    {
+        if (covered * 1000 >= total * COVERAGE_HOT_PERMILLE)
+        {
+            break;
+        }
+        by_weight[i]->hot = true;
+        covered += by_weight[i]->weight;
+    }
+}
+
+bool coverage_profile_load(CoverageProfile *profile, const char *path)
+{
+    DEBUG_VERBOSE("Entering coverage_profile_load");
+    char *text = file_read(profile->arena, path);
+    if (text == NULL)
+    {
+        return false;
+    }
+    int line_number = 0;
+    char *line = text;
+    while (*line != '\0')
+    {
+        char *end = strchr(line, '\n');
+        if (end != NULL)
+        {
+            *end = '\0';
+        }
+        line_number++;
+        if (line[0] != '#' && line[0] != '\0')
+        {
+            CoverageSite site;
+            char kind[16];
+            int name_length = 0;
+            if (sscanf(line, "%*s%n %d %15s %d %ld %ld", &name_length, &site.ordinal, kind, &site.line, &site.taken,
+                       &site.not_taken) != 5 ||
+                !parse_kind(kind, &site.kind))
+            {
+                DEBUG_ERROR("%s:%d: malformed coverage profile line", path, line_number);
+                return false;
+            }
+            site.function = arena_strndup(profile->arena, line, (size_t)name_length);
+            add_site(profile, &site);
+        }
+        if (end == NULL)
+        {
+            break;
+        }
+        line = end + 1;
+    }
+    finish_profile(profile);
+    return true;
+}
+
+CoverageSite *coverage_profile_site(CoverageProfile *profile, const char *function, int ordinal,
+                                    CoverageKind kind, int line)
+{
+    CoverageSite key;
+    key.function = function;
+    key.ordinal = ordinal;
+    CoverageSite *site = bsearch(&key, profile->sites, (size_t)profile->site_count, sizeof(CoverageSite),
+                                 compare_sites);
+    if (site == NULL)
+    {
+        return NULL;
+    }
+    if (site->kind != kind || site->line != line)
+    {
+        profile->stale_sites++;
+        return NULL;
+    }
+    return site;
+}
+
+static int compare_function_name(const void *key, const void *element)
+{
+    return strcmp((const char *)key, ((const CoverageFunction *)element)->name);
+}
+
+CoverageFunction *coverage_profile_function(CoverageProfile *profile, const char *function)
+{
+    return bsearch(function, profile->functions, (size_t)profile->function_count, sizeof(CoverageFunction),
+                   compare_function_name);
+}
+
+int coverage_site_expectation(CoverageSite *site)
+{
+    if (site == NULL || site->kind == COVERAGE_FUNCTION)
+    {
+        return -1;
+    }
+    long total = site->taken + site->not_taken;
+    if (total < COVERAGE_MIN_EVALUATIONS)
+    {
+        return -1;
+    }
+    if (site->taken * 100 >= total * COVERAGE_BIAS_PERCENT)
+    {
+        return 1;
+    }
+    if (site->not_taken * 100 >= total * COVERAGE_BIAS_PERCENT)
+    {
+        return 0;
+    }
+    return -1;
+}
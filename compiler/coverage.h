@@ -0,0 +1,61 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include "arena.h"
+#include <stdbool.h>
+
+typedef enum
+{
+    COVERAGE_FUNCTION, // Function entry
+    COVERAGE_IF,       // if condition
+    COVERAGE_WHILE,    // while condition
+    COVERAGE_FOR       // for condition
+} CoverageKind;
+
+/* One profiled node. Sites are numbered in emission order within their
+ * function, so a recompile of the same source numbers them the same way; the
+ * kind and line guard against a profile taken from an older version. */
+typedef struct
+{
+    const char *function; // C name of the enclosing function
+    int ordinal;          // Position among the function's sites
+    CoverageKind kind;
+    int line;
+    long taken;           // Entries, or evaluations where the condition was true
+    long not_taken;       // Evaluations where the condition was false
+} CoverageSite;
+
+typedef struct
+{
+    const char *name;
+    long entries;
+    long weight;          // Entries plus every condition evaluated in the function
+    bool hot;             // Among the heaviest functions, which cover most of the profile
+} CoverageFunction;
+
+typedef struct
+{
+    Arena *arena;
+    CoverageSite *sites;  // Sorted by function, then ordinal
+    int site_count;
+    int site_capacity;
+    CoverageFunction *functions; // Sorted by name
+    int function_count;
+    int stale_sites;      // Lookups whose kind or line no longer matched the source
+} CoverageProfile;
+
+const char *coverage_kind_name(CoverageKind kind);
+void coverage_profile_init(CoverageProfile *profile, Arena *arena);
+/* Reads a file written by a --coverage build. Repeated sites, as in several
+ * profiles concatenated together, are summed. Returns false on a read or
+ * format error. */
+bool coverage_profile_load(CoverageProfile *profile, const char *path);
+/* The counts for a site, or NULL when the profile has none that match. */
+CoverageSite *coverage_profile_site(CoverageProfile *profile, const char *function, int ordinal,
+                                    CoverageKind kind, int line);
+CoverageFunction *coverage_profile_function(CoverageProfile *profile, const char *function);
+/* 1 or 0 when a condition went that way in at least 90% of enough evaluations
+ * to trust, otherwise -1. */
+int coverage_site_expectation(CoverageSite *site);
+
+#endif
@@ -1,8 +1,57 @@
 #include "debug.h"
+#include <string.h>
 
 int debug_level = DEBUG_LEVEL_ERROR;
+unsigned debug_categories = DEBUG_CAT_ALL;
+
+static const struct
+{
+    const char *name;
+    unsigned mask;
+} debug_category_names[] = {
+    {"general", DEBUG_CAT_GENERAL},
+    {"lexer", DEBUG_CAT_LEXER},
+    {"parser", DEBUG_CAT_PARSER},
+    {"symtab", DEBUG_CAT_SYMTAB},
+    {"codegen", DEBUG_CAT_CODEGEN},
+    {"all", DEBUG_CAT_ALL},
+};
 
 void init_debug(int level)
 {
     debug_level = level;
-}
\ No newline at end of file
+}
+
+// Parses a comma-separated list such as "lexer,parser" into a category mask.
+// Returns 0 and leaves *categories untouched if a name is not recognised.
+int debug_parse_categories(const char *list, unsigned *categories)
+{
+    unsigned mask = 0;
+    const char *p = list;
+    while (*p != '\0')
+    {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        int found = 0;
+        for (size_t i = 0; i < sizeof(debug_category_names) / sizeof(debug_category_names[0]); i++)
+        {
+            if (strlen(debug_category_names[i].name) == len && strncmp(debug_category_names[i].name, p, len) == 0)
+            {
+                mask |= debug_category_names[i].mask;
+                found = 1;
+                break;
+            }
+        }
+        if (!found)
+        {
+            return 0;
+        }
+        p += len;
+        if (*p == ',')
+        {
+            p++;
+        }
+    }
+    *categories = mask;
+    return 1;
+}
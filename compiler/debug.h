@@ -10,36 +10,66 @@
 #define DEBUG_LEVEL_INFO 3
 #define DEBUG_LEVEL_VERBOSE 4
 
+/* Messages above DEBUG_MAX_LEVEL are removed at compile time: the level check
+ * below folds to a constant 0 and the call, with its arguments, is dropped.
+ * Build with -DDEBUG_MAX_LEVEL=DEBUG_LEVEL_ERROR to strip all tracing. */
+#ifndef DEBUG_MAX_LEVEL
+#define DEBUG_MAX_LEVEL DEBUG_LEVEL_VERBOSE
+#endif
+
+/* Subsystems that can be traced separately (`--log-categories=`). Errors and
+ * warnings are always shown; categories only filter info and verbose output. */
+#define DEBUG_CAT_GENERAL (1u << 0)
+#define DEBUG_CAT_LEXER (1u << 1)
+#define DEBUG_CAT_PARSER (1u << 2)
+#define DEBUG_CAT_SYMTAB (1u << 3)
+#define DEBUG_CAT_CODEGEN (1u << 4)
+#define DEBUG_CAT_ALL (DEBUG_CAT_GENERAL | DEBUG_CAT_LEXER | DEBUG_CAT_PARSER | DEBUG_CAT_SYMTAB | DEBUG_CAT_CODEGEN)
+
+/* A source file picks its category by defining DEBUG_CATEGORY before any
+ * include. */
+#ifndef DEBUG_CATEGORY
+#define DEBUG_CATEGORY DEBUG_CAT_GENERAL
+#endif
+
 extern int debug_level;
+extern unsigned debug_categories;
 
 void init_debug(int level);
+int debug_parse_categories(const char *list, unsigned *categories);
+
+/* True when a message at `level` from this file would be printed. Use it to
+ * guard work done only to build a log message. */
+#define DEBUG_ENABLED(level)                                      \
+    ((level) <= DEBUG_MAX_LEVEL && debug_level >= (level) &&      \
+     ((level) <= DEBUG_LEVEL_WARNING || (debug_categories & DEBUG_CATEGORY)))
 
 #define DEBUG_ERROR(fmt, ...)                                                           \
-    if (debug_level >= DEBUG_LEVEL_ERROR)                                               \
+    if (DEBUG_ENABLED(DEBUG_LEVEL_ERROR))                                               \
     {                                                                                   \
         fprintf(stderr, "[ERROR] %s:%d: " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
     }
 
 #define DEBUG_WARNING(fmt, ...)                                                           \
-    if (debug_level >= DEBUG_LEVEL_WARNING)                                               \
+    if (DEBUG_ENABLED(DEBUG_LEVEL_WARNING))                                               \
     {                                                                                     \
         fprintf(stderr, "[WARNING] %s:%d: " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
     }
 
 #define DEBUG_INFO(fmt, ...)                                                           \
-    if (debug_level >= DEBUG_LEVEL_INFO)                                               \
+    if (DEBUG_ENABLED(DEBUG_LEVEL_INFO))                                               \
     {                                                                                  \
         fprintf(stderr, "[INFO] %s:%d: " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
     }
 
 #define DEBUG_VERBOSE(fmt, ...)                                                           \
-    if (debug_level >= DEBUG_LEVEL_VERBOSE)                                               \
+    if (DEBUG_ENABLED(DEBUG_LEVEL_VERBOSE))                                               \
     {                                                                                     \
         fprintf(stderr, "[VERBOSE] %s:%d: " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
     }
 
 #define DEBUG_VERBOSE_INDENT(level, fmt, ...)                     \
-    if (debug_level >= DEBUG_LEVEL_VERBOSE)                       \
+    if (DEBUG_ENABLED(DEBUG_LEVEL_VERBOSE))                       \
     {                                                             \
         fprintf(stderr, "[VERBOSE] %s:%d: ", __FILE__, __LINE__); \
         if (fmt == NULL)                                          \
@@ -0,0 +1,297 @@
+#include "emit_stats.h"
+#include "debug.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Runtime helpers (and libc calls) whose result is freshly heap-allocated. Map
+// lookups only copy string values, so they are left out rather than overcounted.
+static const char *heap_prefixes[] = {
+    "rt_str_concat", "rt_to_string_", "rt_format_", "rt_memo_create", "rt_map_create",
+    "malloc", "calloc", "realloc", "strdup"
+};
+
+// Checked arithmetic: each call traps on overflow (or division by zero).
+static const char *overflow_prefixes[] = {
+    "rt_add_", "rt_sub_", "rt_mul_", "rt_div_", "rt_mod_", "rt_neg_", "rt_post_inc_", "rt_post_dec_"
+};
+
+// An identifier after one of these is an operand, not a declared name.
+static const char *non_type_keywords[] = {
+    "return", "goto", "else", "case", "sizeof"
+};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+void emit_stats_init(EmitStats *stats, Arena *arena, EmitStatsFormat format)
+{
+    DEBUG_VERBOSE("Entering emit_stats_init");
+    stats->arena = arena;
+    stats->format = format;
+    stats->functions = NULL;
+    stats->function_count = 0;
+    stats->function_capacity = 0;
+}
+
+static bool word_is(const char *word, size_t length, const char *s)
+{
+    return strlen(s) == length && strncmp(word, s, length) == 0;
+}
+
+static bool word_has_prefix(const char *word, size_t length, const char **prefixes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t prefix_length = strlen(prefixes[i]);
+        if (length >= prefix_length && strncmp(word, prefixes[i], prefix_length) == 0)
+            return true;
+    }
+    return false;
+}
+
+static void record_call(Arena *arena, FunctionEmitStats *fn, const char *name, size_t length, long count)
+{
+    for (int i = 0; i < fn->call_count; i++)
+    {
+        if (word_is(name, length, fn->calls[i].name))
+        {
+            fn->calls[i].count += count;
+            return;
+        }
+    }
+    if (fn->call_count >= fn->call_capacity)
+    {
+        int new_capacity = fn->call_capacity == 0 ? 8 : fn->call_capacity * 2;
+        RuntimeCallCount *new_calls = arena_alloc(arena, sizeof(RuntimeCallCount) * new_capacity);
+        if (fn->call_count > 0)
+        {
+            memcpy(new_calls, fn->calls, sizeof(RuntimeCallCount) * fn->call_count);
+        }
+        fn->calls = new_calls;
+        fn->call_capacity = new_capacity;
+    }
+    fn->calls[fn->call_count].name = arena_strndup(arena, name, length);
+    fn->calls[fn->call_count].count = count;
+    fn->call_count++;
+}
+
+static FunctionEmitStats *emit_stats_add_function(EmitStats *stats, const char *name)
+{
+    if (stats->function_count >= stats->function_capacity)
+    {
+        int new_capacity = stats->function_capacity == 0 ? 16 : stats->function_capacity * 2;
+        FunctionEmitStats *new_functions = arena_alloc(stats->arena, sizeof(FunctionEmitStats) * new_capacity);
+        if (stats->function_count > 0)
+        {
+            memcpy(new_functions, stats->functions, sizeof(FunctionEmitStats) * stats->function_count);
+        }
+        stats->functions = new_functions;
+        stats->function_capacity = new_capacity;
+    }
+    FunctionEmitStats *fn = &stats->functions[stats->function_count++];
+    memset(fn, 0, sizeof(FunctionEmitStats));
+    fn->name = arena_strdup(stats->arena, name);
+    return fn;
+}
+
+static const char *skip_space(const char *p, const char *end)
+{
+    while (p < end && isspace((unsigned char)*p))
+        p++;
+    return p;
+}
+
+// A light C tokenizer over generated code: literals and comments are skipped,
+// identifiers followed by '(' are calls, and an _-prefixed identifier right
+// after a type name or '*' is a temp being declared. Statement-expressions are
+// tracked on a stack of open braces so their nesting depth is exact.
+void emit_stats_scan_function(EmitStats *stats, const char *name, const char *code, size_t length)
+{
+    DEBUG_VERBOSE("Entering emit_stats_scan_function");
+    FunctionEmitStats *fn = emit_stats_add_function(stats, name);
+    const char *p = code;
+    const char *end = code + length;
+    bool *brace_is_expr = NULL; // Per open brace: does it belong to a ({ ... })?
+    int brace_depth = 0;
+    int brace_capacity = 0;
+    int expr_depth = 0;
+    bool after_type = false;
+
+    while (p < end)
+    {
+        char c = *p;
+        if (isspace((unsigned char)c))
+        {
+            p++;
+            continue;
+        }
+        if (c == '"' || c == '\'')
+        {
+            for (p++; p < end && *p != c; p++)
+            {
+                if (*p == '\\' && p + 1 < end)
+                    p++;
+            }
+            p++;
+            after_type = false;
+            continue;
+        }
+        if (c == '/' && p + 1 < end && (p[1] == '/' || p[1] == '*'))
+        {
+            const char *close = p[1] == '/' ? "\n" : "*/";
+            const char *found = strstr(p + 2, close);
+            p = (found == NULL || found >= end) ? end : found + strlen(close);
+            continue;
+        }
+        if (isalpha((unsigned char)c) || c == '_')
+        {
+            const char *word = p;
+            while (p < end && (isalnum((unsigned char)*p) || *p == '_'))
+                p++;
+            size_t word_length = (size_t)(p - word);
+            const char *next = skip_space(p, end);
+            if (next < end && *next == '(')
+            {
+                if (word_length > 3 && strncmp(word, "rt_", 3) == 0)
+                {
+                    fn->runtime_calls++;
+                    record_call(stats->arena, fn, word, word_length, 1);
+                    if (word_has_prefix(word, word_length, overflow_prefixes, COUNT_OF(overflow_prefixes)))
+                        fn->overflow_checks++;
+                }
+                if (word_has_prefix(word, word_length, heap_prefixes, COUNT_OF(heap_prefixes)))
+                    fn->heap_allocations++;
+            }
+            else if (after_type && word_length > 1 && word[0] == '_' && word[1] != '_' &&
+                     !word_is(word, word_length, "_return_value"))
+            {
+                fn->temps++;
+            }
+            after_type = !word_has_prefix(word, word_length, non_type_keywords, COUNT_OF(non_type_keywords));
+            continue;
+        }
+
+        bool opens_expr = false;
+        if (c == '(')
+        {
+            const char *next = skip_space(p + 1, end);
+            if (next < end && *next == '{')
+            {
+                opens_expr = true;
+                p = next;
+                c = '{';
+            }
+        }
+        if (c == '{')
+        {
+            if (brace_depth >= brace_capacity)
+            {
+                int new_capacity = brace_capacity == 0 ? 64 : brace_capacity * 2;
+                bool *new_braces = arena_alloc(stats->arena, sizeof(bool) * new_capacity);
+                if (brace_depth > 0)
+                {
+                    memcpy(new_braces, brace_is_expr, sizeof(bool) * brace_depth);
+                }
+                brace_is_expr = new_braces;
+                brace_capacity = new_capacity;
+            }
+            brace_is_expr[brace_depth++] = opens_expr;
+            if (opens_expr)
+            {
+                fn->stmt_exprs++;
+                if (++expr_depth > 1)
+                    fn->nested_stmt_exprs++;
+                if (expr_depth > fn->max_stmt_expr_depth)
+                    fn->max_stmt_expr_depth = expr_depth;
+            }
+        }
+        else if (c == '}' && brace_depth > 0)
+        {
+            if (brace_is_expr[--brace_depth])
+                expr_depth--;
+        }
+        after_type = c == '*' && after_type;
+        p++;
+    }
+}
+
+void emit_stats_total(EmitStats *stats, FunctionEmitStats *total)
+{
+    DEBUG_VERBOSE("Entering emit_stats_total");
+    memset(total, 0, sizeof(FunctionEmitStats));
+    total->name = "total";
+    for (int i = 0; i < stats->function_count; i++)
+    {
+        FunctionEmitStats *fn = &stats->functions[i];
+        for (int j = 0; j < fn->call_count; j++)
+        {
+            record_call(stats->arena, total, fn->calls[j].name, strlen(fn->calls[j].name), fn->calls[j].count);
+        }
+        total->runtime_calls += fn->runtime_calls;
+        total->heap_allocations += fn->heap_allocations;
+        total->stmt_exprs += fn->stmt_exprs;
+        total->nested_stmt_exprs += fn->nested_stmt_exprs;
+        if (fn->max_stmt_expr_depth > total->max_stmt_expr_depth)
+            total->max_stmt_expr_depth = fn->max_stmt_expr_depth;
+        total->temps += fn->temps;
+        total->overflow_checks += fn->overflow_checks;
+    }
+}
+
+static void emit_stats_text_row(FILE *out, FunctionEmitStats *fn)
+{
+    fprintf(out, "%-24s %9ld %11ld %10ld %7ld %9d %7ld %9ld\n", fn->name, fn->runtime_calls, fn->heap_allocations,
+            fn->stmt_exprs, fn->nested_stmt_exprs, fn->max_stmt_expr_depth, fn->temps, fn->overflow_checks);
+    if (fn->call_count > 0)
+    {
+        fprintf(out, "    ");
+        for (int i = 0; i < fn->call_count; i++)
+        {
+            fprintf(out, "%s%s %ld", i > 0 ? ", " : "", fn->calls[i].name, fn->calls[i].count);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static void emit_stats_json_function(FILE *out, FunctionEmitStats *fn)
+{
+    fprintf(out, "{\"name\": \"%s\", \"runtime_calls\": %ld, \"heap_allocations\": %ld, \"stmt_exprs\": %ld, "
+                 "\"nested_stmt_exprs\": %ld, \"max_stmt_expr_depth\": %d, \"temps\": %ld, \"overflow_checks\": %ld, "
+                 "\"calls\": {",
+            fn->name, fn->runtime_calls, fn->heap_allocations, fn->stmt_exprs, fn->nested_stmt_exprs,
+            fn->max_stmt_expr_depth, fn->temps, fn->overflow_checks);
+    for (int i = 0; i < fn->call_count; i++)
+    {
+        fprintf(out, "%s\"%s\": %ld", i > 0 ? ", " : "", fn->calls[i].name, fn->calls[i].count);
+    }
+    fprintf(out, "}}");
+}
+
+void emit_stats_report(EmitStats *stats, FILE *out)
+{
+    DEBUG_VERBOSE("Entering emit_stats_report");
+    if (stats->format == EMIT_STATS_OFF)
+        return;
+    FunctionEmitStats total;
+    emit_stats_total(stats, &total);
+    if (stats->format == EMIT_STATS_JSON)
+    {
+        fprintf(out, "{\"functions\": [");
+        for (int i = 0; i < stats->function_count; i++)
+        {
+            fprintf(out, "%s", i > 0 ? ", " : "");
+            emit_stats_json_function(out, &stats->functions[i]);
+        }
+        fprintf(out, "], \"total\": ");
+        emit_stats_json_function(out, &total);
+        fprintf(out, "}\n");
+        return;
+    }
+    fprintf(out, "%-24s %9s %11s %10s %7s %9s %7s %9s\n", "function", "rt calls", "heap allocs", "stmt-exprs",
+            "nested", "max depth", "temps", "overflow");
+    for (int i = 0; i < stats->function_count; i++)
+    {
+        emit_stats_text_row(out, &stats->functions[i]);
+    }
+    emit_stats_text_row(out, &total);
+}
@@ -0,0 +1,52 @@
+#ifndef EMIT_STATS_H
+#define EMIT_STATS_H
+
+#include "arena.h"
+#include <stddef.h>
+#include <stdio.h>
+
+typedef enum
+{
+    EMIT_STATS_OFF,
+    EMIT_STATS_TEXT,
+    EMIT_STATS_JSON
+} EmitStatsFormat;
+
+typedef struct
+{
+    const char *name; // rt_* function
+    long count;
+} RuntimeCallCount;
+
+typedef struct
+{
+    const char *name;          // C name of the emitted function
+    RuntimeCallCount *calls;   // Calls by rt_* function, in first-seen order
+    int call_count;
+    int call_capacity;
+    long runtime_calls;        // All rt_* calls
+    long heap_allocations;     // Calls that return fresh heap memory (concat, to_string, format, ...)
+    long stmt_exprs;           // GNU ({ ... }) statement-expressions
+    long nested_stmt_exprs;    // Statement-expressions opened inside another one
+    int max_stmt_expr_depth;
+    long temps;                // Compiler-introduced _-prefixed locals
+    long overflow_checks;      // Checked arithmetic (rt_add_long, rt_mul_double, ...)
+} FunctionEmitStats;
+
+typedef struct
+{
+    Arena *arena;
+    EmitStatsFormat format;
+    FunctionEmitStats *functions;
+    int function_count;
+    int function_capacity;
+} EmitStats;
+
+void emit_stats_init(EmitStats *stats, Arena *arena, EmitStatsFormat format);
+/* Scans the C emitted for one function and records its counts under `name`. */
+void emit_stats_scan_function(EmitStats *stats, const char *name, const char *code, size_t length);
+/* Sums every function into `total`; its call list is allocated from the stats arena. */
+void emit_stats_total(EmitStats *stats, FunctionEmitStats *total);
+void emit_stats_report(EmitStats *stats, FILE *out);
+
+#endif
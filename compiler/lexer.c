@@ -1,3 +1,4 @@
+#define DEBUG_CATEGORY DEBUG_CAT_LEXER
 #include "lexer.h"
 #include "debug.h"
 #include <stdio.h>
@@ -159,6 +160,8 @@ TokenType lexer_identifier_type(Lexer *lexer)
             {
             case 'o':
                 return lexer_check_keyword(lexer, 2, 2, "ol", TOKEN_BOOL);
+            case 'e':
+                return lexer_check_keyword(lexer, 2, 3, "nch", TOKEN_BENCH);
             }
         }
         break;
@@ -169,6 +172,8 @@ TokenType lexer_identifier_type(Lexer *lexer)
             {
             case 'h':
                 return lexer_check_keyword(lexer, 2, 2, "ar", TOKEN_CHAR);
+            case 'o':
+                return lexer_check_keyword(lexer, 2, 3, "nst", TOKEN_CONST);
             }
         }
         break;
@@ -214,6 +219,18 @@ TokenType lexer_identifier_type(Lexer *lexer)
         break;
     case 'l':
         return lexer_check_keyword(lexer, 1, 3, "ong", TOKEN_LONG);
+    case 'm':
+        if (lexer->current - lexer->start > 2 && lexer->start[1] == 'a')
+        {
+            switch (lexer->start[2])
+            {
+            case 'p':
+                return lexer_check_keyword(lexer, 3, 0, "", TOKEN_MAP);
+            case 't':
+                return lexer_check_keyword(lexer, 3, 2, "ch", TOKEN_MATCH);
+            }
+        }
+        break;
     case 'n':
         return lexer_check_keyword(lexer, 1, 2, "il", TOKEN_NIL);
     case 'o':
@@ -227,7 +244,17 @@ TokenType lexer_identifier_type(Lexer *lexer)
         }
         break;
     case 'r':
-        return lexer_check_keyword(lexer, 1, 5, "eturn", TOKEN_RETURN);
+        if (lexer->current - lexer->start > 2 && lexer->start[1] == 'e')
+        {
+            switch (lexer->start[2])
+            {
+            case 'f':
+                return lexer_check_keyword(lexer, 3, 0, "", TOKEN_REF);
+            case 't':
+                return lexer_check_keyword(lexer, 3, 3, "urn", TOKEN_RETURN);
+            }
+        }
+        break;
     case 's':
         return lexer_check_keyword(lexer, 1, 2, "tr", TOKEN_STR);
     case 't':
@@ -508,6 +535,7 @@ Token lexer_scan_token(Lexer *lexer)
                 }
             }
 
+            const char *line_start = lexer->current;
             int current_indent = 0;
             while (lexer_peek(lexer) == ' ' || lexer_peek(lexer) == '\t') {
                 current_indent++;
@@ -549,12 +577,14 @@ Token lexer_scan_token(Lexer *lexer)
                     }
                     if (lexer->indent_size >= lexer->indent_capacity) {
                         lexer->indent_capacity *= 2;
-                        lexer->indent_stack = arena_alloc(lexer->arena,
-                                                          lexer->indent_capacity * sizeof(int));
-                        if (lexer->indent_stack == NULL) {
+                        int *new_stack = arena_alloc(lexer->arena,
+                                                     lexer->indent_capacity * sizeof(int));
+                        if (new_stack == NULL) {
                             DEBUG_ERROR("Out of memory");
                             exit(1);
                         }
+                        memcpy(new_stack, lexer->indent_stack, lexer->indent_size * sizeof(int));
+                        lexer->indent_stack = new_stack;
                         DEBUG_VERBOSE("Line %d: Resized indent_stack, new capacity = %d",
                                       lexer->line, lexer->indent_capacity);
                     }
@@ -581,7 +611,10 @@ Token lexer_scan_token(Lexer *lexer)
                     } else {
                         DEBUG_VERBOSE("Line %d: Emitting DEDENT, more dedents pending",
                                       lexer->line);
-                        return lexer_make_token(lexer, TOKEN_DEDENT);
+                        // Rewind so the next call measures this line's indentation again.
+                        Token token = lexer_make_token(lexer, TOKEN_DEDENT);
+                        lexer->current = line_start;
+                        return token;
                     }
                 } else {
                     lexer->at_line_start = 0;
@@ -656,6 +689,7 @@ Token lexer_scan_token(Lexer *lexer)
     case ',': return lexer_make_token(lexer, TOKEN_COMMA);
     case '.': return lexer_make_token(lexer, TOKEN_DOT);
     case ';': return lexer_make_token(lexer, TOKEN_SEMICOLON);
+    case '@': return lexer_make_token(lexer, TOKEN_AT);
     case '"': return lexer_scan_string(lexer);
     case '\'': return lexer_scan_char(lexer);
     case '$':
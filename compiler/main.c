@@ -15,14 +15,44 @@ int main(int argc, char **argv)
     module = compiler_compile(&options);
 
     if (module == NULL) {
+        timing_report(stderr);
+        compiler_cleanup(&options);
+        return 1;
+    }
+
+    CoverageProfile coverage_profile;
+    coverage_profile_init(&coverage_profile, &options.arena);
+    if (options.use_profile != NULL && !coverage_profile_load(&coverage_profile, options.use_profile)) {
         compiler_cleanup(&options);
         return 1;
     }
 
     CodeGen gen;
     code_gen_init(&options.arena, &gen, &options.symbol_table, options.output_file);
+    gen.profile = options.profile;
+    gen.instrument = options.instrument;
+    gen.trace = options.trace;
+    gen.line_directives = options.line_directives;
+    gen.coverage = options.coverage;
+    if (options.use_profile != NULL) {
+        gen.use_profile = &coverage_profile;
+    }
+    EmitStats stats;
+    emit_stats_init(&stats, &options.arena, options.emit_stats);
+    if (options.emit_stats != EMIT_STATS_OFF) {
+        gen.stats = &stats;
+    }
+    timing_begin(PHASE_CODE_GEN, &options.arena);
     code_gen_module(&gen, module);
     code_gen_cleanup(&gen);
+    timing_end(PHASE_CODE_GEN, &options.arena);
+    timing_count_nodes(PHASE_CODE_GEN, module);
+    if (coverage_profile.stale_sites > 0) {
+        DEBUG_WARNING("%d sites in %s do not match the source and were ignored", coverage_profile.stale_sites,
+                      options.use_profile);
+    }
+    emit_stats_report(&stats, stderr);
+    timing_report(stderr);
 
     compiler_cleanup(&options);
 
@@ -1,10 +1,13 @@
 // parser.c
+#define DEBUG_CATEGORY DEBUG_CAT_PARSER
 #include "parser.h"
 #include "debug.h"
 #include "file.h"
+#include "timing.h"
 #include "string.h"
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 
 int parser_is_at_end(Parser *parser)
 {
@@ -285,7 +288,9 @@ void parser_advance(Parser *parser)
 
     for (;;)
     {
+        timing_lex_begin(parser->arena);
         parser->current = lexer_scan_token(parser->lexer);
+        timing_lex_end(parser->arena);
         DEBUG_VERBOSE("Scanned token: type=%d", parser->current.type);
         if (parser->current.type != TOKEN_ERROR)
             break;
@@ -350,6 +355,10 @@ static void synchronize(Parser *parser)
         case TOKEN_RETURN:
         case TOKEN_IMPORT:
         case TOKEN_ELSE:
+        case TOKEN_AT:
+        case TOKEN_MATCH:
+        case TOKEN_CONST:
+        case TOKEN_BENCH:
             DEBUG_VERBOSE("Found synchronization token: type=%d", parser->current.type);
             return;
         case TOKEN_NEWLINE:
@@ -397,6 +406,57 @@ Type *parser_type(Parser *parser)
     case TOKEN_NIL:
         kind = TYPE_NIL;
         break;
+    case TOKEN_LEFT_PAREN:
+    {
+        parser_advance(parser);
+        Type **element_types = NULL;
+        int count = 0;
+        int capacity = 0;
+        do
+        {
+            Type *element_type = parser_type(parser);
+            if (element_type == NULL)
+            {
+                return NULL;
+            }
+            if (count >= capacity)
+            {
+                capacity = capacity == 0 ? 4 : capacity * 2;
+                Type **new_types = arena_alloc(parser->arena, sizeof(Type *) * capacity);
+                if (element_types != NULL && count > 0)
+                {
+                    memcpy(new_types, element_types, sizeof(Type *) * count);
+                }
+                element_types = new_types;
+            }
+            element_types[count++] = element_type;
+        } while (parser_match(parser, TOKEN_COMMA));
+        parser_consume(parser, TOKEN_RIGHT_PAREN, "Expected ')' after tuple element types");
+        if (count < 2)
+        {
+            parser_error(parser, "Tuple types need at least two elements");
+            return NULL;
+        }
+        type = ast_create_tuple_type(parser->arena, element_types, count);
+        DEBUG_VERBOSE("Exiting parser_type: parsed type %s", ast_type_to_string(parser->arena, type));
+        return type;
+    }
+    case TOKEN_MAP:
+    {
+        parser_advance(parser);
+        parser_consume(parser, TOKEN_LESS, "Expected '<' after 'map'");
+        Type *key_type = parser_type(parser);
+        parser_consume(parser, TOKEN_COMMA, "Expected ',' between map key and value types");
+        Type *value_type = parser_type(parser);
+        parser_consume(parser, TOKEN_GREATER, "Expected '>' after map value type");
+        if (key_type == NULL || value_type == NULL)
+        {
+            return NULL;
+        }
+        type = ast_create_map_type(parser->arena, key_type, value_type);
+        DEBUG_VERBOSE("Exiting parser_type: parsed type %s", ast_type_to_string(parser->arena, type));
+        return type;
+    }
     default:
         parser_error_at_current(parser, "Expected type");
         DEBUG_VERBOSE("Error: Expected type, got token type %d", tt);
@@ -620,6 +680,225 @@ Expr *parser_postfix(Parser *parser)
     return expr;
 }
 
+// Decodes `[[fill]align][+][0][width][.precision][conversion]`. Whether the
+// spec suits the value's type is left to the type checker.
+static bool parser_format_spec(const char *spec, int length, FormatSpec *out)
+{
+    out->fill = ' ';
+    out->align = 0;
+    out->plus = false;
+    out->width = 0;
+    out->precision = -1;
+    out->conversion = 0;
+    int i = 0;
+    if (length >= 2 && strchr("<>^", spec[1]) != NULL)
+    {
+        out->fill = spec[0];
+        out->align = spec[1];
+        i = 2;
+    }
+    else if (length >= 1 && strchr("<>^", spec[0]) != NULL)
+    {
+        out->align = spec[0];
+        i = 1;
+    }
+    if (i < length && spec[i] == '+')
+    {
+        out->plus = true;
+        i++;
+    }
+    if (i < length && spec[i] == '0')
+    {
+        if (out->align == 0)
+        {
+            out->fill = '0';
+            out->align = '=';
+        }
+        i++;
+    }
+    while (i < length && isdigit((unsigned char)spec[i]))
+    {
+        out->width = out->width * 10 + (spec[i++] - '0');
+        if (out->width > 4096)
+            return false;
+    }
+    if (i < length && spec[i] == '.')
+    {
+        i++;
+        if (i >= length || !isdigit((unsigned char)spec[i]))
+            return false;
+        out->precision = 0;
+        while (i < length && isdigit((unsigned char)spec[i]))
+        {
+            out->precision = out->precision * 10 + (spec[i++] - '0');
+            if (out->precision > 4096)
+                return false;
+        }
+    }
+    if (i < length && strchr("dxXobfsc", spec[i]) != NULL)
+    {
+        out->conversion = spec[i++];
+    }
+    return i == length;
+}
+
+// Parses the expression inside one `{...}` hole with a lexer over just that text.
+static Expr *parser_interpolated_hole(Parser *parser, const char *start, int length, Token *loc_token)
+{
+    while (length > 0 && isspace((unsigned char)start[0]))
+    {
+        start++;
+        length--;
+    }
+    while (length > 0 && isspace((unsigned char)start[length - 1]))
+    {
+        length--;
+    }
+    if (length == 0)
+    {
+        parser_error_at(parser, loc_token, "Empty expression in interpolated string");
+        return NULL;
+    }
+    Lexer lexer;
+    lexer_init(parser->arena, &lexer, arena_strndup(parser->arena, start, length), loc_token->filename);
+    lexer.line = loc_token->line;
+
+    Lexer *saved_lexer = parser->lexer;
+    Token saved_current = parser->current;
+    Token saved_previous = parser->previous;
+    parser->lexer = &lexer;
+    parser_advance(parser);
+    Expr *expr = parser_expression(parser);
+    bool complete = parser_check(parser, TOKEN_EOF) || parser_check(parser, TOKEN_NEWLINE);
+    parser->lexer = saved_lexer;
+    parser->current = saved_current;
+    parser->previous = saved_previous;
+
+    if (expr != NULL && !complete)
+    {
+        parser_error_at(parser, loc_token, "Unexpected text after expression in interpolated string");
+        return NULL;
+    }
+    return expr;
+}
+
+static void parser_add_interpolated_part(Parser *parser, Expr *part, FormatSpec *spec, Expr ***parts,
+                                         FormatSpec ***specs, int *count, int *capacity)
+{
+    if (*count >= *capacity)
+    {
+        int new_capacity = *capacity == 0 ? 8 : *capacity * 2;
+        Expr **new_parts = arena_alloc(parser->arena, sizeof(Expr *) * new_capacity);
+        FormatSpec **new_specs = arena_alloc(parser->arena, sizeof(FormatSpec *) * new_capacity);
+        if (new_parts == NULL || new_specs == NULL)
+        {
+            exit(1);
+        }
+        if (*count > 0)
+        {
+            memcpy(new_parts, *parts, sizeof(Expr *) * *count);
+            memcpy(new_specs, *specs, sizeof(FormatSpec *) * *count);
+        }
+        *parts = new_parts;
+        *specs = new_specs;
+        *capacity = new_capacity;
+    }
+    (*parts)[*count] = part;
+    (*specs)[*count] = spec;
+    (*count)++;
+}
+
+// Splits `$"text {expr:spec} text"` into literal and expression parts. The lexer
+// has already resolved escapes; `{{` and `}}` stand for literal braces.
+static Expr *parser_interpolated_string(Parser *parser)
+{
+    DEBUG_VERBOSE("Entering parser_interpolated_string");
+    Token loc_token = parser->previous;
+    const char *text = loc_token.literal.string_value;
+    Expr **parts = NULL;
+    FormatSpec **specs = NULL;
+    int count = 0;
+    int capacity = 0;
+    bool has_spec = false;
+    char *literal = arena_alloc(parser->arena, strlen(text) + 1);
+    int literal_length = 0;
+
+    int i = 0;
+    while (text[i] != '\0')
+    {
+        char c = text[i];
+        if ((c == '{' || c == '}') && text[i + 1] == c)
+        {
+            literal[literal_length++] = c;
+            i += 2;
+            continue;
+        }
+        if (c == '}')
+        {
+            parser_error_at(parser, &loc_token, "Unmatched '}' in interpolated string");
+            return NULL;
+        }
+        if (c != '{')
+        {
+            literal[literal_length++] = c;
+            i++;
+            continue;
+        }
+
+        if (literal_length > 0)
+        {
+            LiteralValue value = { .string_value = arena_strndup(parser->arena, literal, literal_length) };
+            Expr *part = ast_create_literal_expr(parser->arena, value, ast_create_primitive_type(parser->arena, TYPE_STRING), false, &loc_token);
+            parser_add_interpolated_part(parser, part, NULL, &parts, &specs, &count, &capacity);
+            literal_length = 0;
+        }
+
+        int start = ++i;
+        int depth = 0;
+        int colon = -1;
+        while (text[i] != '\0' && !(text[i] == '}' && depth == 0))
+        {
+            if (text[i] == '(' || text[i] == '{')
+                depth++;
+            else if (text[i] == ')' || text[i] == '}')
+                depth--;
+            else if (text[i] == ':' && depth == 0 && colon < 0)
+                colon = i;
+            i++;
+        }
+        if (text[i] == '\0')
+        {
+            parser_error_at(parser, &loc_token, "Unterminated '{' in interpolated string");
+            return NULL;
+        }
+        Expr *part = parser_interpolated_hole(parser, text + start, (colon >= 0 ? colon : i) - start, &loc_token);
+        if (part == NULL)
+        {
+            return NULL;
+        }
+        FormatSpec *spec = NULL;
+        if (colon >= 0)
+        {
+            spec = arena_alloc(parser->arena, sizeof(FormatSpec));
+            if (!parser_format_spec(text + colon + 1, i - colon - 1, spec))
+            {
+                parser_error_at(parser, &loc_token, "Invalid format spec in interpolated string");
+                return NULL;
+            }
+            has_spec = true;
+        }
+        parser_add_interpolated_part(parser, part, spec, &parts, &specs, &count, &capacity);
+        i++;
+    }
+    if (literal_length > 0)
+    {
+        LiteralValue value = { .string_value = arena_strndup(parser->arena, literal, literal_length) };
+        Expr *part = ast_create_literal_expr(parser->arena, value, ast_create_primitive_type(parser->arena, TYPE_STRING), false, &loc_token);
+        parser_add_interpolated_part(parser, part, NULL, &parts, &specs, &count, &capacity);
+    }
+    return ast_create_interpolated_expr(parser->arena, parts, has_spec ? specs : NULL, count, &loc_token);
+}
+
 Expr *parser_primary(Parser *parser)
 {
     DEBUG_VERBOSE("Entering parser_primary");
@@ -687,28 +966,7 @@ Expr *parser_primary(Parser *parser)
     }
     if (parser_match(parser, TOKEN_INTERPOL_STRING))
     {
-        // Parse interpolated string
-        char *source = arena_strndup(parser->arena, parser->previous.start, parser->previous.length);
-        if (parser->interp_count >= parser->interp_capacity)
-        {
-            parser->interp_capacity = parser->interp_capacity == 0 ? 8 : parser->interp_capacity * 2;
-            char **new_sources = arena_alloc(parser->arena, sizeof(char *) * parser->interp_capacity);
-            if (new_sources == NULL)
-            {
-                exit(1);
-            }
-            if (parser->interp_sources != NULL && parser->interp_count > 0)
-            {
-                memcpy(new_sources, parser->interp_sources, sizeof(char *) * parser->interp_count);
-            }
-            parser->interp_sources = new_sources;
-        }
-        parser->interp_sources[parser->interp_count++] = source;
-
-        // For now, create a placeholder literal; actual parsing happens later
-        LiteralValue value;
-        value.string_value = source;
-        return ast_create_literal_expr(parser->arena, value, ast_create_primitive_type(parser->arena, TYPE_STRING), true, &parser->previous);
+        return parser_interpolated_string(parser);
     }
     if (parser_match(parser, TOKEN_IDENTIFIER))
     {
@@ -716,7 +974,34 @@ Expr *parser_primary(Parser *parser)
     }
     if (parser_match(parser, TOKEN_LEFT_PAREN))
     {
+        Token paren_token = parser->previous;
         Expr *expr = parser_expression(parser);
+        if (expr != NULL && parser_check(parser, TOKEN_COMMA))
+        {
+            int capacity = 4;
+            int count = 0;
+            Expr **elements = arena_alloc(parser->arena, sizeof(Expr *) * capacity);
+            elements[count++] = expr;
+            while (parser_match(parser, TOKEN_COMMA))
+            {
+                Expr *element = parser_expression(parser);
+                if (element == NULL)
+                {
+                    return NULL;
+                }
+                if (count >= capacity)
+                {
+                    capacity *= 2;
+                    Expr **new_elements = arena_alloc(parser->arena, sizeof(Expr *) * capacity);
+                    memcpy(new_elements, elements, sizeof(Expr *) * count);
+                    elements = new_elements;
+                }
+                elements[count++] = element;
+            }
+            parser_consume(parser, TOKEN_RIGHT_PAREN, "Expect ')' after tuple elements.");
+            DEBUG_VERBOSE("Exiting parser_primary: tuple with %d elements", count);
+            return ast_create_tuple_expr(parser->arena, elements, count, &paren_token);
+        }
         parser_consume(parser, TOKEN_RIGHT_PAREN, "Expect ')' after expression.");
         DEBUG_VERBOSE("Exiting parser_primary: grouped expression");
         return expr;
@@ -876,6 +1161,13 @@ Stmt *parser_statement(Parser *parser)
         DEBUG_VERBOSE("Exiting parser_statement: parsed variable declaration");
         return result;
     }
+    if (parser_match(parser, TOKEN_CONST))
+    {
+        DEBUG_VERBOSE("Found CONST, parsing const declaration");
+        Stmt *result = parser_const_declaration(parser);
+        DEBUG_VERBOSE("Exiting parser_statement: parsed const declaration");
+        return result;
+    }
     if (parser_match(parser, TOKEN_IF))
     {
         DEBUG_VERBOSE("Found IF, parsing if statement");
@@ -897,6 +1189,13 @@ Stmt *parser_statement(Parser *parser)
         DEBUG_VERBOSE("Exiting parser_statement: parsed for statement");
         return result;
     }
+    if (parser_match(parser, TOKEN_MATCH))
+    {
+        DEBUG_VERBOSE("Found MATCH, parsing match statement");
+        Stmt *result = parser_match_statement(parser);
+        DEBUG_VERBOSE("Exiting parser_statement: parsed match statement");
+        return result;
+    }
     if (parser_match(parser, TOKEN_RETURN))
     {
         DEBUG_VERBOSE("Found RETURN, parsing return statement");
@@ -940,6 +1239,13 @@ Stmt *parser_declaration(Parser *parser)
         DEBUG_VERBOSE("Exiting parser_declaration: parsed variable declaration");
         return result;
     }
+    if (parser_match(parser, TOKEN_CONST))
+    {
+        DEBUG_VERBOSE("Found CONST, parsing const declaration");
+        Stmt *result = parser_const_declaration(parser);
+        DEBUG_VERBOSE("Exiting parser_declaration: parsed const declaration");
+        return result;
+    }
     if (parser_match(parser, TOKEN_FN))
     {
         DEBUG_VERBOSE("Found FN, parsing function declaration");
@@ -947,6 +1253,20 @@ Stmt *parser_declaration(Parser *parser)
         DEBUG_VERBOSE("Exiting parser_declaration: parsed function declaration");
         return result;
     }
+    if (parser_match(parser, TOKEN_AT))
+    {
+        DEBUG_VERBOSE("Found AT, parsing annotated declaration");
+        Stmt *result = parser_annotated_declaration(parser);
+        DEBUG_VERBOSE("Exiting parser_declaration: parsed annotated declaration");
+        return result;
+    }
+    if (parser_match(parser, TOKEN_BENCH))
+    {
+        DEBUG_VERBOSE("Found BENCH, parsing bench declaration");
+        Stmt *result = parser_bench_declaration(parser);
+        DEBUG_VERBOSE("Exiting parser_declaration: parsed bench declaration");
+        return result;
+    }
     if (parser_match(parser, TOKEN_IMPORT))
     {
         DEBUG_VERBOSE("Found IMPORT, parsing import statement");
@@ -961,10 +1281,57 @@ Stmt *parser_declaration(Parser *parser)
     return result;
 }
 
+static Stmt *parser_var_tuple_declaration(Parser *parser, Token var_token)
+{
+    DEBUG_VERBOSE("Entering parser_var_tuple_declaration");
+    parser_consume(parser, TOKEN_LEFT_PAREN, "Expected '(' before destructured names");
+    Token *names = NULL;
+    int count = 0;
+    int capacity = 0;
+    do
+    {
+        if (!parser_check(parser, TOKEN_IDENTIFIER))
+        {
+            parser_error_at_current(parser, "Expected variable name in destructuring declaration");
+            return NULL;
+        }
+        if (count >= capacity)
+        {
+            capacity = capacity == 0 ? 4 : capacity * 2;
+            Token *new_names = arena_alloc(parser->arena, sizeof(Token) * capacity);
+            if (names != NULL && count > 0)
+            {
+                memcpy(new_names, names, sizeof(Token) * count);
+            }
+            names = new_names;
+        }
+        names[count] = parser->current;
+        names[count].start = arena_strndup(parser->arena, parser->current.start, parser->current.length);
+        count++;
+        parser_advance(parser);
+    } while (parser_match(parser, TOKEN_COMMA));
+    parser_consume(parser, TOKEN_RIGHT_PAREN, "Expected ')' after destructured names");
+    parser_consume(parser, TOKEN_EQUAL, "Expected '=' after destructured names");
+    Expr *initializer = parser_expression(parser);
+
+    if (!parser_match(parser, TOKEN_SEMICOLON) && !parser_match(parser, TOKEN_NEWLINE))
+    {
+        parser_consume(parser, TOKEN_SEMICOLON, "Expected ';' or newline after variable declaration");
+    }
+
+    Stmt *result = ast_create_var_tuple_stmt(parser->arena, names, count, initializer, &var_token);
+    DEBUG_VERBOSE("Exiting parser_var_tuple_declaration: %d names", count);
+    return result;
+}
+
 Stmt *parser_var_declaration(Parser *parser)
 {
     DEBUG_VERBOSE("Entering parser_var_declaration");
     Token var_token = parser->previous;
+    if (parser_check(parser, TOKEN_LEFT_PAREN))
+    {
+        return parser_var_tuple_declaration(parser, var_token);
+    }
     Token name;
     if (parser_check(parser, TOKEN_IDENTIFIER))
     {
@@ -1017,6 +1384,28 @@ Stmt *parser_var_declaration(Parser *parser)
     return result;
 }
 
+Stmt *parser_const_declaration(Parser *parser)
+{
+    DEBUG_VERBOSE("Entering parser_const_declaration");
+    if (parser_check(parser, TOKEN_LEFT_PAREN))
+    {
+        parser_error_at_current(parser, "Const declarations cannot destructure tuples");
+        return NULL;
+    }
+    Stmt *result = parser_var_declaration(parser);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    if (result->as.var_decl.initializer == NULL)
+    {
+        parser_error(parser, "Const declaration requires an initializer");
+    }
+    result->as.var_decl.is_const = true;
+    DEBUG_VERBOSE("Exiting parser_const_declaration");
+    return result;
+}
+
 Stmt *parser_function_declaration(Parser *parser)
 {
     DEBUG_VERBOSE("Entering parser_function_declaration");
@@ -1066,6 +1455,7 @@ Stmt *parser_function_declaration(Parser *parser)
                     parser_error_at_current(parser, "Cannot have more than 255 parameters");
                     DEBUG_VERBOSE("Error: Too many parameters");
                 }
+                bool is_ref = parser_match(parser, TOKEN_REF);
                 Token param_name;
                 if (parser_check(parser, TOKEN_IDENTIFIER))
                 {
@@ -1117,6 +1507,7 @@ Stmt *parser_function_declaration(Parser *parser)
                 }
                 params[param_count].name = param_name;
                 params[param_count].type = param_type;
+                params[param_count].is_ref = is_ref;
                 param_count++;
                 DEBUG_VERBOSE("Added parameter, count=%d", param_count);
             } while (parser_match(parser, TOKEN_COMMA));
@@ -1143,6 +1534,18 @@ Stmt *parser_function_declaration(Parser *parser)
         param_types[i] = params[i].type;
     }
     Type *function_type = ast_create_function_type(parser->arena, return_type, param_types, param_count);
+    for (int i = 0; i < param_count; i++)
+    {
+        if (params[i].is_ref)
+        {
+            if (function_type->as.function.param_refs == NULL)
+            {
+                function_type->as.function.param_refs = arena_alloc(parser->arena, sizeof(bool) * param_count);
+                memset(function_type->as.function.param_refs, 0, sizeof(bool) * param_count);
+            }
+            function_type->as.function.param_refs[i] = true;
+        }
+    }
     DEBUG_VERBOSE("Created function type with %d parameters", param_count);
 
     symbol_table_add_symbol(parser->symbol_table, name, function_type);
@@ -1169,6 +1572,90 @@ Stmt *parser_function_declaration(Parser *parser)
     return result;
 }
 
+static int parser_annotation(Parser *parser, int *memo_limit)
+{
+    DEBUG_VERBOSE("Entering parser_annotation");
+    parser_consume(parser, TOKEN_IDENTIFIER, "Expected annotation name after '@'");
+    Token name = parser->previous;
+    int annotation = FUNC_ANNOTATION_NONE;
+    if (name.length == 7 && memcmp(name.start, "checked", 7) == 0)
+    {
+        annotation = FUNC_ANNOTATION_CHECKED;
+    }
+    else if (name.length == 9 && memcmp(name.start, "unchecked", 9) == 0)
+    {
+        annotation = FUNC_ANNOTATION_UNCHECKED;
+    }
+    else if (name.length == 8 && memcmp(name.start, "fastmath", 8) == 0)
+    {
+        annotation = FUNC_ANNOTATION_FASTMATH;
+    }
+    else if (name.length == 4 && memcmp(name.start, "memo", 4) == 0)
+    {
+        annotation = FUNC_ANNOTATION_MEMO;
+        if (parser_match(parser, TOKEN_LEFT_PAREN))
+        {
+            parser_consume(parser, TOKEN_INT_LITERAL, "Expected entry limit in @memo(...)");
+            if (parser->previous.literal.int_value <= 0)
+            {
+                parser_error(parser, "@memo limit must be positive");
+            }
+            *memo_limit = (int)parser->previous.literal.int_value;
+            parser_consume(parser, TOKEN_RIGHT_PAREN, "Expected ')' after @memo limit");
+        }
+    }
+    else
+    {
+        parser_error(parser, "Unknown annotation");
+    }
+    DEBUG_VERBOSE("Exiting parser_annotation: annotation=0x%x", annotation);
+    return annotation;
+}
+
+Stmt *parser_annotated_declaration(Parser *parser)
+{
+    DEBUG_VERBOSE("Entering parser_annotated_declaration");
+    int memo_limit = 0;
+    int annotations = parser_annotation(parser, &memo_limit);
+    for (;;)
+    {
+        while (parser_match(parser, TOKEN_NEWLINE))
+        {
+            DEBUG_VERBOSE("Skipped NEWLINE token");
+        }
+        if (!parser_match(parser, TOKEN_AT))
+        {
+            break;
+        }
+        int annotation = parser_annotation(parser, &memo_limit);
+        if (annotations & annotation)
+        {
+            parser_error(parser, "Duplicate annotation");
+        }
+        annotations |= annotation;
+    }
+
+    if ((annotations & FUNC_ANNOTATION_CHECKED) && (annotations & FUNC_ANNOTATION_UNCHECKED))
+    {
+        parser_error(parser, "Function cannot be both @checked and @unchecked");
+    }
+
+    if (!parser_match(parser, TOKEN_FN))
+    {
+        parser_error_at_current(parser, "Expected 'fn' after annotations");
+        return NULL;
+    }
+
+    Stmt *result = parser_function_declaration(parser);
+    if (result != NULL)
+    {
+        result->as.function.annotations = annotations;
+        result->as.function.memo_limit = memo_limit;
+    }
+    DEBUG_VERBOSE("Exiting parser_annotated_declaration: annotations=0x%x", annotations);
+    return result;
+}
+
 Stmt *parser_return_statement(Parser *parser)
 {
     DEBUG_VERBOSE("Entering parser_return_statement");
@@ -1432,6 +1919,141 @@ Stmt *parser_for_statement(Parser *parser)
     return result;
 }
 
+static Stmt *parser_match_body(Parser *parser)
+{
+    DEBUG_VERBOSE("Entering parser_match_body");
+    skip_newlines(parser);
+    Stmt *body;
+    if (parser_check(parser, TOKEN_INDENT))
+    {
+        body = parser_indented_block(parser);
+    }
+    else
+    {
+        body = parser_statement(parser);
+    }
+    DEBUG_VERBOSE("Exiting parser_match_body");
+    return body;
+}
+
+Stmt *parser_bench_declaration(Parser *parser)
+{
+    DEBUG_VERBOSE("Entering parser_bench_declaration");
+    Token bench_token = parser->previous;
+    if (!parser_check(parser, TOKEN_STRING_LITERAL))
+    {
+        parser_error_at_current(parser, "Expected benchmark name string after 'bench'");
+        return NULL;
+    }
+    parser_advance(parser);
+    char *name = arena_strdup(parser->arena, parser->previous.literal.string_value);
+    parser_consume(parser, TOKEN_ARROW, "Expected '=>' after benchmark name");
+    skip_newlines(parser);
+
+    Stmt *body = parser_indented_block(parser);
+    if (body == NULL)
+    {
+        body = ast_create_block_stmt(parser->arena, NULL, 0, NULL);
+    }
+    Stmt *result = ast_create_bench_stmt(parser->arena, name, body->as.block.statements, body->as.block.count, &bench_token);
+    DEBUG_VERBOSE("Exiting parser_bench_declaration: %d statements", body->as.block.count);
+    return result;
+}
+
+Stmt *parser_match_statement(Parser *parser)
+{
+    DEBUG_VERBOSE("Entering parser_match_statement");
+    Token match_token = parser->previous;
+    Expr *subject = parser_expression(parser);
+    parser_consume(parser, TOKEN_ARROW, "Expected '=>' after match subject");
+    skip_newlines(parser);
+    if (!parser_match(parser, TOKEN_INDENT))
+    {
+        parser_error_at_current(parser, "Expected indented match cases");
+        return NULL;
+    }
+
+    MatchCase *cases = NULL;
+    int count = 0;
+    int capacity = 0;
+    Stmt *else_branch = NULL;
+    while (!parser_is_at_end(parser))
+    {
+        while (parser_match(parser, TOKEN_NEWLINE))
+        {
+            DEBUG_VERBOSE("Skipped NEWLINE token");
+        }
+        if (parser_check(parser, TOKEN_DEDENT) || parser_check(parser, TOKEN_EOF))
+        {
+            break;
+        }
+
+        if (parser_match(parser, TOKEN_ELSE))
+        {
+            if (else_branch != NULL)
+            {
+                parser_error(parser, "Match can only have one else case");
+            }
+            parser_consume(parser, TOKEN_ARROW, "Expected '=>' after else");
+            else_branch = parser_match_body(parser);
+            continue;
+        }
+        if (else_branch != NULL)
+        {
+            parser_error_at_current(parser, "Else must be the last match case");
+        }
+
+        Expr **values = NULL;
+        int value_count = 0;
+        int value_capacity = 0;
+        do
+        {
+            Expr *value = parser_expression(parser);
+            if (value == NULL)
+            {
+                return NULL;
+            }
+            if (value_count >= value_capacity)
+            {
+                value_capacity = value_capacity == 0 ? 4 : value_capacity * 2;
+                Expr **new_values = arena_alloc(parser->arena, sizeof(Expr *) * value_capacity);
+                if (values != NULL && value_count > 0)
+                {
+                    memcpy(new_values, values, sizeof(Expr *) * value_count);
+                }
+                values = new_values;
+            }
+            values[value_count++] = value;
+        } while (parser_match(parser, TOKEN_COMMA));
+        parser_consume(parser, TOKEN_ARROW, "Expected '=>' after match case values");
+
+        if (count >= capacity)
+        {
+            capacity = capacity == 0 ? 8 : capacity * 2;
+            MatchCase *new_cases = arena_alloc(parser->arena, sizeof(MatchCase) * capacity);
+            if (new_cases == NULL)
+            {
+                DEBUG_VERBOSE("Failed to allocate memory for match cases, exiting");
+                exit(1);
+            }
+            if (cases != NULL && count > 0)
+            {
+                memcpy(new_cases, cases, sizeof(MatchCase) * count);
+            }
+            cases = new_cases;
+        }
+        cases[count].values = values;
+        cases[count].value_count = value_count;
+        cases[count].body = parser_match_body(parser);
+        count++;
+    }
+    parser_match(parser, TOKEN_DEDENT);
+
+    Stmt *result = ast_create_match_stmt(parser->arena, subject, cases, count, else_branch, &match_token);
+    DEBUG_VERBOSE("Exiting parser_match_statement: %d cases", count);
+    return result;
+}
+
 Stmt *parser_block_statement(Parser *parser)
 {
     DEBUG_VERBOSE("Entering parser_block_statement");
@@ -1493,6 +2115,7 @@ Stmt *parser_block_statement(Parser *parser)
 Stmt *parser_expression_statement(Parser *parser)
 {
     DEBUG_VERBOSE("Entering parser_expression_statement");
+    Token start = parser->current; // Locates the statement at its first token, not the terminator
     Expr *expression = parser_expression(parser);
     DEBUG_VERBOSE("Parsed expression");
 
@@ -1518,7 +2141,7 @@ Stmt *parser_expression_statement(Parser *parser)
     }
     DEBUG_VERBOSE("Consumed SEMICOLON or NEWLINE after expression or accepted EOF");
 
-    Stmt *result = ast_create_expr_stmt(parser->arena, expression, &parser->previous);
+    Stmt *result = ast_create_expr_stmt(parser->arena, expression, &start);
     DEBUG_VERBOSE("Exiting parser_expression_statement: created expression statement");
     return result;
 }
@@ -1530,7 +2153,7 @@ Stmt *parser_import_statement(Parser *parser)
     Token module_name;
     if (parser_match(parser, TOKEN_STRING_LITERAL))
     {
-        char *unescaped = unescape_string(parser->arena, parser->current.start + 1, parser->current.length - 2);
+        char *unescaped = unescape_string(parser->arena, parser->previous.start + 1, parser->previous.length - 2);
         if (unescaped == NULL) {
             parser_error_at_current(parser, "Out of memory for import module name");
             return NULL;
@@ -1626,7 +2249,10 @@ Module *parser_execute(Parser *parser, const char *filename)
 Module *parse_module_with_imports(Arena *arena, SymbolTable *symbol_table, const char *filename, char ***imported, int *imported_count, int *imported_capacity)
 {
     DEBUG_VERBOSE("Entering parse_module_with_imports: filename=%s", filename);
+    timing_begin_module(arena, filename);
+    timing_begin(PHASE_READ, arena);
     char *source = file_read(arena, filename);
+    timing_end(PHASE_READ, arena);
     if (!source)
     {
         DEBUG_ERROR("Failed to read file: %s", filename);
@@ -1642,7 +2268,9 @@ Module *parse_module_with_imports(Arena *arena, SymbolTable *symbol_table, const
     parser_init(arena, &parser, &lexer, symbol_table);
     DEBUG_VERBOSE("Initialized parser");
 
+    timing_begin(PHASE_PARSE, arena);
     Module *module = parser_execute(&parser, filename);
+    timing_end(PHASE_PARSE, arena);
     if (!module || parser.had_error)
     {
         parser_cleanup(&parser);
@@ -1651,6 +2279,7 @@ Module *parse_module_with_imports(Arena *arena, SymbolTable *symbol_table, const
         return NULL;
     }
     DEBUG_VERBOSE("Executed parser, module has %d statements", module->count);
+    timing_count_module(module, source);
 
     // Collect all statements, starting with imported ones
     Stmt **all_statements = NULL;
@@ -1764,7 +2393,10 @@ Module *parse_module_with_imports(Arena *arena, SymbolTable *symbol_table, const
             int new_all_count = all_count + imported_module->count;
             if (new_all_count > all_capacity)
             {
-                all_capacity = all_capacity == 0 ? 8 : all_capacity * 2;
+                while (all_capacity < new_all_count)
+                {
+                    all_capacity = all_capacity == 0 ? 8 : all_capacity * 2;
+                }
                 Stmt **new_statements = arena_alloc(arena, sizeof(Stmt *) * all_capacity);
                 if (!new_statements)
                 {
@@ -1799,7 +2431,10 @@ Module *parse_module_with_imports(Arena *arena, SymbolTable *symbol_table, const
     int new_all_count = all_count + module->count;
     if (new_all_count > all_capacity)
     {
-        all_capacity = all_capacity == 0 ? 8 : all_capacity * 2;
+        while (all_capacity < new_all_count)
+        {
+            all_capacity = all_capacity == 0 ? 8 : all_capacity * 2;
+        }
         Stmt **new_statements = arena_alloc(arena, sizeof(Stmt *) * all_capacity);
         if (!new_statements)
         {
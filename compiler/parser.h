@@ -52,11 +52,15 @@ Expr *parser_array_access(Parser *parser, Expr *array);
 Stmt *parser_statement(Parser *parser);
 Stmt *parser_declaration(Parser *parser);
 Stmt *parser_var_declaration(Parser *parser);
+Stmt *parser_const_declaration(Parser *parser);
 Stmt *parser_function_declaration(Parser *parser);
+Stmt *parser_annotated_declaration(Parser *parser);
 Stmt *parser_return_statement(Parser *parser);
 Stmt *parser_if_statement(Parser *parser);
 Stmt *parser_while_statement(Parser *parser);
 Stmt *parser_for_statement(Parser *parser);
+Stmt *parser_match_statement(Parser *parser);
+Stmt *parser_bench_declaration(Parser *parser);
 Stmt *parser_block_statement(Parser *parser);
 Stmt *parser_expression_statement(Parser *parser);
 Stmt *parser_import_statement(Parser *parser);
@@ -0,0 +1,139 @@
+#include "perf.h"
+#include "debug.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char *counter_names[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "cache-misses", "branch-misses"
+};
+
+const char *perf_counter_name(PerfCounter counter)
+{
+    return counter_names[counter];
+}
+
+#ifdef __linux__
+
+static const unsigned long long counter_configs[PERF_COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static int group_fd = -1;
+static int counter_fds[PERF_COUNTER_COUNT] = {-1, -1, -1, -1};
+
+static int perf_event_open(struct perf_event_attr *attr, int group)
+{
+    return (int)syscall(SYS_perf_event_open, attr, 0, -1, group, 0);
+}
+
+int perf_open(void)
+{
+    DEBUG_VERBOSE("Entering perf_open");
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = counter_configs[i];
+        attr.disabled = group_fd == -1; // The leader starts the whole group
+        attr.exclude_kernel = 1;        // Keep the read syscalls out of the counts
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        int fd = perf_event_open(&attr, group_fd);
+        if (fd == -1)
+        {
+            if (group_fd == -1)
+            {
+                DEBUG_WARNING("Hardware counters unavailable (%s); --perf-counters ignored", strerror(errno));
+                return 0;
+            }
+            DEBUG_WARNING("Counter %s unavailable (%s)", counter_names[i], strerror(errno));
+            continue;
+        }
+        if (group_fd == -1)
+        {
+            group_fd = fd;
+        }
+        counter_fds[i] = fd;
+    }
+    ioctl(group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return 1;
+}
+
+int perf_available(PerfCounter counter)
+{
+    return counter_fds[counter] != -1;
+}
+
+// One read() returns every counter in the group, in the order they were opened.
+void perf_read(PerfSample *sample)
+{
+    memset(sample, 0, sizeof(*sample));
+    if (group_fd == -1)
+        return;
+    unsigned long long buffer[1 + PERF_COUNTER_COUNT];
+    if (read(group_fd, buffer, sizeof(buffer)) < (ssize_t)sizeof(unsigned long long))
+        return;
+    int index = 1;
+    for (int i = 0; i < PERF_COUNTER_COUNT && index <= (int)buffer[0]; i++)
+    {
+        if (counter_fds[i] != -1)
+        {
+            sample->values[i] = buffer[index++];
+        }
+    }
+}
+
+void perf_close(void)
+{
+    DEBUG_VERBOSE("Entering perf_close");
+    if (group_fd == -1)
+        return;
+    ioctl(group_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (int i = PERF_COUNTER_COUNT - 1; i >= 0; i--)
+    {
+        if (counter_fds[i] != -1)
+        {
+            close(counter_fds[i]);
+            counter_fds[i] = -1;
+        }
+    }
+    group_fd = -1;
+}
+
+#else
+
+int perf_open(void)
+{
+    DEBUG_WARNING("Hardware counters are only supported on Linux; --perf-counters ignored");
+    return 0;
+}
+
+int perf_available(PerfCounter counter)
+{
+    (void)counter;
+    return 0;
+}
+
+void perf_read(PerfSample *sample)
+{
+    memset(sample, 0, sizeof(*sample));
+}
+
+void perf_close(void)
+{
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef PERF_H
+#define PERF_H
+
+typedef enum
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+typedef struct
+{
+    unsigned long long values[PERF_COUNTER_COUNT];
+} PerfSample;
+
+/* Opens user-space hardware counters for this process. Returns 0 (after
+ * logging why) when perf_event_open is unavailable or not permitted, in which
+ * case perf_read leaves samples zeroed. */
+int perf_open(void);
+int perf_available(PerfCounter counter);
+void perf_read(PerfSample *sample);
+void perf_close(void);
+const char *perf_counter_name(PerfCounter counter);
+
+#endif
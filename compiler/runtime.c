@@ -3,6 +3,21 @@
 #include <stdio.h>
 #include <math.h>
 #include <limits.h>
+#include <stdint.h>
+#include <float.h>
+#include <time.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__linux__) && defined(_GNU_SOURCE)
+#include <errno.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#define RT_SAMPLE_SUPPORTED 1
+#endif
+#include "runtime.h"
 
 static const char *null_str = "(null)";
 
@@ -285,6 +300,16 @@ long rt_post_dec_long(long *p)
     return (*p)--;
 }
 
+long rt_array_index(long index, long length)
+{
+    if (index < 0 || index >= length)
+    {
+        fprintf(stderr, "rt_array_index: index %ld out of bounds for length %ld\n", index, length);
+        exit(1);
+    }
+    return index;
+}
+
 int rt_eq_string(const char *a, const char *b) {
     return strcmp(a, b) == 0;
 }
@@ -314,4 +339,1720 @@ void rt_free_string(char *s) {
         return;
     }
     free(s);
-}
\ No newline at end of file
+}
+
+/* ---------------------------------------------------------------------------
+ * Interpolation formatting
+ *
+ * The compiler decodes `{expr:spec}` and calls these with the pieces, so no
+ * format string is parsed at run time. Integers and fixed-point doubles are
+ * converted digit by digit; snprintf is only used for doubles too large for
+ * exact integer scaling or too close to a rounding tie to decide cheaply.
+ * ------------------------------------------------------------------------- */
+
+static char *rt_format_pad(const char *sign, const char *body, size_t body_len, long width, long fill, long align)
+{
+    size_t sign_len = strlen(sign);
+    size_t content_len = sign_len + body_len;
+    size_t pad = width > 0 && (size_t)width > content_len ? (size_t)width - content_len : 0;
+    size_t left = align == '<' ? 0 : (align == '^' ? pad / 2 : pad);
+    char *out = malloc(content_len + pad + 1);
+    if (out == NULL) {
+        return NULL;
+    }
+    char *p = out;
+    if (align == '=') {
+        memcpy(p, sign, sign_len);
+        p += sign_len;
+        memset(p, (int)fill, pad);
+        p += pad;
+    } else {
+        memset(p, (int)fill, left);
+        p += left;
+        memcpy(p, sign, sign_len);
+        p += sign_len;
+    }
+    memcpy(p, body, body_len);
+    p += body_len;
+    if (align != '=') {
+        memset(p, (int)fill, pad - left);
+        p += pad - left;
+    }
+    *p = '\0';
+    return out;
+}
+
+char *rt_format_long(long value, long base, long upper, long plus, long width, long fill, long align)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char body[72];
+    size_t pos = sizeof(body);
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        body[--pos] = digits[magnitude % (unsigned long)base];
+        magnitude /= (unsigned long)base;
+    } while (magnitude != 0);
+    const char *sign = value < 0 ? "-" : (plus ? "+" : "");
+    return rt_format_pad(sign, body + pos, sizeof(body) - pos, width, fill, align);
+}
+
+static const double rt_format_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+char *rt_format_double(double value, long precision, long plus, long width, long fill, long align)
+{
+    char body[512];
+    size_t len = 0;
+    const char *sign = signbit(value) ? "-" : (plus ? "+" : "");
+    double magnitude = signbit(value) ? -value : value;
+    if (isnan(value) || isinf(value)) {
+        memcpy(body, isnan(value) ? "nan" : "inf", 3);
+        len = 3;
+    } else {
+        int exact = 0;
+        if (precision <= 15) {
+            double scaled = magnitude * rt_format_pow10[precision];
+            uint64_t units = scaled < 9007199254740992.0 ? (uint64_t)scaled : 0;
+            double distance = scaled - (double)units - 0.5;
+            // The product is within half an ulp of the exact value, so the
+            // rounding direction is certain unless it sits that close to a tie.
+            if (scaled < 9007199254740992.0 && (distance < 0 ? -distance : distance) > scaled * DBL_EPSILON) {
+                units += distance > 0 ? 1 : 0;
+                char reversed[40];
+                for (long i = 0; i < precision; i++) {
+                    reversed[len++] = (char)('0' + units % 10);
+                    units /= 10;
+                }
+                if (precision > 0) {
+                    reversed[len++] = '.';
+                }
+                do {
+                    reversed[len++] = (char)('0' + units % 10);
+                    units /= 10;
+                } while (units != 0);
+                for (size_t i = 0; i < len; i++) {
+                    body[i] = reversed[len - 1 - i];
+                }
+                exact = 1;
+            }
+        }
+        if (!exact) {
+            int written = snprintf(body, sizeof(body), "%.*f", (int)precision, magnitude);
+            len = written < 0 ? 0 : (size_t)written;
+        }
+    }
+    return rt_format_pad(sign, body, len, width, fill, align);
+}
+
+char *rt_format_string(const char *value, long precision, long width, long fill, long align)
+{
+    const char *s = value ? value : null_str;
+    size_t len = strlen(s);
+    if (precision >= 0 && (size_t)precision < len) {
+        len = (size_t)precision;
+    }
+    return rt_format_pad("", s, len, width, fill, align);
+}
+
+char *rt_format_char(long value, long width, long fill, long align)
+{
+    char c = (char)value;
+    return rt_format_pad("", &c, 1, width, fill, align);
+}
+
+/* ---------------------------------------------------------------------------
+ * Memo tables
+ *
+ * Entries live in a dense slab; an open-addressing index of slot -> entry
+ * (linear probing, power-of-two size, at most half full) finds them by hash.
+ * Entries are threaded on a doubly linked LRU list so a bounded table can
+ * evict its least recently used entry. Deletion uses backward-shift so the
+ * index never needs tombstones.
+ * ------------------------------------------------------------------------- */
+
+#define RT_MEMO_EMPTY (-1)
+
+typedef struct
+{
+    uint64_t hash;
+    RtValue *key;
+    RtValue value;
+    long prev; /* towards most recently used */
+    long next; /* towards least recently used */
+} RtMemoEntry;
+
+struct RtMemo
+{
+    long arity;
+    long str_mask;
+    long str_result;
+    long max_entries;
+    RtMemoEntry *entries;
+    long count;
+    long capacity;
+    long *slots;
+    long slot_mask;
+    long head; /* most recently used */
+    long tail; /* least recently used */
+};
+
+static void *rt_memo_alloc(size_t size)
+{
+    void *p = malloc(size);
+    if (p == NULL)
+    {
+        fprintf(stderr, "rt_memo: out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+static char *rt_memo_strdup(const char *s)
+{
+    size_t len = strlen(s);
+    char *copy = rt_memo_alloc(len + 1);
+    memcpy(copy, s, len + 1);
+    return copy;
+}
+
+static uint64_t rt_hash_long(uint64_t x)
+{
+    /* splitmix64 finaliser */
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t rt_hash_string(const char *s)
+{
+    /* FNV-1a */
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (; *s; s++)
+    {
+        h ^= (unsigned char)*s;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+unsigned long rt_str_hash_seeded(unsigned long seed, const char *s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (; *s; s++)
+    {
+        h ^= (unsigned char)*s;
+        h *= 0x100000001b3ULL;
+    }
+    return (unsigned long)rt_hash_long(h);
+}
+
+static uint64_t rt_memo_hash(RtMemo *memo, RtValue *key)
+{
+    uint64_t h = 0;
+    for (long i = 0; i < memo->arity; i++)
+    {
+        uint64_t part = (memo->str_mask >> i) & 1 ? rt_hash_string(key[i].s ? key[i].s : "")
+                                                  : rt_hash_long((uint64_t)key[i].l);
+        h = rt_hash_long(h ^ part);
+    }
+    return h;
+}
+
+static int rt_memo_key_equals(RtMemo *memo, RtValue *a, RtValue *b)
+{
+    for (long i = 0; i < memo->arity; i++)
+    {
+        if ((memo->str_mask >> i) & 1)
+        {
+            const char *x = a[i].s ? a[i].s : "";
+            const char *y = b[i].s ? b[i].s : "";
+            if (strcmp(x, y) != 0)
+                return 0;
+        }
+        else if (a[i].l != b[i].l)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void rt_memo_lru_unlink(RtMemo *memo, long index)
+{
+    RtMemoEntry *e = &memo->entries[index];
+    if (e->prev != RT_MEMO_EMPTY)
+        memo->entries[e->prev].next = e->next;
+    else
+        memo->head = e->next;
+    if (e->next != RT_MEMO_EMPTY)
+        memo->entries[e->next].prev = e->prev;
+    else
+        memo->tail = e->prev;
+}
+
+static void rt_memo_lru_push_front(RtMemo *memo, long index)
+{
+    RtMemoEntry *e = &memo->entries[index];
+    e->prev = RT_MEMO_EMPTY;
+    e->next = memo->head;
+    if (memo->head != RT_MEMO_EMPTY)
+        memo->entries[memo->head].prev = index;
+    memo->head = index;
+    if (memo->tail == RT_MEMO_EMPTY)
+        memo->tail = index;
+}
+
+static void rt_memo_resize_slots(RtMemo *memo, long slot_count)
+{
+    free(memo->slots);
+    memo->slots = rt_memo_alloc(sizeof(long) * slot_count);
+    memo->slot_mask = slot_count - 1;
+    for (long i = 0; i < slot_count; i++)
+        memo->slots[i] = RT_MEMO_EMPTY;
+    for (long i = 0; i < memo->count; i++)
+    {
+        long slot = (long)(memo->entries[i].hash & memo->slot_mask);
+        while (memo->slots[slot] != RT_MEMO_EMPTY)
+            slot = (slot + 1) & memo->slot_mask;
+        memo->slots[slot] = i;
+    }
+}
+
+static long rt_memo_find_slot(RtMemo *memo, uint64_t hash, RtValue *key)
+{
+    long slot = (long)(hash & memo->slot_mask);
+    while (memo->slots[slot] != RT_MEMO_EMPTY)
+    {
+        RtMemoEntry *e = &memo->entries[memo->slots[slot]];
+        if (e->hash == hash && rt_memo_key_equals(memo, e->key, key))
+            return slot;
+        slot = (slot + 1) & memo->slot_mask;
+    }
+    return RT_MEMO_EMPTY;
+}
+
+static void rt_memo_remove_slot(RtMemo *memo, long slot)
+{
+    /* Backward-shift deletion: pull later members of the probe run into the hole. */
+    long hole = slot;
+    long next = (hole + 1) & memo->slot_mask;
+    while (memo->slots[next] != RT_MEMO_EMPTY)
+    {
+        long home = (long)(memo->entries[memo->slots[next]].hash & memo->slot_mask);
+        if (((next - home) & memo->slot_mask) >= ((next - hole) & memo->slot_mask))
+        {
+            memo->slots[hole] = memo->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & memo->slot_mask;
+    }
+    memo->slots[hole] = RT_MEMO_EMPTY;
+}
+
+static void rt_memo_release_entry(RtMemo *memo, RtMemoEntry *e)
+{
+    for (long i = 0; i < memo->arity; i++)
+    {
+        if ((memo->str_mask >> i) & 1)
+            free(e->key[i].s);
+    }
+    if (memo->str_result)
+        free(e->value.s);
+}
+
+RtMemo *rt_memo_create(long arity, long str_mask, long str_result, long max_entries)
+{
+    RtMemo *memo = rt_memo_alloc(sizeof(RtMemo));
+    memo->arity = arity;
+    memo->str_mask = str_mask;
+    memo->str_result = str_result;
+    memo->max_entries = max_entries > 0 ? max_entries : 0;
+    memo->capacity = memo->max_entries > 0 && memo->max_entries < 64 ? memo->max_entries : 64;
+    memo->entries = rt_memo_alloc(sizeof(RtMemoEntry) * memo->capacity);
+    memo->count = 0;
+    memo->slots = NULL;
+    memo->head = RT_MEMO_EMPTY;
+    memo->tail = RT_MEMO_EMPTY;
+    long slot_count = 16;
+    while (slot_count < memo->capacity * 2)
+        slot_count *= 2;
+    rt_memo_resize_slots(memo, slot_count);
+    return memo;
+}
+
+long rt_memo_get(RtMemo *memo, RtValue *key, RtValue *out)
+{
+    long slot = rt_memo_find_slot(memo, rt_memo_hash(memo, key), key);
+    if (slot == RT_MEMO_EMPTY)
+        return 0;
+    long index = memo->slots[slot];
+    if (memo->max_entries > 0 && memo->head != index)
+    {
+        rt_memo_lru_unlink(memo, index);
+        rt_memo_lru_push_front(memo, index);
+    }
+    /* Callers own string results, so hand out a copy of the cached one. */
+    *out = memo->entries[index].value;
+    if (memo->str_result && out->s != NULL)
+        out->s = rt_memo_strdup(out->s);
+    return 1;
+}
+
+void rt_memo_put(RtMemo *memo, RtValue *key, RtValue value)
+{
+    uint64_t hash = rt_memo_hash(memo, key);
+    if (rt_memo_find_slot(memo, hash, key) != RT_MEMO_EMPTY)
+        return;
+
+    long index;
+    if (memo->max_entries > 0 && memo->count == memo->max_entries)
+    {
+        /* Evict the least recently used entry and reuse its slab position. */
+        index = memo->tail;
+        RtMemoEntry *victim = &memo->entries[index];
+        rt_memo_remove_slot(memo, rt_memo_find_slot(memo, victim->hash, victim->key));
+        rt_memo_lru_unlink(memo, index);
+        rt_memo_release_entry(memo, victim);
+    }
+    else
+    {
+        if (memo->count == memo->capacity)
+        {
+            long new_capacity = memo->capacity * 2;
+            if (memo->max_entries > 0 && new_capacity > memo->max_entries)
+                new_capacity = memo->max_entries;
+            RtMemoEntry *entries = realloc(memo->entries, sizeof(RtMemoEntry) * new_capacity);
+            if (entries == NULL)
+            {
+                fprintf(stderr, "rt_memo: out of memory\n");
+                exit(1);
+            }
+            memo->entries = entries;
+            memo->capacity = new_capacity;
+        }
+        if ((memo->count + 1) * 2 > memo->slot_mask + 1)
+            rt_memo_resize_slots(memo, (memo->slot_mask + 1) * 2);
+        index = memo->count++;
+        memo->entries[index].key = rt_memo_alloc(sizeof(RtValue) * (memo->arity > 0 ? memo->arity : 1));
+    }
+
+    RtMemoEntry *e = &memo->entries[index];
+    e->hash = hash;
+    for (long i = 0; i < memo->arity; i++)
+    {
+        e->key[i] = key[i];
+        if ((memo->str_mask >> i) & 1)
+            e->key[i].s = rt_memo_strdup(key[i].s ? key[i].s : "");
+    }
+    e->value = value;
+    if (memo->str_result && value.s != NULL)
+        e->value.s = rt_memo_strdup(value.s);
+    rt_memo_lru_push_front(memo, index);
+
+    long slot = (long)(hash & memo->slot_mask);
+    while (memo->slots[slot] != RT_MEMO_EMPTY)
+        slot = (slot + 1) & memo->slot_mask;
+    memo->slots[slot] = index;
+}
+
+/* ---------------------------------------------------------------------------
+ * Maps
+ *
+ * Entries (key, value and the key's full hash) are stored densely, so
+ * key_at/value_at iteration is an array walk and removal swaps the last entry
+ * into the hole. A SwissTable-style index sits beside them: one control byte
+ * per bucket holds EMPTY, DELETED or the low 7 bits of the hash, and probing
+ * compares a whole group of 16 control bytes at once (SSE2 when available).
+ * Hashes are cached per entry, so a string key is hashed once on insert and
+ * rehashing never touches the keys.
+ * ------------------------------------------------------------------------- */
+
+#define RT_MAP_GROUP 16
+#define RT_MAP_CTRL_EMPTY ((int8_t)-128)
+#define RT_MAP_CTRL_DELETED ((int8_t)-2)
+
+struct RtMap
+{
+    long str_keys;
+    long str_values;
+    RtValue *keys;
+    RtValue *values;
+    uint64_t *hashes;
+    long count;
+    long entry_capacity;
+    int8_t *ctrl;  /* bucket count + RT_MAP_GROUP bytes; the tail mirrors the first group */
+    long *buckets; /* entry index for each full bucket */
+    long bucket_mask;
+    long tombstones;
+};
+
+static uint32_t rt_map_group_match(const int8_t *group, int8_t h2)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < RT_MAP_GROUP; i++)
+    {
+        if (group[i] == h2)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/* EMPTY and DELETED are the only negative control bytes. */
+static uint32_t rt_map_group_match_free(const int8_t *group)
+{
+#if defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < RT_MAP_GROUP; i++)
+    {
+        if (group[i] < 0)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+static uint64_t rt_map_hash(RtMap *map, RtValue key)
+{
+    if (map->str_keys)
+        return rt_hash_long(rt_hash_string(key.s ? key.s : ""));
+    return rt_hash_long((uint64_t)key.l);
+}
+
+static int rt_map_key_equals(RtMap *map, RtValue a, RtValue b)
+{
+    if (map->str_keys)
+        return strcmp(a.s ? a.s : "", b.s ? b.s : "") == 0;
+    return a.l == b.l;
+}
+
+static void rt_map_set_ctrl(RtMap *map, long bucket, int8_t value)
+{
+    map->ctrl[bucket] = value;
+    if (bucket < RT_MAP_GROUP)
+        map->ctrl[map->bucket_mask + 1 + bucket] = value;
+}
+
+/* Probe groups at triangular offsets; with a power-of-two bucket count this
+ * visits every group before repeating. */
+static long rt_map_find_bucket(RtMap *map, uint64_t hash, RtValue key)
+{
+    int8_t h2 = (int8_t)(hash & 0x7f);
+    long pos = (long)(hash >> 7) & map->bucket_mask;
+    for (long step = RT_MAP_GROUP;; step += RT_MAP_GROUP)
+    {
+        const int8_t *group = map->ctrl + pos;
+        uint32_t match = rt_map_group_match(group, h2);
+        while (match)
+        {
+            long bucket = (pos + __builtin_ctz(match)) & map->bucket_mask;
+            long index = map->buckets[bucket];
+            if (map->hashes[index] == hash && rt_map_key_equals(map, map->keys[index], key))
+                return bucket;
+            match &= match - 1;
+        }
+        if (rt_map_group_match(group, RT_MAP_CTRL_EMPTY))
+            return -1;
+        pos = (pos + step) & map->bucket_mask;
+    }
+}
+
+static long rt_map_find_bucket_of_index(RtMap *map, long index)
+{
+    uint64_t hash = map->hashes[index];
+    int8_t h2 = (int8_t)(hash & 0x7f);
+    long pos = (long)(hash >> 7) & map->bucket_mask;
+    for (long step = RT_MAP_GROUP;; step += RT_MAP_GROUP)
+    {
+        uint32_t match = rt_map_group_match(map->ctrl + pos, h2);
+        while (match)
+        {
+            long bucket = (pos + __builtin_ctz(match)) & map->bucket_mask;
+            if (map->buckets[bucket] == index)
+                return bucket;
+            match &= match - 1;
+        }
+        pos = (pos + step) & map->bucket_mask;
+    }
+}
+
+static long rt_map_find_free_bucket(RtMap *map, uint64_t hash)
+{
+    long pos = (long)(hash >> 7) & map->bucket_mask;
+    for (long step = RT_MAP_GROUP;; step += RT_MAP_GROUP)
+    {
+        uint32_t free_mask = rt_map_group_match_free(map->ctrl + pos);
+        if (free_mask)
+            return (pos + __builtin_ctz(free_mask)) & map->bucket_mask;
+        pos = (pos + step) & map->bucket_mask;
+    }
+}
+
+static void rt_map_rehash(RtMap *map, long bucket_count)
+{
+    free(map->ctrl);
+    free(map->buckets);
+    map->ctrl = rt_memo_alloc(bucket_count + RT_MAP_GROUP);
+    map->buckets = rt_memo_alloc(sizeof(long) * bucket_count);
+    map->bucket_mask = bucket_count - 1;
+    map->tombstones = 0;
+    memset(map->ctrl, (unsigned char)RT_MAP_CTRL_EMPTY, bucket_count + RT_MAP_GROUP);
+    for (long i = 0; i < map->count; i++)
+    {
+        long bucket = rt_map_find_free_bucket(map, map->hashes[i]);
+        rt_map_set_ctrl(map, bucket, (int8_t)(map->hashes[i] & 0x7f));
+        map->buckets[bucket] = i;
+    }
+}
+
+static RtValue rt_map_copy_value(long is_str, RtValue value)
+{
+    if (is_str)
+        value.s = rt_memo_strdup(value.s ? value.s : "");
+    return value;
+}
+
+RtMap *rt_map_create(long str_keys, long str_values)
+{
+    RtMap *map = rt_memo_alloc(sizeof(RtMap));
+    map->str_keys = str_keys;
+    map->str_values = str_values;
+    map->entry_capacity = 8;
+    map->keys = rt_memo_alloc(sizeof(RtValue) * map->entry_capacity);
+    map->values = rt_memo_alloc(sizeof(RtValue) * map->entry_capacity);
+    map->hashes = rt_memo_alloc(sizeof(uint64_t) * map->entry_capacity);
+    map->count = 0;
+    map->ctrl = NULL;
+    map->buckets = NULL;
+    rt_map_rehash(map, RT_MAP_GROUP);
+    return map;
+}
+
+void rt_map_free(RtMap *map)
+{
+    if (map == NULL)
+        return;
+    for (long i = 0; i < map->count; i++)
+    {
+        if (map->str_keys)
+            free(map->keys[i].s);
+        if (map->str_values)
+            free(map->values[i].s);
+    }
+    free(map->keys);
+    free(map->values);
+    free(map->hashes);
+    free(map->ctrl);
+    free(map->buckets);
+    free(map);
+}
+
+long rt_map_length(RtMap *map)
+{
+    return map->count;
+}
+
+long rt_map_contains(RtMap *map, RtValue key)
+{
+    return rt_map_find_bucket(map, rt_map_hash(map, key), key) >= 0;
+}
+
+RtValue rt_map_get(RtMap *map, RtValue key)
+{
+    long bucket = rt_map_find_bucket(map, rt_map_hash(map, key), key);
+    if (bucket < 0)
+    {
+        fprintf(stderr, "rt_map_get: key not found\n");
+        exit(1);
+    }
+    return rt_map_copy_value(map->str_values, map->values[map->buckets[bucket]]);
+}
+
+void rt_map_set(RtMap *map, RtValue key, RtValue value)
+{
+    uint64_t hash = rt_map_hash(map, key);
+    long bucket = rt_map_find_bucket(map, hash, key);
+    if (bucket >= 0)
+    {
+        long index = map->buckets[bucket];
+        if (map->str_values)
+            free(map->values[index].s);
+        map->values[index] = rt_map_copy_value(map->str_values, value);
+        return;
+    }
+
+    long bucket_count = map->bucket_mask + 1;
+    if ((map->count + map->tombstones + 1) * 8 > bucket_count * 7)
+    {
+        /* Grow when genuinely full, otherwise just clear out tombstones. */
+        rt_map_rehash(map, (map->count + 1) * 2 > bucket_count ? bucket_count * 2 : bucket_count);
+    }
+    if (map->count == map->entry_capacity)
+    {
+        long new_capacity = map->entry_capacity * 2;
+        RtValue *keys = realloc(map->keys, sizeof(RtValue) * new_capacity);
+        RtValue *values = keys ? realloc(map->values, sizeof(RtValue) * new_capacity) : NULL;
+        uint64_t *hashes = values ? realloc(map->hashes, sizeof(uint64_t) * new_capacity) : NULL;
+        if (hashes == NULL)
+        {
+            fprintf(stderr, "rt_map_set: out of memory\n");
+            exit(1);
+        }
+        map->keys = keys;
+        map->values = values;
+        map->hashes = hashes;
+        map->entry_capacity = new_capacity;
+    }
+
+    long index = map->count++;
+    map->keys[index] = rt_map_copy_value(map->str_keys, key);
+    map->values[index] = rt_map_copy_value(map->str_values, value);
+    map->hashes[index] = hash;
+
+    bucket = rt_map_find_free_bucket(map, hash);
+    if (map->ctrl[bucket] == RT_MAP_CTRL_DELETED)
+        map->tombstones--;
+    rt_map_set_ctrl(map, bucket, (int8_t)(hash & 0x7f));
+    map->buckets[bucket] = index;
+}
+
+long rt_map_remove(RtMap *map, RtValue key)
+{
+    long bucket = rt_map_find_bucket(map, rt_map_hash(map, key), key);
+    if (bucket < 0)
+        return 0;
+    long index = map->buckets[bucket];
+    if (map->str_keys)
+        free(map->keys[index].s);
+    if (map->str_values)
+        free(map->values[index].s);
+    rt_map_set_ctrl(map, bucket, RT_MAP_CTRL_DELETED);
+    map->tombstones++;
+
+    long last = map->count - 1;
+    if (index != last)
+    {
+        map->buckets[rt_map_find_bucket_of_index(map, last)] = index;
+        map->keys[index] = map->keys[last];
+        map->values[index] = map->values[last];
+        map->hashes[index] = map->hashes[last];
+    }
+    map->count--;
+    return 1;
+}
+
+RtValue rt_map_key_at(RtMap *map, long index)
+{
+    if (index < 0 || index >= map->count)
+    {
+        fprintf(stderr, "rt_map_key_at: index out of range\n");
+        exit(1);
+    }
+    return rt_map_copy_value(map->str_keys, map->keys[index]);
+}
+
+RtValue rt_map_value_at(RtMap *map, long index)
+{
+    if (index < 0 || index >= map->count)
+    {
+        fprintf(stderr, "rt_map_value_at: index out of range\n");
+        exit(1);
+    }
+    return rt_map_copy_value(map->str_values, map->values[index]);
+}
+
+/* ---------------------------------------------------------------------------
+ * Benchmark harness
+ *
+ * A bench body is warmed up, then its batch size is doubled until one batch
+ * takes at least RT_BENCH_SAMPLE_NS. Up to RT_BENCH_SAMPLES batches are timed
+ * with the monotonic clock, stopping early once RT_BENCH_BUDGET_NS is spent,
+ * and reported as per-iteration statistics.
+ * ------------------------------------------------------------------------- */
+
+#define RT_BENCH_WARMUP_NS 50e6
+#define RT_BENCH_SAMPLE_NS 1e6
+#define RT_BENCH_BUDGET_NS 2e9
+#define RT_BENCH_SAMPLES 100
+#define RT_BENCH_MIN_SAMPLES 10
+
+static double rt_bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* The empty asm is a compiler barrier: calls cannot be merged, hoisted out of
+ * the loop or dropped even if the body ends up inlined. */
+static double rt_bench_batch(void (*body)(void), long iterations)
+{
+    double start = rt_bench_now_ns();
+    for (long i = 0; i < iterations; i++)
+    {
+        body();
+        __asm__ __volatile__("" ::: "memory");
+    }
+    return rt_bench_now_ns() - start;
+}
+
+static int rt_bench_compare(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void rt_bench_print_json_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf(out, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(out, "\\u%04x", c);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static FILE *rt_bench_output = NULL;
+
+void rt_bench_set_output(FILE *out)
+{
+    rt_bench_output = out;
+}
+
+long rt_bench_requested(void)
+{
+    return getenv("SN_BENCH") != NULL;
+}
+
+void rt_bench_run(const char *name, void (*body)(void))
+{
+    const char *filter = getenv("SN_BENCH");
+    if (filter != NULL && filter[0] != '\0' && strcmp(filter, "all") != 0 && strstr(name, filter) == NULL)
+    {
+        return;
+    }
+
+    double warmup_start = rt_bench_now_ns();
+    do
+    {
+        rt_bench_batch(body, 1);
+    } while (rt_bench_now_ns() - warmup_start < RT_BENCH_WARMUP_NS);
+
+    long iterations = 1;
+    while (iterations < (1L << 40) && rt_bench_batch(body, iterations) < RT_BENCH_SAMPLE_NS)
+    {
+        iterations *= 2;
+    }
+
+    double samples[RT_BENCH_SAMPLES];
+    int count = 0;
+    double spent = 0.0;
+    double sum = 0.0;
+    while (count < RT_BENCH_SAMPLES && (count < RT_BENCH_MIN_SAMPLES || spent < RT_BENCH_BUDGET_NS))
+    {
+        double elapsed = rt_bench_batch(body, iterations);
+        spent += elapsed;
+        samples[count] = elapsed / (double)iterations;
+        sum += samples[count];
+        count++;
+    }
+    qsort(samples, (size_t)count, sizeof(double), rt_bench_compare);
+    double median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+    double p99 = samples[(99 * count + 99) / 100 - 1]; /* nearest rank */
+    double mean = sum / count;
+
+    FILE *out = rt_bench_output != NULL ? rt_bench_output : stdout;
+    const char *format = getenv("SN_BENCH_FORMAT");
+    if (format != NULL && strcmp(format, "json") == 0)
+    {
+        fprintf(out, "{\"name\": ");
+        rt_bench_print_json_string(out, name);
+        fprintf(out, ", \"samples\": %d, \"iterations\": %ld, \"median_ns\": %.2f, \"p99_ns\": %.2f, "
+               "\"min_ns\": %.2f, \"max_ns\": %.2f, \"mean_ns\": %.2f}\n",
+               count, iterations, median, p99, samples[0], samples[count - 1], mean);
+    }
+    else
+    {
+        fprintf(out, "bench %-28s median %12.2f ns  p99 %12.2f ns  min %12.2f ns  (%d x %ld iterations)\n",
+               name, median, p99, samples[0], count, iterations);
+    }
+    fflush(out);
+}
+
+/* ---------------------------------------------------------------------------
+ * Function profiler (--instrument)
+ *
+ * A shadow stack mirrors the instrumented calls. On exit a frame's elapsed
+ * ticks, minus the ticks of the calls it made, are its self time; its full
+ * elapsed time counts towards the function's total only for the outermost
+ * activation, so recursion is not counted twice. Caller/callee edges live in a
+ * linear-probing table indexed by pointer hash, and each frame remembers the
+ * last edge it used, so a loop calling the same function skips the probe.
+ * Ticks are TSC cycles on x86 and monotonic nanoseconds elsewhere.
+ * ------------------------------------------------------------------------- */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RT_PROF_UNIT "TSC cycles"
+#else
+#define RT_PROF_UNIT "ns"
+#endif
+
+struct RtProfFunction
+{
+    const char *name;
+    unsigned long long calls;
+    unsigned long long self_ticks;
+    unsigned long long total_ticks;
+    long active; /* frames of this function currently on the stack */
+    RtProfFunction *next;
+};
+
+typedef struct
+{
+    RtProfFunction *caller; /* NULL for calls from outside instrumented code */
+    RtProfFunction *callee;
+    unsigned long long calls;
+    unsigned long long ticks; /* callee's outermost activations from this caller */
+} RtProfEdge;
+
+typedef struct
+{
+    RtProfFunction *fn;
+    long edge;
+    long last_callee_edge; /* edge of this frame's most recent call, or -1 */
+    unsigned long long start;
+    unsigned long long child_ticks;
+} RtProfFrame;
+
+static RtProfFunction *rt_prof_functions = NULL;
+static long rt_prof_function_count = 0;
+static RtProfFrame *rt_prof_stack = NULL;
+static long rt_prof_depth = 0;
+static long rt_prof_stack_capacity = 0;
+static RtProfEdge *rt_prof_edges = NULL;
+static long rt_prof_edge_mask = -1;
+static long rt_prof_edge_count = 0;
+
+static inline unsigned long long rt_prof_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+static void *rt_prof_alloc(size_t size)
+{
+    void *p = calloc(1, size);
+    if (p == NULL)
+    {
+        fprintf(stderr, "rt_prof: out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+static uint64_t rt_prof_edge_hash(RtProfFunction *caller, RtProfFunction *callee)
+{
+    return rt_hash_long((uint64_t)(uintptr_t)caller * 31 + (uint64_t)(uintptr_t)callee);
+}
+
+static long rt_prof_find_edge(RtProfFunction *caller, RtProfFunction *callee)
+{
+    long slot = (long)(rt_prof_edge_hash(caller, callee) & (uint64_t)rt_prof_edge_mask);
+    while (rt_prof_edges[slot].callee != NULL &&
+           (rt_prof_edges[slot].caller != caller || rt_prof_edges[slot].callee != callee))
+    {
+        slot = (slot + 1) & rt_prof_edge_mask;
+    }
+    return slot;
+}
+
+/* Keeps the table at most half full. Edge indices held by frames are
+ * remapped, since they point into the old table. */
+static void rt_prof_grow_edges(void)
+{
+    RtProfEdge *old_edges = rt_prof_edges;
+    long old_size = rt_prof_edge_mask + 1;
+    long size = old_size > 0 ? old_size * 2 : 256;
+    rt_prof_edges = rt_prof_alloc(sizeof(RtProfEdge) * (size_t)size);
+    rt_prof_edge_mask = size - 1;
+    for (long i = 0; i < old_size; i++)
+    {
+        if (old_edges[i].callee != NULL)
+        {
+            rt_prof_edges[rt_prof_find_edge(old_edges[i].caller, old_edges[i].callee)] = old_edges[i];
+        }
+    }
+    for (long i = 0; i < rt_prof_depth; i++)
+    {
+        RtProfFrame *frame = &rt_prof_stack[i];
+        frame->edge = rt_prof_find_edge(old_edges[frame->edge].caller, old_edges[frame->edge].callee);
+        frame->last_callee_edge = -1;
+    }
+    free(old_edges);
+}
+
+static long rt_prof_edge(RtProfFrame *caller_frame, RtProfFunction *callee)
+{
+    RtProfFunction *caller = caller_frame != NULL ? caller_frame->fn : NULL;
+    if (caller_frame != NULL && caller_frame->last_callee_edge >= 0 &&
+        rt_prof_edges[caller_frame->last_callee_edge].callee == callee)
+    {
+        return caller_frame->last_callee_edge;
+    }
+    if ((rt_prof_edge_count + 1) * 2 > rt_prof_edge_mask + 1)
+    {
+        rt_prof_grow_edges();
+    }
+    long slot = rt_prof_find_edge(caller, callee);
+    if (rt_prof_edges[slot].callee == NULL)
+    {
+        rt_prof_edges[slot].caller = caller;
+        rt_prof_edges[slot].callee = callee;
+        rt_prof_edge_count++;
+    }
+    if (caller_frame != NULL)
+    {
+        caller_frame->last_callee_edge = slot;
+    }
+    return slot;
+}
+
+static void rt_prof_report(void);
+
+static RtProfFunction *rt_prof_register(const char *name)
+{
+    if (rt_prof_function_count == 0)
+    {
+        atexit(rt_prof_report);
+    }
+    RtProfFunction *fn = rt_prof_alloc(sizeof(RtProfFunction));
+    fn->name = name;
+    fn->next = rt_prof_functions;
+    rt_prof_functions = fn;
+    rt_prof_function_count++;
+    return fn;
+}
+
+void rt_prof_enter(RtProfFunction **slot, const char *name)
+{
+    RtProfFunction *fn = *slot;
+    if (fn == NULL)
+    {
+        fn = *slot = rt_prof_register(name);
+    }
+    if (rt_prof_depth == rt_prof_stack_capacity)
+    {
+        rt_prof_stack_capacity = rt_prof_stack_capacity > 0 ? rt_prof_stack_capacity * 2 : 64;
+        rt_prof_stack = realloc(rt_prof_stack, sizeof(RtProfFrame) * (size_t)rt_prof_stack_capacity);
+        if (rt_prof_stack == NULL)
+        {
+            fprintf(stderr, "rt_prof: out of memory\n");
+            exit(1);
+        }
+    }
+    long edge = rt_prof_edge(rt_prof_depth > 0 ? &rt_prof_stack[rt_prof_depth - 1] : NULL, fn);
+    rt_prof_edges[edge].calls++;
+    fn->calls++;
+    fn->active++;
+    RtProfFrame *frame = &rt_prof_stack[rt_prof_depth++];
+    frame->fn = fn;
+    frame->edge = edge;
+    frame->last_callee_edge = -1;
+    frame->child_ticks = 0;
+    /* Read last so the bookkeeping above is charged to the caller. */
+    frame->start = rt_prof_ticks();
+}
+
+static void rt_prof_pop(unsigned long long now)
+{
+    RtProfFrame *frame = &rt_prof_stack[--rt_prof_depth];
+    unsigned long long elapsed = now - frame->start;
+    RtProfFunction *fn = frame->fn;
+    fn->self_ticks += elapsed > frame->child_ticks ? elapsed - frame->child_ticks : 0;
+    if (--fn->active == 0)
+    {
+        fn->total_ticks += elapsed;
+        rt_prof_edges[frame->edge].ticks += elapsed;
+    }
+    if (rt_prof_depth > 0)
+    {
+        rt_prof_stack[rt_prof_depth - 1].child_ticks += elapsed;
+    }
+}
+
+void rt_prof_exit(void)
+{
+    unsigned long long now = rt_prof_ticks();
+    if (rt_prof_depth > 0)
+    {
+        rt_prof_pop(now);
+    }
+}
+
+static int rt_prof_compare_self(const void *a, const void *b)
+{
+    const RtProfFunction *x = *(RtProfFunction *const *)a;
+    const RtProfFunction *y = *(RtProfFunction *const *)b;
+    if (x->self_ticks != y->self_ticks)
+        return x->self_ticks < y->self_ticks ? 1 : -1;
+    return strcmp(x->name, y->name);
+}
+
+static int rt_prof_compare_edges(const void *a, const void *b)
+{
+    const RtProfEdge *x = *(RtProfEdge *const *)a;
+    const RtProfEdge *y = *(RtProfEdge *const *)b;
+    if (x->ticks != y->ticks)
+        return x->ticks < y->ticks ? 1 : -1;
+    if (x->calls != y->calls)
+        return x->calls < y->calls ? 1 : -1;
+    return strcmp(x->callee->name, y->callee->name);
+}
+
+static FILE *rt_prof_open(const char *suffix)
+{
+    const char *prefix = getenv("SN_PROF_OUT");
+    if (prefix == NULL || prefix[0] == '\0')
+    {
+        prefix = "sn-prof";
+    }
+    size_t length = strlen(prefix) + strlen(suffix) + 1;
+    char *path = rt_prof_alloc(length);
+    snprintf(path, length, "%s%s", prefix, suffix);
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "rt_prof: cannot write %s\n", path);
+    }
+    free(path);
+    return out;
+}
+
+/* Runs at exit. Frames still open (exit() called below main) are closed at
+ * the current time so their functions still get their ticks. */
+static void rt_prof_report(void)
+{
+    unsigned long long now = rt_prof_ticks();
+    while (rt_prof_depth > 0)
+    {
+        rt_prof_pop(now);
+    }
+
+    RtProfFunction **functions = rt_prof_alloc(sizeof(RtProfFunction *) * (size_t)rt_prof_function_count);
+    unsigned long long all_self = 0;
+    long n = 0;
+    for (RtProfFunction *fn = rt_prof_functions; fn != NULL; fn = fn->next)
+    {
+        functions[n++] = fn;
+        all_self += fn->self_ticks;
+    }
+    qsort(functions, (size_t)n, sizeof(RtProfFunction *), rt_prof_compare_self);
+
+    FILE *flat = rt_prof_open(".flat.txt");
+    if (flat != NULL)
+    {
+        fprintf(flat, "# flat profile, times in %s, sorted by self time\n", RT_PROF_UNIT);
+        fprintf(flat, "%7s %16s %16s %12s %12s %12s  %s\n", "% self", "self", "total", "calls", "self/call",
+                "total/call", "name");
+        for (long i = 0; i < n; i++)
+        {
+            RtProfFunction *fn = functions[i];
+            double calls = fn->calls > 0 ? (double)fn->calls : 1.0;
+            fprintf(flat, "%7.2f %16llu %16llu %12llu %12.1f %12.1f  %s\n",
+                    all_self > 0 ? 100.0 * (double)fn->self_ticks / (double)all_self : 0.0, fn->self_ticks,
+                    fn->total_ticks, fn->calls, (double)fn->self_ticks / calls, (double)fn->total_ticks / calls,
+                    fn->name);
+        }
+        fclose(flat);
+    }
+
+    RtProfEdge **edges = rt_prof_alloc(sizeof(RtProfEdge *) * (size_t)(rt_prof_edge_count > 0 ? rt_prof_edge_count : 1));
+    long edge_count = 0;
+    for (long i = 0; i <= rt_prof_edge_mask; i++)
+    {
+        if (rt_prof_edges[i].callee != NULL)
+        {
+            edges[edge_count++] = &rt_prof_edges[i];
+        }
+    }
+    qsort(edges, (size_t)edge_count, sizeof(RtProfEdge *), rt_prof_compare_edges);
+
+    FILE *graph = rt_prof_open(".callgraph.txt");
+    if (graph != NULL)
+    {
+        fprintf(graph, "# call graph, one caller -> callee edge per line, times in %s\n", RT_PROF_UNIT);
+        fprintf(graph, "# ticks are the callee's total time when called from this caller (0 for recursive calls)\n");
+        fprintf(graph, "%-32s %-32s %12s %16s\n", "caller", "callee", "calls", "ticks");
+        for (long i = 0; i < edge_count; i++)
+        {
+            fprintf(graph, "%-32s %-32s %12llu %16llu\n", edges[i]->caller != NULL ? edges[i]->caller->name : "<root>",
+                    edges[i]->callee->name, edges[i]->calls, edges[i]->ticks);
+        }
+        fclose(graph);
+    }
+
+    free(functions);
+    free(edges);
+}
+
+/* ---------------------------------------------------------------------------
+ * Trace recorder (--trace)
+ *
+ * Open spans sit on a stack; a span that completes is stored as one Chrome
+ * "complete" event (ph "X": start and duration), so overwriting the oldest
+ * entries of the ring buffer never leaves an unmatched begin or end. Only
+ * spans that pass the filter and sampling are pushed, which is what makes the
+ * depth returned by rt_trace_begin enough to rebalance the stack.
+ * A site's slot is 0 until first use, -1 when filtered out, and otherwise one
+ * more than the number of calls seen there.
+ * ------------------------------------------------------------------------- */
+
+#define RT_TRACE_DEFAULT_BUFFER 262144
+
+typedef struct
+{
+    const char *name;
+    unsigned long long start_ns;
+    unsigned long long duration_ns;
+} RtTraceEvent;
+
+typedef struct
+{
+    const char *name;
+    unsigned long long start_ns;
+} RtTraceSpan;
+
+static int rt_trace_ready = 0;
+static RtTraceEvent *rt_trace_events = NULL;
+static long rt_trace_capacity = 0;
+static long rt_trace_next = 0;     /* total events recorded; the ring index is next % capacity */
+static RtTraceSpan *rt_trace_stack = NULL;
+static long rt_trace_depth = 0;
+static long rt_trace_stack_capacity = 0;
+static long rt_trace_sample = 1;
+static unsigned long long rt_trace_min_ns = 0;
+static const char *rt_trace_filter = NULL;
+static unsigned long long rt_trace_epoch_ns = 0;
+
+static unsigned long long rt_trace_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static long rt_env_long(const char *name, long fallback)
+{
+    const char *value = getenv(name);
+    if (value == NULL || value[0] == '\0')
+    {
+        return fallback;
+    }
+    long parsed = strtol(value, NULL, 10);
+    return parsed > 0 ? parsed : fallback;
+}
+
+static void rt_trace_flush(void);
+
+static void rt_trace_init(void)
+{
+    rt_trace_ready = 1;
+    rt_trace_capacity = rt_env_long("SN_TRACE_BUFFER", RT_TRACE_DEFAULT_BUFFER);
+    rt_trace_sample = rt_env_long("SN_TRACE_SAMPLE", 1);
+    rt_trace_min_ns = (unsigned long long)rt_env_long("SN_TRACE_MIN_US", 0) * 1000ULL;
+    rt_trace_filter = getenv("SN_TRACE_FILTER");
+    if (rt_trace_filter != NULL && rt_trace_filter[0] == '\0')
+    {
+        rt_trace_filter = NULL;
+    }
+    rt_trace_events = malloc(sizeof(RtTraceEvent) * (size_t)rt_trace_capacity);
+    if (rt_trace_events == NULL)
+    {
+        fprintf(stderr, "rt_trace: cannot allocate a buffer of %ld events\n", rt_trace_capacity);
+        exit(1);
+    }
+    rt_trace_epoch_ns = rt_trace_now_ns();
+    atexit(rt_trace_flush);
+}
+
+static int rt_trace_matches(const char *name)
+{
+    if (rt_trace_filter == NULL)
+    {
+        return 1;
+    }
+    const char *part = rt_trace_filter;
+    while (*part != '\0')
+    {
+        size_t length = strcspn(part, ",");
+        for (const char *s = name; length > 0 && *s != '\0'; s++)
+        {
+            if (strncmp(s, part, length) == 0)
+            {
+                return 1;
+            }
+        }
+        part += length;
+        if (*part == ',')
+        {
+            part++;
+        }
+    }
+    return 0;
+}
+
+long rt_trace_begin(long *site, const char *name)
+{
+    if (!rt_trace_ready)
+    {
+        rt_trace_init();
+    }
+    long depth = rt_trace_depth;
+    if (*site == 0)
+    {
+        *site = rt_trace_matches(name) ? 1 : -1;
+    }
+    if (*site < 0)
+    {
+        return depth;
+    }
+    long seen = (*site)++ - 1; /* calls at this site before this one */
+    if (seen % rt_trace_sample != 0)
+    {
+        return depth;
+    }
+    if (rt_trace_depth == rt_trace_stack_capacity)
+    {
+        rt_trace_stack_capacity = rt_trace_stack_capacity > 0 ? rt_trace_stack_capacity * 2 : 64;
+        rt_trace_stack = realloc(rt_trace_stack, sizeof(RtTraceSpan) * (size_t)rt_trace_stack_capacity);
+        if (rt_trace_stack == NULL)
+        {
+            fprintf(stderr, "rt_trace: out of memory\n");
+            exit(1);
+        }
+    }
+    rt_trace_stack[rt_trace_depth].name = name;
+    rt_trace_stack[rt_trace_depth].start_ns = rt_trace_now_ns();
+    rt_trace_depth++;
+    return depth;
+}
+
+static void rt_trace_close(unsigned long long now)
+{
+    RtTraceSpan *span = &rt_trace_stack[--rt_trace_depth];
+    unsigned long long duration = now - span->start_ns;
+    if (duration < rt_trace_min_ns)
+    {
+        return;
+    }
+    RtTraceEvent *event = &rt_trace_events[rt_trace_next % rt_trace_capacity];
+    event->name = span->name;
+    event->start_ns = span->start_ns;
+    event->duration_ns = duration;
+    rt_trace_next++;
+}
+
+void rt_trace_end(long depth)
+{
+    if (rt_trace_depth <= depth)
+    {
+        return;
+    }
+    unsigned long long now = rt_trace_now_ns();
+    while (rt_trace_depth > depth)
+    {
+        rt_trace_close(now);
+    }
+}
+
+/* Runs at exit: spans still open are closed now, then the ring buffer is
+ * written oldest first. */
+static void rt_trace_flush(void)
+{
+    rt_trace_end(0);
+    const char *path = getenv("SN_TRACE_OUT");
+    if (path == NULL || path[0] == '\0')
+    {
+        path = "sn-trace.json";
+    }
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "rt_trace: cannot write %s\n", path);
+        return;
+    }
+    long kept = rt_trace_next < rt_trace_capacity ? rt_trace_next : rt_trace_capacity;
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"otherData\": {\"recorded_events\": %ld, \"dropped_events\": %ld}, "
+                 "\"traceEvents\": [\n",
+            rt_trace_next, rt_trace_next - kept);
+    for (long i = rt_trace_next - kept; i < rt_trace_next; i++)
+    {
+        RtTraceEvent *event = &rt_trace_events[i % rt_trace_capacity];
+        fprintf(out, "{\"name\": ");
+        rt_bench_print_json_string(out, event->name);
+        fprintf(out, ", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+                (double)(event->start_ns - rt_trace_epoch_ns) / 1e3, (double)event->duration_ns / 1e3,
+                i + 1 < rt_trace_next ? "," : "");
+    }
+    fprintf(out, "]}\n");
+    fclose(out);
+    free(rt_trace_events);
+    free(rt_trace_stack);
+    rt_trace_events = NULL;
+    rt_trace_stack = NULL;
+}
+
+/* ---------------------------------------------------------------------------
+ * Sampling profiler (SN_SAMPLE_HZ)
+ *
+ * Generated functions, and any clones the C compiler makes of them, live in
+ * SN-owned sections: sn_text, plus sn_text_hot and sn_text_unlikely for the
+ * functions --use-profile marks hot or cold. An address inside one of them
+ * belongs to the registered function with the greatest start at or below it
+ * in that section, and anything outside is native code (this runtime, libc).
+ * The SIGPROF handler allocates nothing: it maps the frames
+ * from backtrace() to function indices and counts the stack in an
+ * open-addressing table allocated up front. backtrace() is called once at
+ * registration so libgcc is loaded before the first signal arrives.
+ * ------------------------------------------------------------------------- */
+
+#define RT_SAMPLE_MAX_FRAMES 64  /* innermost frames kept per sample */
+#define RT_SAMPLE_STACKS 8192    /* distinct stacks kept; a power of two */
+#define RT_SAMPLE_MAX_PROBES 128
+#define RT_SAMPLE_NATIVE 0xffff  /* leaf outside SN code: runtime, libc or kernel */
+#define RT_SAMPLE_RANGES 4       /* SN text sections: sn_text, sn_text_hot, sn_text_unlikely */
+
+#ifdef RT_SAMPLE_SUPPORTED
+
+typedef struct
+{
+    unsigned long count;
+    unsigned short depth;
+    unsigned short frames[RT_SAMPLE_MAX_FRAMES]; /* outermost first */
+} RtSampleStack;
+
+static RtSampleFunction *rt_sample_functions = NULL; /* sorted by start address */
+static long rt_sample_function_count = 0;
+static RtSampleRange rt_sample_ranges[RT_SAMPLE_RANGES];
+static long rt_sample_range_count = 0;
+static RtSampleStack *rt_sample_stacks = NULL;
+static volatile unsigned long rt_sample_dropped = 0;
+
+static int rt_sample_compare(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)((const RtSampleFunction *)a)->start;
+    uintptr_t y = (uintptr_t)((const RtSampleFunction *)b)->start;
+    return (x > y) - (x < y);
+}
+
+/* Index of the SN function containing pc, or -1. */
+static long rt_sample_lookup(uintptr_t pc)
+{
+    long range = 0;
+    while (range < rt_sample_range_count &&
+           (pc < (uintptr_t)rt_sample_ranges[range].start || pc >= (uintptr_t)rt_sample_ranges[range].end))
+    {
+        range++;
+    }
+    if (range == rt_sample_range_count)
+    {
+        return -1;
+    }
+    long lo = 0;
+    long hi = rt_sample_function_count - 1;
+    long found = -1;
+    while (lo <= hi)
+    {
+        long mid = lo + (hi - lo) / 2;
+        if ((uintptr_t)rt_sample_functions[mid].start <= pc)
+        {
+            found = mid;
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    if (found >= 0 && (uintptr_t)rt_sample_functions[found].start < (uintptr_t)rt_sample_ranges[range].start)
+    {
+        return -1; /* A clone placed ahead of the section's first registered function */
+    }
+    return found;
+}
+
+static uintptr_t rt_sample_context_pc(void *context)
+{
+    ucontext_t *uc = context;
+#if defined(__x86_64__)
+    return (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+    return (uintptr_t)uc->uc_mcontext.pc;
+#else
+    (void)uc;
+    return 0;
+#endif
+}
+
+static void rt_sample_count(const unsigned short *stack, int depth)
+{
+    uint64_t hash = 1469598103934665603ULL; /* FNV-1a */
+    for (int i = 0; i < depth; i++)
+    {
+        hash = (hash ^ stack[i]) * 1099511628211ULL;
+    }
+    unsigned long slot = (unsigned long)hash & (RT_SAMPLE_STACKS - 1);
+    for (int probe = 0; probe < RT_SAMPLE_MAX_PROBES; probe++)
+    {
+        RtSampleStack *entry = &rt_sample_stacks[slot];
+        if (entry->count == 0)
+        {
+            entry->depth = (unsigned short)depth;
+            memcpy(entry->frames, stack, sizeof(unsigned short) * (size_t)depth);
+            entry->count = 1;
+            return;
+        }
+        if (entry->depth == depth && memcmp(entry->frames, stack, sizeof(unsigned short) * (size_t)depth) == 0)
+        {
+            entry->count++;
+            return;
+        }
+        slot = (slot + 1) & (RT_SAMPLE_STACKS - 1);
+    }
+    rt_sample_dropped++;
+}
+
+static void rt_sample_handler(int sig, siginfo_t *info, void *context)
+{
+    (void)sig;
+    (void)info;
+    int saved_errno = errno;
+    void *frames[RT_SAMPLE_MAX_FRAMES + 4];
+    int n = backtrace(frames, RT_SAMPLE_MAX_FRAMES + 4);
+    uintptr_t pc = rt_sample_context_pc(context);
+
+    /* Frames up to the interrupted one belong to this handler and the signal
+     * trampoline; the ones after it are return addresses of its callers. */
+    int callers = 0;
+    if (pc != 0)
+    {
+        callers = n;
+        for (int i = 0; i < n; i++)
+        {
+            if ((uintptr_t)frames[i] == pc)
+            {
+                callers = i + 1;
+                break;
+            }
+        }
+    }
+
+    unsigned short stack[RT_SAMPLE_MAX_FRAMES];
+    int depth = 0;
+    for (int i = n - 1; i >= callers && depth < RT_SAMPLE_MAX_FRAMES - 1; i--)
+    {
+        /* A return address can be the first byte of the next function; look up the call instead. */
+        long fn = rt_sample_lookup((uintptr_t)frames[i] - 1);
+        if (fn >= 0)
+        {
+            stack[depth++] = (unsigned short)fn;
+        }
+    }
+    long leaf = pc != 0 ? rt_sample_lookup(pc) : -1;
+    if (leaf >= 0)
+    {
+        stack[depth++] = (unsigned short)leaf;
+    }
+    else if (pc != 0 || depth == 0)
+    {
+        stack[depth++] = RT_SAMPLE_NATIVE;
+    }
+    rt_sample_count(stack, depth);
+    errno = saved_errno;
+}
+
+static void rt_sample_flush(void)
+{
+    struct itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_PROF, &off, NULL);
+    signal(SIGPROF, SIG_IGN);
+
+    const char *path = getenv("SN_SAMPLE_OUT");
+    if (path == NULL || path[0] == '\0')
+    {
+        path = "sn-samples.folded";
+    }
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "rt_sample: cannot write %s\n", path);
+        return;
+    }
+    for (long i = 0; i < RT_SAMPLE_STACKS; i++)
+    {
+        RtSampleStack *entry = &rt_sample_stacks[i];
+        if (entry->count == 0)
+        {
+            continue;
+        }
+        for (int j = 0; j < entry->depth; j++)
+        {
+            unsigned short fn = entry->frames[j];
+            fprintf(out, "%s%s", j > 0 ? ";" : "", fn == RT_SAMPLE_NATIVE ? "[native]" : rt_sample_functions[fn].name);
+        }
+        fprintf(out, " %lu\n", entry->count);
+    }
+    fclose(out);
+    if (rt_sample_dropped > 0)
+    {
+        fprintf(stderr, "rt_sample: %lu samples dropped (more than %d distinct stacks)\n", rt_sample_dropped,
+                RT_SAMPLE_STACKS);
+    }
+    free(rt_sample_functions);
+    free(rt_sample_stacks);
+    rt_sample_functions = NULL;
+    rt_sample_stacks = NULL;
+}
+
+void rt_sample_register(const RtSampleFunction *functions, long count, const RtSampleRange *ranges,
+                        long range_count)
+{
+    long hz = rt_env_long("SN_SAMPLE_HZ", 0);
+    if (hz <= 0 || count <= 0 || rt_sample_functions != NULL)
+    {
+        return;
+    }
+    if (count >= RT_SAMPLE_NATIVE)
+    {
+        fprintf(stderr, "rt_sample: too many functions (%ld) to profile\n", count);
+        return;
+    }
+    rt_sample_functions = malloc(sizeof(RtSampleFunction) * (size_t)count);
+    rt_sample_stacks = calloc(RT_SAMPLE_STACKS, sizeof(RtSampleStack));
+    if (rt_sample_functions == NULL || rt_sample_stacks == NULL)
+    {
+        fprintf(stderr, "rt_sample: out of memory\n");
+        exit(1);
+    }
+    memcpy(rt_sample_functions, functions, sizeof(RtSampleFunction) * (size_t)count);
+    qsort(rt_sample_functions, (size_t)count, sizeof(RtSampleFunction), rt_sample_compare);
+    rt_sample_function_count = count;
+    rt_sample_range_count = 0;
+    for (long i = 0; i < range_count && rt_sample_range_count < RT_SAMPLE_RANGES; i++)
+    {
+        if (ranges[i].start != NULL && ranges[i].start != ranges[i].end)
+        {
+            rt_sample_ranges[rt_sample_range_count++] = ranges[i];
+        }
+    }
+
+    void *prime[1];
+    backtrace(prime, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = rt_sample_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, NULL) != 0)
+    {
+        perror("rt_sample: sigaction");
+        return;
+    }
+    atexit(rt_sample_flush);
+
+    long interval_us = 1000000L / hz > 0 ? 1000000L / hz : 1;
+    struct itimerval timer;
+    timer.it_interval.tv_sec = interval_us / 1000000L;
+    timer.it_interval.tv_usec = interval_us % 1000000L;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+#else
+
+void rt_sample_register(const RtSampleFunction *functions, long count, const RtSampleRange *ranges,
+                        long range_count)
+{
+    (void)functions;
+    (void)count;
+    (void)ranges;
+    (void)range_count;
+    if (getenv("SN_SAMPLE_HZ") != NULL)
+    {
+        fprintf(stderr, "rt_sample: SN_SAMPLE_HZ needs Linux and a runtime built with -D_GNU_SOURCE\n");
+    }
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Coverage counters (--coverage)
+ *
+ * Generated code bumps a static array of counters directly; the runtime only
+ * learns where that array is and what each slot means. Every site takes two
+ * slots: a branch counts its condition as true and as false, and a function
+ * entry uses the first slot only. A site is described by
+ * "<function> <ordinal> <kind> <line>", which --use-profile matches back to the
+ * same node when the program is recompiled.
+ * ------------------------------------------------------------------------- */
+
+static long *rt_cov_counters = NULL;
+static const char *const *rt_cov_sites = NULL;
+static long rt_cov_count = 0;
+
+static void rt_cov_flush(void)
+{
+    const char *path = getenv("SN_COV_OUT");
+    if (path == NULL || path[0] == '\0')
+    {
+        path = "sn-coverage.profile";
+    }
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "rt_cov: cannot write %s\n", path);
+        return;
+    }
+    fprintf(out, "# sn coverage profile v1\n");
+    for (long i = 0; i < rt_cov_count; i++)
+    {
+        fprintf(out, "%s %ld %ld\n", rt_cov_sites[i], rt_cov_counters[2 * i], rt_cov_counters[2 * i + 1]);
+    }
+    fclose(out);
+}
+
+void rt_cov_register(long *counters, const char *const *sites, long count)
+{
+    if (rt_cov_counters != NULL)
+    {
+        return;
+    }
+    rt_cov_counters = counters;
+    rt_cov_sites = sites;
+    rt_cov_count = count;
+    atexit(rt_cov_flush);
+}
@@ -2,8 +2,9 @@
 #define RUNTIME_H
 
 #include <stddef.h>
+#include <stdio.h>
 
-char *rt_str_concat(const char *left, char *right);
+char *rt_str_concat(const char *left, const char *right);
 char *rt_to_string_long(long val);
 char *rt_to_string_double(double val);
 char *rt_to_string_char(char val);
@@ -40,6 +41,111 @@ double rt_neg_double(double a);
 int rt_not_bool(int a);
 long rt_post_inc_long(long *p);
 long rt_post_dec_long(long *p);
+long rt_array_index(long index, long length);
 void rt_free_string(char *s);
 
+/* Formatters for interpolation holes with a format spec. The compiler passes
+ * the decoded spec: `align` is '<', '>', '^' or '=' (pad between sign and
+ * digits), and `precision` is -1 when absent. Each returns a fresh string. */
+char *rt_format_long(long value, long base, long upper, long plus, long width, long fill, long align);
+char *rt_format_double(double value, long precision, long plus, long width, long fill, long align);
+char *rt_format_string(const char *value, long precision, long width, long fill, long align);
+char *rt_format_char(long value, long width, long fill, long align);
+
+/* Harness behind `bench` blocks. A program runs its benches instead of main
+ * when SN_BENCH is set; a value other than "" or "all" keeps only benches whose
+ * name contains it. SN_BENCH_FORMAT=json prints one JSON object per bench. */
+long rt_bench_requested(void);
+void rt_bench_run(const char *name, void (*body)(void));
+/* Sends bench reports to `out` instead of stdout (NULL restores stdout). */
+void rt_bench_set_output(FILE *out);
+
+/* Function profiler behind --instrument. An instrumented function calls
+ * rt_prof_enter on entry, which creates its record on the first call and caches
+ * it in *slot, and rt_prof_exit on its single return path. At exit a flat
+ * profile and a call graph are written to $SN_PROF_OUT.flat.txt and
+ * $SN_PROF_OUT.callgraph.txt (default prefix "sn-prof"). There are no locks:
+ * generated programs are single-threaded. */
+typedef struct RtProfFunction RtProfFunction;
+
+void rt_prof_enter(RtProfFunction **slot, const char *name);
+void rt_prof_exit(void);
+
+/* Trace recorder behind --trace. rt_trace_begin opens a span and returns the
+ * depth to hand back to rt_trace_end, which closes every span opened since,
+ * so an early return out of a traced loop still balances. *site caches the
+ * filter decision and counts calls for sampling. Completed spans go to a ring
+ * buffer of SN_TRACE_BUFFER events (oldest overwritten) that is written at
+ * exit as Chrome trace-event JSON to SN_TRACE_OUT (default "sn-trace.json").
+ * SN_TRACE_SAMPLE=N keeps every Nth span per site, SN_TRACE_FILTER keeps
+ * spans whose name contains one of its comma-separated parts, and
+ * SN_TRACE_MIN_US drops spans shorter than that. */
+long rt_trace_begin(long *site, const char *name);
+void rt_trace_end(long depth);
+
+/* Statistical profiler. Generated code is placed in its own sections (plain,
+ * hot and cold), and every program registers the bounds of those sections and
+ * the start address of each SN function from a constructor. When SN_SAMPLE_HZ is set, SIGPROF fires
+ * at that rate of CPU time and each sample's call stack is mapped to SN
+ * functions and counted. At exit the counts are written as folded stacks
+ * (flamegraph.pl / speedscope input) to SN_SAMPLE_OUT, default
+ * "sn-samples.folded". Without SN_SAMPLE_HZ registration is all it costs. */
+typedef struct
+{
+    const char *name;
+    void *start;
+} RtSampleFunction;
+
+typedef struct
+{
+    void *start; /* NULL for a section the program does not have */
+    void *end;
+} RtSampleRange;
+
+void rt_sample_register(const RtSampleFunction *functions, long count, const RtSampleRange *ranges,
+                        long range_count);
+
+/* Coverage counters for --coverage. `counters` holds two slots per site and
+ * `sites` one "<function> <ordinal> <kind> <line>" description per site. At
+ * exit every site and its two counts are written to SN_COV_OUT (default
+ * "sn-coverage.profile"), the file the compiler reads with --use-profile. */
+void rt_cov_register(long *counters, const char *const *sites, long count);
+
+/* A single boxed SN value, used by runtime containers that store mixed types. */
+typedef union
+{
+    long l;
+    double d;
+    char *s;
+} RtValue;
+
+/* Seeded string hash used by string `match` dispatch. The compiler searches for
+ * a seed that makes every case literal land in a distinct bucket, so the runtime
+ * must compute exactly the same function. */
+unsigned long rt_str_hash_seeded(unsigned long seed, const char *s);
+
+/* Memo table backing @memo functions. Keys are tuples of `arity` values; bit i
+ * of `str_mask` marks argument i as a string. `max_entries` of 0 is unbounded,
+ * otherwise the least recently used entry is evicted once the bound is hit. */
+typedef struct RtMemo RtMemo;
+
+RtMemo *rt_memo_create(long arity, long str_mask, long str_result, long max_entries);
+long rt_memo_get(RtMemo *memo, RtValue *key, RtValue *out);
+void rt_memo_put(RtMemo *memo, RtValue *key, RtValue value);
+
+/* Hash map backing map<K, V>. Keys and string values are copied in, and every
+ * string handed back (get, key_at, value_at) is a fresh copy owned by the caller.
+ * key_at/value_at walk entries densely; removal moves the last entry into the gap. */
+typedef struct RtMap RtMap;
+
+RtMap *rt_map_create(long str_keys, long str_values);
+void rt_map_free(RtMap *map);
+long rt_map_length(RtMap *map);
+long rt_map_contains(RtMap *map, RtValue key);
+RtValue rt_map_get(RtMap *map, RtValue key);
+void rt_map_set(RtMap *map, RtValue key, RtValue value);
+long rt_map_remove(RtMap *map, RtValue key);
+RtValue rt_map_key_at(RtMap *map, long index);
+RtValue rt_map_value_at(RtMap *map, long index);
+
 #endif
\ No newline at end of file
@@ -1,3 +1,4 @@
+#define DEBUG_CATEGORY DEBUG_CAT_SYMTAB
 #include "symbol_table.h"
 #include "debug.h"
 #include <stdlib.h>
@@ -35,6 +36,9 @@ static char *token_to_string(Token token)
 
 void symbol_table_print(SymbolTable *table, const char *where)
 {
+    if (!DEBUG_ENABLED(DEBUG_LEVEL_VERBOSE))
+        return;
+
     DEBUG_VERBOSE("==== SYMBOL TABLE DUMP (%s) ====", where);
 
     if (!table || !table->current)
@@ -175,17 +179,8 @@ static int tokens_equal(Token a, Token b)
 {
     if (a.length != b.length)
     {
-        char a_str[256], b_str[256];
-        int a_len = a.length < 255 ? a.length : 255;
-        int b_len = b.length < 255 ? b.length : 255;
-
-        strncpy(a_str, a.start, a_len);
-        a_str[a_len] = '\0';
-        strncpy(b_str, b.start, b_len);
-        b_str[b_len] = '\0';
-
-        DEBUG_VERBOSE("Token length mismatch: '%s'(%d) vs '%s'(%d)",
-                      a_str, a.length, b_str, b.length);
+        DEBUG_VERBOSE("Token length mismatch: '%.*s'(%d) vs '%.*s'(%d)",
+                      a.length, a.start, a.length, b.length, b.start, b.length);
         return 0;
     }
 
@@ -195,25 +190,14 @@ static int tokens_equal(Token a, Token b)
         return 1;
     }
 
-    int result = memcmp(a.start, b.start, a.length);
-
-    char a_str[256], b_str[256];
-    int a_len = a.length < 255 ? a.length : 255;
-    int b_len = b.length < 255 ? b.length : 255;
-
-    strncpy(a_str, a.start, a_len);
-    a_str[a_len] = '\0';
-    strncpy(b_str, b.start, b_len);
-    b_str[b_len] = '\0';
-
-    if (result == 0)
+    if (memcmp(a.start, b.start, a.length) == 0)
     {
-        DEBUG_VERBOSE("Token content match: '%s' == '%s'", a_str, b_str);
+        DEBUG_VERBOSE("Token content match: '%.*s' == '%.*s'", a.length, a.start, b.length, b.start);
         return 1;
     }
     else
     {
-        DEBUG_VERBOSE("Token content mismatch: '%s' != '%s'", a_str, b_str);
+        DEBUG_VERBOSE("Token content mismatch: '%.*s' != '%.*s'", a.length, a.start, b.length, b.start);
         return 0;
     }
 }
@@ -230,6 +214,7 @@ void symbol_table_add_symbol_with_kind(SymbolTable *table, Token name, Type *typ
     if (existing != NULL)
     {
         existing->type = ast_clone_type(table->arena, type);
+        existing->const_value = NULL;
         return;
     }
 
@@ -243,8 +228,9 @@ void symbol_table_add_symbol_with_kind(SymbolTable *table, Token name, Type *typ
     symbol->name = name;
     symbol->type = ast_clone_type(table->arena, type);
     symbol->kind = kind;
+    symbol->const_value = NULL;
 
-    if (kind == SYMBOL_PARAM)
+    if (kind == SYMBOL_PARAM || kind == SYMBOL_REF_PARAM)
     {
         symbol->offset = -table->current->next_param_offset;
         int type_size = get_type_size(type);
@@ -308,13 +294,8 @@ Symbol *symbol_table_lookup_symbol(SymbolTable *table, Token name)
         return NULL;
     }
 
-    char name_str[256];
-    int name_len = name.length < 255 ? name.length : 255;
-    strncpy(name_str, name.start, name_len);
-    name_str[name_len] = '\0';
-
-    DEBUG_VERBOSE("Looking up symbol '%s' at address %p, length %d",
-                  name_str, (void *)name.start, name.length);
+    DEBUG_VERBOSE("Looking up symbol '%.*s' at address %p, length %d",
+                  name.length, name.start, (void *)name.start, name.length);
 
     Scope *scope = table->current;
     int scope_level = 0;
@@ -326,33 +307,14 @@ Symbol *symbol_table_lookup_symbol(SymbolTable *table, Token name)
         Symbol *symbol = scope->symbols;
         while (symbol != NULL)
         {
-            char sym_name[256];
-            int sym_len = symbol->name.length < 255 ? symbol->name.length : 255;
-            strncpy(sym_name, symbol->name.start, sym_len);
-            sym_name[sym_len] = '\0';
-
-            DEBUG_VERBOSE("    Symbol '%s' at address %p, length %d",
-                          sym_name, (void *)symbol->name.start, symbol->name.length);
-
-            if (symbol->name.start == name.start && symbol->name.length == name.length)
-            {
-                DEBUG_VERBOSE("Found symbol '%s' in scope level %d (direct pointer match)",
-                              sym_name, scope_level);
-                return symbol;
-            }
+            DEBUG_VERBOSE("    Symbol '%.*s' at address %p, length %d",
+                          symbol->name.length, symbol->name.start, (void *)symbol->name.start, symbol->name.length);
 
             if (symbol->name.length == name.length &&
-                memcmp(symbol->name.start, name.start, name.length) == 0)
-            {
-                DEBUG_VERBOSE("Found symbol '%s' in scope level %d (content match)",
-                              sym_name, scope_level);
-                return symbol;
-            }
-
-            if (strcmp(sym_name, name_str) == 0)
+                (symbol->name.start == name.start || memcmp(symbol->name.start, name.start, name.length) == 0))
             {
-                DEBUG_VERBOSE("Found symbol '%s' by string comparison in scope level %d",
-                              sym_name, scope_level);
+                DEBUG_VERBOSE("Found symbol '%.*s' in scope level %d",
+                              name.length, name.start, scope_level);
                 return symbol;
             }
 
@@ -363,7 +325,7 @@ Symbol *symbol_table_lookup_symbol(SymbolTable *table, Token name)
         scope_level++;
     }
 
-    DEBUG_VERBOSE("Symbol '%s' not found in any scope", name_str);
+    DEBUG_VERBOSE("Symbol '%.*s' not found in any scope", name.length, name.start);
     return NULL;
 }
 
@@ -372,11 +334,7 @@ int symbol_table_get_symbol_offset(SymbolTable *table, Token name)
     Symbol *symbol = symbol_table_lookup_symbol(table, name);
     if (symbol == NULL)
     {
-        char temp[256];
-        int name_len = name.length < 255 ? name.length : 255;
-        strncpy(temp, name.start, name_len);
-        temp[name_len] = '\0';
-        DEBUG_ERROR("Symbol not found in get_symbol_offset: '%s'", temp);
+        DEBUG_ERROR("Symbol not found in get_symbol_offset: '%.*s'", name.length, name.start);
         return -1;
     }
 
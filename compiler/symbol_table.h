@@ -19,7 +19,8 @@ typedef enum
 {
     SYMBOL_GLOBAL,
     SYMBOL_LOCAL,
-    SYMBOL_PARAM
+    SYMBOL_PARAM,
+    SYMBOL_REF_PARAM // Pointer to a caller's variable, read and written through
 } SymbolKind;
 
 typedef struct Symbol
@@ -28,6 +29,7 @@ typedef struct Symbol
     Type *type;
     SymbolKind kind;
     int offset;
+    Expr *const_value; // Folded initializer of a const declaration, NULL otherwise
     struct Symbol *next;
 } Symbol;
 
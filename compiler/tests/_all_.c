@@ -4,6 +4,8 @@
 #include "parser_tests.c"
 #include "token_tests.c"
 #include "lexer_tests.c"
+#include "code_gen_tests.c"
+#include "alloc_tests.c"
 
 int main()
 {
@@ -74,11 +76,20 @@ int main()
     test_empty_program_parsing();
     test_var_decl_parsing();
     test_function_no_params_parsing();
+    test_function_annotation_parsing();
+    test_map_type_parsing();
+    test_match_statement_parsing();
+    test_const_decl_parsing();
+    test_tuple_parsing();
+    test_ref_param_parsing();
+    test_bench_parsing();
     test_if_statement_parsing();
     test_simple_program_parsing();
     test_while_loop_parsing();
+    test_import_parsing();
     test_for_loop_parsing();
     test_interpolated_string_parsing();
+    test_interpolated_format_spec_parsing();
     test_literal_types_parsing();
     test_recursive_function_parsing();
     test_full_program_parsing();
@@ -108,6 +119,7 @@ int main()
     test_lexer_char_literal();
     test_lexer_operators();
     test_lexer_indentation();
+    test_lexer_deep_indentation();
     test_lexer_inconsistent_indent();
     test_lexer_unterminated_string();
     test_lexer_invalid_escape();
@@ -117,6 +129,19 @@ int main()
     test_lexer_invalid_character();
     test_lexer_multiline_string();
 
+    // *** Code Gen ***
+
+    test_code_gen_string_concat_non_string();
+    test_code_gen_tuple_literal_typedef();
+    test_code_gen_line_directives_per_line();
+
+    // *** Allocations ***
+
+    test_alloc_lexer_per_token();
+    test_alloc_parser_per_node();
+    test_alloc_symbol_lookup();
+    test_alloc_code_gen_per_expression();
+
     printf("All tests passed!\n");
 
     return 0;
@@ -0,0 +1,188 @@
+// tests/alloc_tests.c
+// Allocation budgets for the compiler's hot paths. Each test counts arena_alloc
+// calls for a generated source of N lines and of 2N lines and checks the
+// difference, so fixed setup costs (builtins, headers, the first block) don't
+// hide a per-token or per-node regression.
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../arena.h"
+#include "../code_gen.h"
+#include "../debug.h"
+#include "../lexer.h"
+#include "../parser.h"
+#include "../symbol_table.h"
+#include "../type_checker.h"
+
+#define ALLOC_TEST_LINES 100
+
+// One declaration per line: a var-decl statement over 5 expressions
+// (x + (y * 2) with literal operands).
+#define ALLOC_TEST_LINE "  var x%d:int = %d + %d * 2\n"
+#define ALLOC_TEST_EXPRS_PER_LINE 5
+#define ALLOC_TEST_NODES_PER_LINE (ALLOC_TEST_EXPRS_PER_LINE + 1)
+
+static char *alloc_test_source(int lines)
+{
+    char *source = malloc((size_t)lines * 64 + 64);
+    assert(source != NULL);
+    char *p = source + sprintf(source, "fn main():void =>\n");
+    for (int i = 0; i < lines; i++)
+    {
+        p += sprintf(p, ALLOC_TEST_LINE, i, i, i);
+    }
+    return source;
+}
+
+static size_t count_lexer_allocs(int lines, int *tokens)
+{
+    char *source = alloc_test_source(lines);
+    Arena arena;
+    arena_init(&arena, 4096);
+    Lexer lexer;
+    lexer_init(&arena, &lexer, source, "alloc.sn");
+    size_t before = arena.alloc_count;
+    *tokens = 0;
+    Token token;
+    do
+    {
+        token = lexer_scan_token(&lexer);
+        (*tokens)++;
+    } while (token.type != TOKEN_EOF);
+    size_t allocs = arena.alloc_count - before;
+    lexer_cleanup(&lexer);
+    arena_free(&arena);
+    free(source);
+    return allocs;
+}
+
+// Parses (and, when `code_gen` is set, type checks) the source, then counts the
+// allocations of the parse or of generating C for it.
+static size_t count_module_allocs(int lines, int code_gen)
+{
+    char *source = alloc_test_source(lines);
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    arena_init(&arena, 4096);
+    lexer_init(&arena, &lexer, source, "alloc.sn");
+    symbol_table_init(&arena, &symbol_table);
+    parser_init(&arena, &parser, &lexer, &symbol_table);
+
+    size_t before = arena.alloc_count;
+    Module *module = parser_execute(&parser, "alloc.sn");
+    assert(module != NULL);
+    size_t allocs = arena.alloc_count - before;
+
+    if (code_gen)
+    {
+        int type_ok = type_check_module(module, &symbol_table);
+        assert(type_ok);
+        CodeGen gen;
+        code_gen_init(&arena, &gen, &symbol_table, "/dev/null");
+        before = arena.alloc_count;
+        code_gen_module(&gen, module);
+        allocs = arena.alloc_count - before;
+        code_gen_cleanup(&gen);
+    }
+
+    parser_cleanup(&parser);
+    lexer_cleanup(&lexer);
+    symbol_table_cleanup(&symbol_table);
+    arena_free(&arena);
+    free(source);
+    return allocs;
+}
+
+void test_alloc_lexer_per_token()
+{
+    DEBUG_INFO("\n*** Testing lexer allocations per token...\n");
+
+    int tokens_small, tokens_large;
+    size_t small = count_lexer_allocs(ALLOC_TEST_LINES, &tokens_small);
+    size_t large = count_lexer_allocs(ALLOC_TEST_LINES * 2, &tokens_large);
+    int tokens = tokens_large - tokens_small;
+
+    // Only the lexeme copy; no per-token scratch buffers.
+    assert(tokens > 0);
+    assert(large - small <= (size_t)tokens);
+
+    DEBUG_INFO("Finished test_alloc_lexer_per_token");
+}
+
+void test_alloc_parser_per_node()
+{
+    DEBUG_INFO("\n*** Testing parser allocations per node...\n");
+
+    size_t small = count_module_allocs(ALLOC_TEST_LINES, 0);
+    size_t large = count_module_allocs(ALLOC_TEST_LINES * 2, 0);
+    size_t nodes = ALLOC_TEST_LINES * ALLOC_TEST_NODES_PER_LINE;
+
+    // Includes the lexemes of every token the parser pulls from the lexer.
+    assert(large - small <= nodes * 7);
+
+    DEBUG_INFO("Finished test_alloc_parser_per_node");
+}
+
+void test_alloc_symbol_lookup()
+{
+    DEBUG_INFO("\n*** Testing symbol_table_lookup_symbol allocations...\n");
+
+    Arena arena;
+    arena_init(&arena, 4096);
+    SymbolTable table;
+    symbol_table_init(&arena, &table);
+    Type *int_type = ast_create_primitive_type(&arena, TYPE_INT);
+
+    char names[32][8];
+    for (int i = 0; i < 32; i++)
+    {
+        symbol_table_push_scope(&table);
+        snprintf(names[i], sizeof(names[i]), "v%d", i);
+        Token name = {0};
+        name.type = TOKEN_IDENTIFIER;
+        name.start = names[i];
+        name.length = (int)strlen(names[i]);
+        symbol_table_add_symbol(&table, name, int_type);
+    }
+
+    Token outer = {0};
+    outer.type = TOKEN_IDENTIFIER;
+    outer.start = "v0";
+    outer.length = 2;
+    Token missing = outer;
+    missing.start = "nope";
+    missing.length = 4;
+
+    size_t before = arena.alloc_count;
+    int found = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        Symbol *hit = symbol_table_lookup_symbol(&table, outer);
+        Symbol *miss = symbol_table_lookup_symbol(&table, missing);
+        found += hit != NULL && miss == NULL;
+    }
+    assert(found == 1000);
+    assert(arena.alloc_count == before);
+
+    symbol_table_cleanup(&table);
+    arena_free(&arena);
+
+    DEBUG_INFO("Finished test_alloc_symbol_lookup");
+}
+
+void test_alloc_code_gen_per_expression()
+{
+    DEBUG_INFO("\n*** Testing code generation allocations per expression...\n");
+
+    size_t small = count_module_allocs(ALLOC_TEST_LINES, 1);
+    size_t large = count_module_allocs(ALLOC_TEST_LINES * 2, 1);
+    size_t exprs = ALLOC_TEST_LINES * ALLOC_TEST_EXPRS_PER_LINE;
+
+    // The C text of each subexpression, which its parent formats into its own.
+    assert(large - small <= exprs * 2);
+
+    DEBUG_INFO("Finished test_alloc_code_gen_per_expression");
+}
@@ -29,6 +29,7 @@ void test_arena_init()
     assert(arena.current == arena.first);
     assert(arena.current_used == 0);
     assert(arena.block_size == initial_size);
+    assert(arena.total_allocated == 0);
     DEBUG_INFO("Cleaning up arena in test_arena_init");
     arena_free(&arena); // Clean up
     DEBUG_INFO("Finished test_arena_init");
@@ -71,6 +72,7 @@ void test_arena_alloc_small()
     assert(arena.block_size == 32);
     assert(p3 == arena.current->data);
     assert(arena.current_used == 8);
+    assert(arena.total_allocated == 24); // Aligned sizes across both blocks
 
     DEBUG_INFO("Cleaning up arena in test_arena_alloc_small");
     arena_free(&arena);
@@ -242,6 +242,23 @@ void test_ast_type_equals()
     assert(ast_type_equals(nested1, arr1) == 0); // Different depth
     assert(ast_type_equals(nested1, nested3) == 1);
 
+    // Maps
+    Type *map1 = ast_create_map_type(&arena, t3, t1);
+    Type *map2 = ast_create_map_type(&arena, t3, t2);
+    Type *map3 = ast_create_map_type(&arena, t1, t1);
+    assert(ast_type_equals(map1, map2) == 1);
+    assert(ast_type_equals(map1, map3) == 0);
+    assert(ast_type_equals(map1, arr1) == 0);
+
+    // Tuples
+    Type *elems1[2] = {t1, t3};
+    Type *elems2[2] = {t2, t3};
+    Type *elems3[3] = {t1, t3, t3};
+    Type *tuple1 = ast_create_tuple_type(&arena, elems1, 2);
+    assert(ast_type_equals(tuple1, ast_create_tuple_type(&arena, elems2, 2)) == 1);
+    assert(ast_type_equals(tuple1, ast_create_tuple_type(&arena, elems3, 3)) == 0);
+    assert(ast_type_equals(tuple1, ast_clone_type(&arena, tuple1)) == 1);
+
     // Functions
     Type *params1[2] = {t1, t3};
     Type *fn1 = ast_create_function_type(&arena, t1, params1, 2);
@@ -305,6 +322,15 @@ void test_ast_type_to_string()
     Type *nested_arr = ast_create_array_type(&arena, arr);
     assert(strcmp(ast_type_to_string(&arena, nested_arr), "array of array of char") == 0);
 
+    // Map
+    Type *map = ast_create_map_type(&arena, ast_create_primitive_type(&arena, TYPE_STRING), ast_create_primitive_type(&arena, TYPE_INT));
+    assert(strcmp(ast_type_to_string(&arena, map), "map<string, int>") == 0);
+
+    // Tuple
+    Type *tuple_elems[2] = {ast_create_primitive_type(&arena, TYPE_INT), ast_create_primitive_type(&arena, TYPE_STRING)};
+    Type *tuple = ast_create_tuple_type(&arena, tuple_elems, 2);
+    assert(strcmp(ast_type_to_string(&arena, tuple), "(int, string)") == 0);
+
     // Function
     Type *params[1] = {ast_create_primitive_type(&arena, TYPE_BOOL)};
     Type *fn = ast_create_function_type(&arena, ast_create_primitive_type(&arena, TYPE_STRING), params, 1);
@@ -712,7 +738,7 @@ void test_ast_create_interpolated_expr()
     Expr *parts[2];
     parts[0] = ast_create_literal_expr(&arena, (LiteralValue){.string_value = "hello "}, ast_create_primitive_type(&arena, TYPE_STRING), true, loc);
     parts[1] = ast_create_variable_expr(&arena, create_dummy_token(&arena, "name"), loc);
-    Expr *interp = ast_create_interpolated_expr(&arena, parts, 2, loc);
+    Expr *interp = ast_create_interpolated_expr(&arena, parts, NULL, 2, loc);
     assert(interp != NULL);
     assert(interp->type == EXPR_INTERPOLATED);
     assert(interp->as.interpol.part_count == 2);
@@ -722,19 +748,19 @@ void test_ast_create_interpolated_expr()
     assert(interp->expr_type == NULL);
 
     // Empty parts
-    Expr *interp_empty = ast_create_interpolated_expr(&arena, NULL, 0, loc);
+    Expr *interp_empty = ast_create_interpolated_expr(&arena, NULL, NULL, 0, loc);
     assert(interp_empty != NULL);
     assert(interp_empty->as.interpol.part_count == 0);
     assert(interp_empty->as.interpol.parts == NULL);
 
     // NULL parts with count > 0
-    Expr *interp_null_parts = ast_create_interpolated_expr(&arena, NULL, 2, loc);
+    Expr *interp_null_parts = ast_create_interpolated_expr(&arena, NULL, NULL, 2, loc);
     assert(interp_null_parts != NULL);
     assert(interp_null_parts->as.interpol.parts == NULL);
     assert(interp_null_parts->as.interpol.part_count == 2);
 
     // NULL loc
-    Expr *interp_null_loc = ast_create_interpolated_expr(&arena, parts, 2, NULL);
+    Expr *interp_null_loc = ast_create_interpolated_expr(&arena, parts, NULL, 2, NULL);
     assert(interp_null_loc != NULL);
     assert(interp_null_loc->token == NULL);
 
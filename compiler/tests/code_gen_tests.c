@@ -0,0 +1,120 @@
+// tests/code_gen_tests.c
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "../arena.h"
+#include "../code_gen.h"
+#include "../debug.h"
+#include "../file.h"
+#include "../lexer.h"
+#include "../parser.h"
+#include "../symbol_table.h"
+#include "../type_checker.h"
+
+#define CODE_GEN_TEST_OUTPUT "code_gen_test_output.c"
+
+// Parses, type checks and generates C for `source`, and returns the C text,
+// allocated from `arena`.
+static char *code_gen_test_emit(Arena *arena, const char *source)
+{
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    lexer_init(arena, &lexer, source, "test.sn");
+    symbol_table_init(arena, &symbol_table);
+    parser_init(arena, &parser, &lexer, &symbol_table);
+
+    Module *module = parser_execute(&parser, "test.sn");
+    assert(module != NULL);
+    int type_ok = type_check_module(module, &symbol_table);
+    assert(type_ok);
+
+    CodeGen gen;
+    code_gen_init(arena, &gen, &symbol_table, CODE_GEN_TEST_OUTPUT);
+    code_gen_module(&gen, module);
+    code_gen_cleanup(&gen);
+
+    char *output = file_read(arena, CODE_GEN_TEST_OUTPUT);
+    assert(output != NULL);
+    remove(CODE_GEN_TEST_OUTPUT);
+
+    parser_cleanup(&parser);
+    lexer_cleanup(&lexer);
+    symbol_table_cleanup(&symbol_table);
+    return output;
+}
+
+void test_code_gen_string_concat_non_string()
+{
+    DEBUG_INFO("\n*** Testing code_gen string + non-string...\n");
+
+    Arena arena;
+    arena_init(&arena, 4096);
+    const char *source =
+        "fn main():void =>\n"
+        "  var n:int = 5\n"
+        "  var a:str = \"n=\" + n\n"
+        "  var b:str = n + \"!\"\n";
+    char *output = code_gen_test_emit(&arena, source);
+
+    // Both operands reach rt_str_concat as strings.
+    assert(strstr(output, "char *_right = rt_to_string_long(n);") != NULL);
+    assert(strstr(output, "char *_left = rt_to_string_long(n);") != NULL);
+
+    arena_free(&arena);
+
+    DEBUG_INFO("Finished test_code_gen_string_concat_non_string");
+}
+
+void test_code_gen_tuple_literal_typedef()
+{
+    DEBUG_INFO("\n*** Testing code_gen typedefs for destructured tuple literals...\n");
+
+    Arena arena;
+    arena_init(&arena, 4096);
+    const char *source =
+        "fn main():void =>\n"
+        "  var (x, y) = (1, \"hi\")\n"
+        "  if x > 0 =>\n"
+        "    var (a, b) = (2.5, x)\n";
+    char *output = code_gen_test_emit(&arena, source);
+
+    // No function returns these shapes, but both still need a struct.
+    assert(strstr(output, "typedef struct { long f0; char * f1; } SnTuple_ls;") != NULL);
+    assert(strstr(output, "} SnTuple_dl;") != NULL);
+    assert(strstr(output, "SnTuple_ls;") < strstr(output, "SnTuple_ls _tuple"));
+
+    arena_free(&arena);
+
+    DEBUG_INFO("Finished test_code_gen_tuple_literal_typedef");
+}
+
+void test_code_gen_line_directives_per_line()
+{
+    DEBUG_INFO("\n*** Testing code_gen #line directives on every emitted line...\n");
+
+    Arena arena;
+    arena_init(&arena, 4096);
+    const char *source =
+        "fn main():void =>\n"
+        "  for var i:int = 0; i < 3; i++ =>\n"
+        "    var s:str = $\"i={i}\"\n"
+        "  var (x, y) = (1, \"hi\")\n";
+    char *output = code_gen_test_emit(&arena, source);
+
+    // The increment and the body's cleanup come after the body but belong to the for.
+    assert(strstr(output, "#line 2 \"test.sn\"\nrt_post_inc_long(&i);\n") != NULL);
+    assert(strstr(output, "#line 2 \"test.sn\"\n    rt_free_string(s);\n") != NULL);
+    // Each destructured field is its own C line.
+    assert(strstr(output, "#line 4 \"test.sn\"\nlong x = ") != NULL);
+    assert(strstr(output, "#line 4 \"test.sn\"\nchar * y = ") != NULL);
+    // The epilogue maps to the declaration, line by line.
+    assert(strstr(output, "#line 1 \"test.sn\"\nmain_return:\n#line 1 \"test.sn\"\nif (y) {\n") != NULL);
+    assert(strstr(output, "#line 1 \"test.sn\"\n    return _return_value;\n") != NULL);
+    // Glue after the last function goes back to the generated file.
+    assert(strstr(output, "\"" CODE_GEN_TEST_OUTPUT "\"\n") != NULL);
+
+    arena_free(&arena);
+
+    DEBUG_INFO("Finished test_code_gen_line_directives_per_line");
+}
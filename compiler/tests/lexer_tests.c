@@ -339,6 +339,42 @@ void test_lexer_indentation() {
     DEBUG_INFO("Finished test_lexer_indentation");
 }
 
+void test_lexer_deep_indentation() {
+    DEBUG_INFO("\n*** Testing lexer deep indentation...\n");
+
+    // Deeper than the initial indent stack (8 levels), so it has to grow.
+    Arena arena;
+    arena_init(&arena, 4096);
+    char source[1024];
+    char *p = source;
+    int depth = 20;
+    for (int i = 0; i < depth; i++) {
+        p += sprintf(p, "%*sif x =>\n", i * 2, "");
+    }
+    p += sprintf(p, "%*sy\n", depth * 2, "");
+    // Dedenting back to a shallow level compares against the bottom of the stack.
+    sprintf(p, "  z\n");
+    Lexer lexer;
+    lexer_init(&arena, &lexer, source, "test");
+
+    int indents = 0;
+    int dedents = 0;
+    Token token;
+    do {
+        token = lexer_scan_token(&lexer);
+        assert(token.type != TOKEN_ERROR);
+        if (token.type == TOKEN_INDENT) indents++;
+        if (token.type == TOKEN_DEDENT) dedents++;
+    } while (token.type != TOKEN_EOF);
+    assert(indents == depth);
+    assert(dedents == depth);
+
+    lexer_cleanup(&lexer);
+    arena_free(&arena);
+
+    DEBUG_INFO("Finished test_lexer_deep_indentation");
+}
+
 void test_lexer_inconsistent_indent() {
     DEBUG_INFO("\n*** Testing lexer inconsistent indentation...\n");
 
@@ -513,12 +549,12 @@ void test_lexer_invalid_character() {
     Arena arena;
     arena_init(&arena, 1024);
     Lexer lexer;
-    const char *source = "@";
+    const char *source = "`";
     lexer_init(&arena, &lexer, source, "test");
 
     Token token = lexer_scan_token(&lexer);
     assert(token.type == TOKEN_ERROR);
-    //assert(strstr(token.lexeme, "Unexpected character '@'") != NULL);
+    //assert(strstr(token.lexeme, "Unexpected character '`'") != NULL);
 
     lexer_cleanup(&lexer);
     arena_free(&arena);
@@ -111,6 +111,238 @@ void test_function_no_params_parsing()
     cleanup_parser(&arena, &lexer, &parser, &symbol_table);
 }
 
+void test_function_annotation_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute function annotations...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source =
+        "@unchecked\n"
+        "fn fast(n:int):int =>\n"
+        "  return n + 1\n"
+        "@checked\n"
+        "fn safe(n:int):int =>\n"
+        "  return n - 1\n"
+        "fn plain():void =>\n"
+        "  return\n"
+        "@fastmath\n"
+        "@unchecked\n"
+        "fn dot(a:double, b:double):double =>\n"
+        "  return a * b\n"
+        "@memo(128)\n"
+        "fn square(n:int):int =>\n"
+        "  return n * n\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 5);
+    assert(module->statements[0]->type == STMT_FUNCTION);
+    assert(module->statements[0]->as.function.annotations == FUNC_ANNOTATION_UNCHECKED);
+    assert(module->statements[1]->type == STMT_FUNCTION);
+    assert(module->statements[1]->as.function.annotations == FUNC_ANNOTATION_CHECKED);
+    assert(module->statements[2]->type == STMT_FUNCTION);
+    assert(module->statements[2]->as.function.annotations == FUNC_ANNOTATION_NONE);
+    assert(module->statements[3]->type == STMT_FUNCTION);
+    assert(module->statements[3]->as.function.annotations == (FUNC_ANNOTATION_FASTMATH | FUNC_ANNOTATION_UNCHECKED));
+    assert(module->statements[3]->as.function.memo_limit == 0);
+    assert(module->statements[4]->as.function.annotations == FUNC_ANNOTATION_MEMO);
+    assert(module->statements[4]->as.function.memo_limit == 128);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
+void test_map_type_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute map types...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source =
+        "fn main():void =>\n"
+        "  var m: map<str, int>\n"
+        "  m.set(\"a\", 1)\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 1);
+    Stmt *fn = module->statements[0];
+    assert(fn->as.function.body_count == 2);
+    Stmt *decl = fn->as.function.body[0];
+    assert(decl->type == STMT_VAR_DECL);
+    assert(decl->as.var_decl.type->kind == TYPE_MAP);
+    assert(decl->as.var_decl.type->as.map.key_type->kind == TYPE_STRING);
+    assert(decl->as.var_decl.type->as.map.value_type->kind == TYPE_INT);
+    assert(decl->as.var_decl.initializer == NULL);
+    Stmt *set = fn->as.function.body[1];
+    assert(set->type == STMT_EXPR);
+    assert(set->as.expression.expression->type == EXPR_CALL);
+    assert(set->as.expression.expression->as.call.callee->type == EXPR_MEMBER);
+    assert(set->as.expression.expression->as.call.arg_count == 2);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
+void test_const_decl_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute const declarations...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source =
+        "const LIMIT: int = 10\n"
+        "const TABLE: int[] = {1, 2, 3}\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 2);
+    Stmt *limit = module->statements[0];
+    assert(limit->type == STMT_VAR_DECL);
+    assert(limit->as.var_decl.is_const);
+    assert(limit->as.var_decl.type->kind == TYPE_INT);
+    assert(limit->as.var_decl.initializer->as.literal.value.int_value == 10);
+    Stmt *table = module->statements[1];
+    assert(table->as.var_decl.is_const);
+    assert(table->as.var_decl.type->kind == TYPE_ARRAY);
+    assert(table->as.var_decl.initializer->type == EXPR_ARRAY);
+    assert(table->as.var_decl.initializer->as.array.element_count == 3);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
+void test_tuple_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute tuple returns and destructuring...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source =
+        "fn divmod(a: int, b: int): (int, int) =>\n"
+        "  return (a / b, a % b)\n"
+        "var (q, r) = divmod(7, 2)\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 2);
+    Stmt *fn = module->statements[0];
+    assert(fn->as.function.return_type->kind == TYPE_TUPLE);
+    assert(fn->as.function.return_type->as.tuple.element_count == 2);
+    Stmt *ret = fn->as.function.body[0];
+    assert(ret->as.return_stmt.value->type == EXPR_TUPLE);
+    assert(ret->as.return_stmt.value->as.tuple.element_count == 2);
+    Stmt *decl = module->statements[1];
+    assert(decl->type == STMT_VAR_TUPLE);
+    assert(decl->as.var_tuple.name_count == 2);
+    assert(strncmp(decl->as.var_tuple.names[1].start, "r", 1) == 0);
+    assert(decl->as.var_tuple.initializer->type == EXPR_CALL);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
+void test_ref_param_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute ref parameters...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source =
+        "fn bump(ref n: int, by: int): void =>\n"
+        "  n = n + by\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 1);
+    Stmt *fn = module->statements[0];
+    assert(fn->type == STMT_FUNCTION);
+    assert(fn->as.function.param_count == 2);
+    assert(fn->as.function.params[0].is_ref);
+    assert(!fn->as.function.params[1].is_ref);
+    assert(strncmp(fn->as.function.params[0].name.start, "n", 1) == 0);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
+void test_bench_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute bench block...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source =
+        "bench \"sum\" =>\n"
+        "  var total: int = 0\n"
+        "  total = total + 1\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 1);
+    Stmt *bench = module->statements[0];
+    assert(bench->type == STMT_BENCH);
+    assert(strcmp(bench->as.bench.name, "sum") == 0);
+    assert(bench->as.bench.body_count == 2);
+    assert(bench->as.bench.body[0]->type == STMT_VAR_DECL);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
+void test_match_statement_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute match statement...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source =
+        "match x =>\n"
+        "  1, 2 => print(\"small\\n\")\n"
+        "  3 =>\n"
+        "    print(\"three\\n\")\n"
+        "  else => print(\"other\\n\")\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 1);
+    Stmt *match = module->statements[0];
+    assert(match->type == STMT_MATCH);
+    assert(match->as.match_stmt.subject->type == EXPR_VARIABLE);
+    assert(match->as.match_stmt.case_count == 2);
+    assert(match->as.match_stmt.cases[0].value_count == 2);
+    assert(match->as.match_stmt.cases[0].values[1]->as.literal.value.int_value == 2);
+    assert(match->as.match_stmt.cases[0].body->type == STMT_EXPR);
+    assert(match->as.match_stmt.cases[1].value_count == 1);
+    assert(match->as.match_stmt.cases[1].body->type == STMT_BLOCK);
+    assert(match->as.match_stmt.else_branch != NULL);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
 void test_if_statement_parsing()
 {
     DEBUG_INFO("\n*** Testing parser_execute if statement...\n");
@@ -213,6 +445,30 @@ void test_while_loop_parsing()
     cleanup_parser(&arena, &lexer, &parser, &symbol_table);
 }
 
+void test_import_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute import...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source = "import \"lib/utils\"\nvar x:int = 1\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 2);
+    Stmt *import = module->statements[0];
+    assert(import->type == STMT_IMPORT);
+    assert(strcmp(import->as.import.module_name.start, "lib/utils") == 0);
+    assert(import->as.import.module_name.length == 9);
+    assert(module->statements[1]->type == STMT_VAR_DECL);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
 void test_for_loop_parsing()
 {
     DEBUG_INFO("\n*** Testing parser_execute for loop...\n");
@@ -291,6 +547,39 @@ void test_interpolated_string_parsing()
     cleanup_parser(&arena, &lexer, &parser, &symbol_table);
 }
 
+void test_interpolated_format_spec_parsing()
+{
+    DEBUG_INFO("\n*** Testing parser_execute interpolation format specs...\n");
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser;
+    SymbolTable symbol_table;
+    const char *source = "print($\"{{{n:08d}}} {d:*^10.2f} {s}\")\n";
+    setup_parser(&arena, &lexer, &parser, &symbol_table, source);
+
+    Module *module = parser_execute(&parser, "test.sn");
+
+    assert(module != NULL);
+    assert(module->count == 1);
+    Expr *arg = module->statements[0]->as.expression.expression->as.call.arguments[0];
+    assert(arg->type == EXPR_INTERPOLATED);
+    assert(arg->as.interpol.part_count == 6);
+    assert(strcmp(arg->as.interpol.parts[0]->as.literal.value.string_value, "{") == 0);
+    assert(arg->as.interpol.specs != NULL);
+    FormatSpec *zero_pad = arg->as.interpol.specs[1];
+    assert(zero_pad != NULL);
+    assert(zero_pad->fill == '0' && zero_pad->align == '=');
+    assert(zero_pad->width == 8 && zero_pad->conversion == 'd');
+    assert(strcmp(arg->as.interpol.parts[2]->as.literal.value.string_value, "} ") == 0);
+    FormatSpec *centered = arg->as.interpol.specs[3];
+    assert(centered->fill == '*' && centered->align == '^');
+    assert(centered->width == 10 && centered->precision == 2 && centered->conversion == 'f');
+    assert(arg->as.interpol.specs[5] == NULL);
+
+    cleanup_parser(&arena, &lexer, &parser, &symbol_table);
+}
+
 void test_literal_types_parsing()
 {
     DEBUG_INFO("\n*** Testing parser_execute various literals...\n");
@@ -101,6 +101,7 @@ void test_token_is_type_keyword()
     assert(token_is_type_keyword(TOKEN_STR) == 1);
     assert(token_is_type_keyword(TOKEN_BOOL) == 1);
     assert(token_is_type_keyword(TOKEN_VOID) == 1);
+    assert(token_is_type_keyword(TOKEN_MAP) == 1);
 
     // Negative cases
     assert(token_is_type_keyword(TOKEN_EOF) == 0);
@@ -260,6 +261,25 @@ void test_token_set_string_literal()
     cleanup_tokens(&arena);
 }
 
+void test_token_set_bool_literal()
+{
+    DEBUG_INFO("\n*** Testing token_set_bool_literal...\n");
+    Arena arena;
+    setup_tokens(&arena);
+
+    Token tok = create_test_token(&arena, TOKEN_BOOL_LITERAL, "true", 1, "test.sn");
+    token_set_bool_literal(&tok, 1);
+    assert(tok.literal.bool_value == 1);
+
+    token_set_bool_literal(&tok, 0);
+    assert(tok.literal.bool_value == 0);
+
+    assert(strcmp(token_type_to_string(TOKEN_BOOL_LITERAL), "BOOL_LITERAL") == 0);
+    token_print(&tok);
+
+    cleanup_tokens(&arena);
+}
+
 void test_token_type_to_string()
 {
     DEBUG_INFO("\n*** Testing token_type_to_string...\n");
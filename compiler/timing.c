@@ -0,0 +1,542 @@
+#include "timing.h"
+#include "debug.h"
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+PassTimer pass_timer;
+
+static const char *phase_names[PHASE_COUNT] = {
+    "read", "lex", "parse", "imports", "type-check", "code-gen"
+};
+
+void timing_init(TimingFormat format)
+{
+    DEBUG_VERBOSE("Entering timing_init");
+    memset(&pass_timer, 0, sizeof(pass_timer));
+    pass_timer.format = format;
+    pass_timer.current_module = -1;
+}
+
+// Opens hardware counters for --perf-counters; without them the report keeps
+// its timing columns and the counter columns are left out.
+void timing_enable_perf(void)
+{
+    DEBUG_VERBOSE("Entering timing_enable_perf");
+    if (pass_timer.format == TIMING_OFF)
+        return;
+    pass_timer.perf_requested = 1;
+    pass_timer.perf_enabled = perf_open();
+}
+
+void timing_cleanup(void)
+{
+    DEBUG_VERBOSE("Entering timing_cleanup");
+    if (pass_timer.perf_enabled)
+    {
+        perf_close();
+        pass_timer.perf_enabled = 0;
+    }
+}
+
+double timing_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void timing_begin(CompilerPhase phase, Arena *arena)
+{
+    if (pass_timer.format == TIMING_OFF || pass_timer.depth >= TIMING_MAX_DEPTH)
+        return;
+    TimingFrame *frame = &pass_timer.frames[pass_timer.depth++];
+    frame->phase = phase;
+    frame->arena_bytes = arena->total_allocated;
+    frame->child_seconds = 0.0;
+    frame->child_bytes = 0;
+    memset(&frame->child_counters, 0, sizeof(frame->child_counters));
+    if (pass_timer.perf_enabled)
+    {
+        perf_read(&frame->start_counters);
+    }
+    frame->start = timing_now();
+}
+
+// The process's max resident set so far, in kilobytes.
+static long timing_peak_rss_kb(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_maxrss; // Kilobytes on Linux
+}
+
+// Closes the innermost frame. Its self time goes to its phase (and to the
+// current module for per-file phases); its full time is charged to the parent
+// as child time, so nested phases are never counted twice.
+void timing_end(CompilerPhase phase, Arena *arena)
+{
+    if (pass_timer.format == TIMING_OFF || pass_timer.depth == 0)
+        return;
+    double now = timing_now();
+    PerfSample counters;
+    if (pass_timer.perf_enabled)
+    {
+        perf_read(&counters);
+    }
+    TimingFrame *frame = &pass_timer.frames[--pass_timer.depth];
+    if (frame->phase != phase)
+    {
+        DEBUG_ERROR("Mismatched timing phases: %s ended inside %s", phase_names[phase], phase_names[frame->phase]);
+        return;
+    }
+    double total = now - frame->start;
+    size_t bytes = arena->total_allocated - frame->arena_bytes;
+    PhaseStats *stats = &pass_timer.phases[phase];
+    stats->seconds += total - frame->child_seconds;
+    stats->arena_bytes += bytes - frame->child_bytes;
+    if (pass_timer.perf_enabled)
+    {
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+        {
+            counters.values[i] -= frame->start_counters.values[i];
+            stats->counters.values[i] += counters.values[i] - frame->child_counters.values[i];
+        }
+    }
+    stats->peak_rss_kb = timing_peak_rss_kb();
+    stats->arena_reserved = arena->total_reserved;
+    if (phase < PHASE_IMPORTS && pass_timer.current_module >= 0)
+    {
+        PhaseStats *module_stats = &pass_timer.modules[pass_timer.current_module].phases[phase];
+        module_stats->seconds += total - frame->child_seconds;
+        module_stats->arena_bytes += bytes - frame->child_bytes;
+    }
+    if (pass_timer.depth > 0)
+    {
+        TimingFrame *parent = &pass_timer.frames[pass_timer.depth - 1];
+        parent->child_seconds += total;
+        parent->child_bytes += bytes;
+        if (pass_timer.perf_enabled)
+        {
+            for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+                parent->child_counters.values[i] += counters.values[i];
+        }
+    }
+}
+
+void timing_lex_begin(Arena *arena)
+{
+    if (pass_timer.format == TIMING_OFF)
+        return;
+    pass_timer.lex_arena_bytes = arena->total_allocated;
+    pass_timer.lex_start = timing_now();
+}
+
+void timing_lex_end(Arena *arena)
+{
+    if (pass_timer.format == TIMING_OFF)
+        return;
+    double seconds = timing_now() - pass_timer.lex_start;
+    size_t bytes = arena->total_allocated - pass_timer.lex_arena_bytes;
+    PhaseStats *stats = &pass_timer.phases[PHASE_LEX];
+    stats->seconds += seconds;
+    stats->arena_bytes += bytes;
+    stats->tokens++;
+    if (pass_timer.current_module >= 0)
+    {
+        PhaseStats *module_stats = &pass_timer.modules[pass_timer.current_module].phases[PHASE_LEX];
+        module_stats->seconds += seconds;
+        module_stats->arena_bytes += bytes;
+        module_stats->tokens++;
+    }
+    if (pass_timer.depth > 0)
+    {
+        TimingFrame *parent = &pass_timer.frames[pass_timer.depth - 1];
+        parent->child_seconds += seconds;
+        parent->child_bytes += bytes;
+    }
+}
+
+void timing_begin_module(Arena *arena, const char *filename)
+{
+    if (pass_timer.format == TIMING_OFF)
+        return;
+    if (pass_timer.module_count >= pass_timer.module_capacity)
+    {
+        int new_capacity = pass_timer.module_capacity == 0 ? 8 : pass_timer.module_capacity * 2;
+        ModuleTiming *new_modules = arena_alloc(arena, sizeof(ModuleTiming) * new_capacity);
+        if (pass_timer.module_count > 0)
+        {
+            memcpy(new_modules, pass_timer.modules, sizeof(ModuleTiming) * pass_timer.module_count);
+        }
+        pass_timer.modules = new_modules;
+        pass_timer.module_capacity = new_capacity;
+    }
+    ModuleTiming *module = &pass_timer.modules[pass_timer.module_count];
+    memset(module, 0, sizeof(ModuleTiming));
+    module->filename = filename;
+    pass_timer.current_module = pass_timer.module_count++;
+}
+
+static long count_stmt_nodes(Stmt *stmt);
+
+static long count_expr_nodes(Expr *expr)
+{
+    if (expr == NULL)
+        return 0;
+    long count = 1;
+    switch (expr->type)
+    {
+    case EXPR_BINARY:
+        count += count_expr_nodes(expr->as.binary.left) + count_expr_nodes(expr->as.binary.right);
+        break;
+    case EXPR_UNARY:
+        count += count_expr_nodes(expr->as.unary.operand);
+        break;
+    case EXPR_ASSIGN:
+        count += count_expr_nodes(expr->as.assign.value);
+        break;
+    case EXPR_CALL:
+        count += count_expr_nodes(expr->as.call.callee);
+        for (int i = 0; i < expr->as.call.arg_count; i++)
+            count += count_expr_nodes(expr->as.call.arguments[i]);
+        break;
+    case EXPR_ARRAY:
+        for (int i = 0; i < expr->as.array.element_count; i++)
+            count += count_expr_nodes(expr->as.array.elements[i]);
+        break;
+    case EXPR_ARRAY_ACCESS:
+        count += count_expr_nodes(expr->as.array_access.array) + count_expr_nodes(expr->as.array_access.index);
+        break;
+    case EXPR_INCREMENT:
+    case EXPR_DECREMENT:
+        count += count_expr_nodes(expr->as.operand);
+        break;
+    case EXPR_INTERPOLATED:
+        for (int i = 0; i < expr->as.interpol.part_count; i++)
+            count += count_expr_nodes(expr->as.interpol.parts[i]);
+        break;
+    case EXPR_MEMBER:
+        count += count_expr_nodes(expr->as.member.object);
+        break;
+    case EXPR_TUPLE:
+        for (int i = 0; i < expr->as.tuple.element_count; i++)
+            count += count_expr_nodes(expr->as.tuple.elements[i]);
+        break;
+    default:
+        break;
+    }
+    return count;
+}
+
+static long count_stmt_list_nodes(Stmt **statements, int count)
+{
+    long total = 0;
+    for (int i = 0; i < count; i++)
+        total += count_stmt_nodes(statements[i]);
+    return total;
+}
+
+static long count_stmt_nodes(Stmt *stmt)
+{
+    if (stmt == NULL)
+        return 0;
+    long count = 1;
+    switch (stmt->type)
+    {
+    case STMT_EXPR:
+        count += count_expr_nodes(stmt->as.expression.expression);
+        break;
+    case STMT_VAR_DECL:
+        count += count_expr_nodes(stmt->as.var_decl.initializer);
+        break;
+    case STMT_VAR_TUPLE:
+        count += count_expr_nodes(stmt->as.var_tuple.initializer);
+        break;
+    case STMT_FUNCTION:
+        count += count_stmt_list_nodes(stmt->as.function.body, stmt->as.function.body_count);
+        break;
+    case STMT_RETURN:
+        count += count_expr_nodes(stmt->as.return_stmt.value);
+        break;
+    case STMT_BLOCK:
+        count += count_stmt_list_nodes(stmt->as.block.statements, stmt->as.block.count);
+        break;
+    case STMT_IF:
+        count += count_expr_nodes(stmt->as.if_stmt.condition) + count_stmt_nodes(stmt->as.if_stmt.then_branch) +
+                 count_stmt_nodes(stmt->as.if_stmt.else_branch);
+        break;
+    case STMT_WHILE:
+        count += count_expr_nodes(stmt->as.while_stmt.condition) + count_stmt_nodes(stmt->as.while_stmt.body);
+        break;
+    case STMT_FOR:
+        count += count_stmt_nodes(stmt->as.for_stmt.initializer) + count_expr_nodes(stmt->as.for_stmt.condition) +
+                 count_expr_nodes(stmt->as.for_stmt.increment) + count_stmt_nodes(stmt->as.for_stmt.body);
+        break;
+    case STMT_MATCH:
+        count += count_expr_nodes(stmt->as.match_stmt.subject) + count_stmt_nodes(stmt->as.match_stmt.else_branch);
+        for (int i = 0; i < stmt->as.match_stmt.case_count; i++)
+        {
+            MatchCase *match_case = &stmt->as.match_stmt.cases[i];
+            for (int j = 0; j < match_case->value_count; j++)
+                count += count_expr_nodes(match_case->values[j]);
+            count += count_stmt_nodes(match_case->body);
+        }
+        break;
+    case STMT_BENCH:
+        count += count_stmt_list_nodes(stmt->as.bench.body, stmt->as.bench.body_count);
+        break;
+    case STMT_IMPORT:
+        break;
+    }
+    return count;
+}
+
+// Credits the nodes of a freshly parsed file (before imports are spliced in)
+// to both the parse phase and that file.
+void timing_count_module(Module *module, const char *source)
+{
+    if (pass_timer.format == TIMING_OFF || pass_timer.current_module < 0)
+        return;
+    long nodes = count_stmt_list_nodes(module->statements, module->count);
+    ModuleTiming *timing = &pass_timer.modules[pass_timer.current_module];
+    timing->source_bytes = strlen(source);
+    timing->source_lines = 0;
+    for (const char *c = source; *c; c++)
+    {
+        if (*c == '\n')
+            timing->source_lines++;
+    }
+    if (timing->source_bytes > 0 && source[timing->source_bytes - 1] != '\n')
+        timing->source_lines++;
+    pass_timer.source_lines += timing->source_lines;
+    timing->phases[PHASE_PARSE].nodes += nodes;
+    timing->phases[PHASE_PARSE].tokens = timing->phases[PHASE_LEX].tokens;
+    pass_timer.phases[PHASE_PARSE].nodes += nodes;
+    pass_timer.phases[PHASE_PARSE].tokens = pass_timer.phases[PHASE_LEX].tokens;
+}
+
+void timing_count_nodes(CompilerPhase phase, Module *module)
+{
+    if (pass_timer.format == TIMING_OFF)
+        return;
+    pass_timer.phases[phase].nodes = count_stmt_list_nodes(module->statements, module->count);
+}
+
+static double per_second(long count, double seconds)
+{
+    return seconds > 0.0 ? (double)count / seconds : 0.0;
+}
+
+// Lex and parse are normalised per token, later phases per AST node.
+static long per_unit_count(PhaseStats *stats, const char **unit)
+{
+    if (stats->tokens > 0)
+    {
+        *unit = "token";
+        return stats->tokens;
+    }
+    *unit = stats->nodes > 0 ? "node" : "-";
+    return stats->nodes;
+}
+
+static double counter_ratio(unsigned long long a, unsigned long long b)
+{
+    return b > 0 ? (double)a / (double)b : 0.0;
+}
+
+static void timing_report_counters_text(FILE *out)
+{
+    fprintf(out, "%-12s %14s %14s %6s %12s %12s %6s\n", "phase", "cycles", "instructions", "IPC",
+            "cache-miss/", "branch-miss/", "unit");
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        PhaseStats *stats = &pass_timer.phases[i];
+        if (i == PHASE_LEX)
+        {
+            fprintf(out, "%-12s %14s %14s %6s %12s %12s %6s\n", phase_names[i], "(in parse)", "-", "-", "-", "-", "");
+            continue;
+        }
+        unsigned long long *values = stats->counters.values;
+        const char *unit;
+        long units = per_unit_count(stats, &unit);
+        fprintf(out, "%-12s %14llu %14llu %6.2f ", phase_names[i], values[PERF_CYCLES], values[PERF_INSTRUCTIONS],
+                counter_ratio(values[PERF_INSTRUCTIONS], values[PERF_CYCLES]));
+        for (int counter = PERF_CACHE_MISSES; counter <= PERF_BRANCH_MISSES; counter++)
+        {
+            if (units > 0 && perf_available((PerfCounter)counter))
+                fprintf(out, "%12.3f ", counter_ratio(values[counter], (unsigned long long)units));
+            else
+                fprintf(out, "%12s ", "-");
+        }
+        fprintf(out, "%6s\n", unit);
+    }
+}
+
+typedef struct
+{
+    long peak_rss_kb;
+    size_t arena_reserved;
+    double arena_bytes_per_line;
+    double rss_bytes_per_line;
+} MemorySummary;
+
+// Arena reservation only grows, so the largest value seen at a phase end is
+// the high-water mark for the whole compile.
+static MemorySummary timing_memory_summary(void)
+{
+    MemorySummary memory;
+    memory.peak_rss_kb = timing_peak_rss_kb();
+    memory.arena_reserved = 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        if (pass_timer.phases[i].arena_reserved > memory.arena_reserved)
+            memory.arena_reserved = pass_timer.phases[i].arena_reserved;
+    }
+    long lines = pass_timer.source_lines > 0 ? pass_timer.source_lines : 1;
+    memory.arena_bytes_per_line = (double)memory.arena_reserved / lines;
+    memory.rss_bytes_per_line = memory.peak_rss_kb * 1024.0 / lines;
+    return memory;
+}
+
+static void timing_report_text(FILE *out)
+{
+    double total_seconds = 0.0;
+    size_t total_bytes = 0;
+    fprintf(out, "%-12s %10s %14s %14s %12s %14s %14s\n", "phase", "time (ms)", "tokens/s", "nodes/s", "arena KiB",
+            "peak RSS KiB", "arena hw KiB");
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        PhaseStats *stats = &pass_timer.phases[i];
+        total_seconds += stats->seconds;
+        total_bytes += stats->arena_bytes;
+        fprintf(out, "%-12s %10.3f ", phase_names[i], stats->seconds * 1e3);
+        if (stats->tokens > 0)
+            fprintf(out, "%14.0f ", per_second(stats->tokens, stats->seconds));
+        else
+            fprintf(out, "%14s ", "-");
+        if (stats->nodes > 0)
+            fprintf(out, "%14.0f ", per_second(stats->nodes, stats->seconds));
+        else
+            fprintf(out, "%14s ", "-");
+        fprintf(out, "%12.1f ", stats->arena_bytes / 1024.0);
+        if (stats->peak_rss_kb > 0)
+            fprintf(out, "%14ld %14.1f\n", stats->peak_rss_kb, stats->arena_reserved / 1024.0);
+        else
+            fprintf(out, "%14s %14s\n", "-", "-");
+    }
+    fprintf(out, "%-12s %10.3f %14s %14s %12.1f\n", "total", total_seconds * 1e3, "", "", total_bytes / 1024.0);
+    MemorySummary memory = timing_memory_summary();
+    fprintf(out, "memory: peak RSS %ld KiB, arena %.1f KiB reserved, %ld source lines, %.0f arena bytes/line, %.0f RSS bytes/line\n",
+            memory.peak_rss_kb, memory.arena_reserved / 1024.0, pass_timer.source_lines, memory.arena_bytes_per_line,
+            memory.rss_bytes_per_line);
+    if (pass_timer.perf_enabled)
+    {
+        timing_report_counters_text(out);
+    }
+    else if (pass_timer.perf_requested)
+    {
+        fprintf(out, "hardware counters unavailable (see -l 2 for the reason)\n");
+    }
+    for (int i = 0; i < pass_timer.module_count; i++)
+    {
+        ModuleTiming *module = &pass_timer.modules[i];
+        fprintf(out, "module %s: %zu bytes, read %.3f ms, lex %.3f ms (%ld tokens), parse %.3f ms (%ld nodes)\n",
+                module->filename, module->source_bytes, module->phases[PHASE_READ].seconds * 1e3,
+                module->phases[PHASE_LEX].seconds * 1e3, module->phases[PHASE_LEX].tokens,
+                module->phases[PHASE_PARSE].seconds * 1e3, module->phases[PHASE_PARSE].nodes);
+    }
+}
+
+static void timing_json_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf(out, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(out, "\\u%04x", c);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static void timing_json_phase(FILE *out, PhaseStats *stats)
+{
+    fprintf(out, "\"seconds\": %.9f, \"tokens\": %ld, \"nodes\": %ld, \"arena_bytes\": %zu, "
+                 "\"tokens_per_second\": %.1f, \"nodes_per_second\": %.1f",
+            stats->seconds, stats->tokens, stats->nodes, stats->arena_bytes,
+            per_second(stats->tokens, stats->seconds), per_second(stats->nodes, stats->seconds));
+}
+
+static void timing_json_counters(FILE *out, PhaseStats *stats)
+{
+    fprintf(out, ", \"counters\": {");
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        fprintf(out, "%s\"%s\": ", i > 0 ? ", " : "", perf_counter_name((PerfCounter)i));
+        if (perf_available((PerfCounter)i))
+            fprintf(out, "%llu", stats->counters.values[i]);
+        else
+            fprintf(out, "null");
+    }
+    fprintf(out, ", \"ipc\": %.3f}",
+            counter_ratio(stats->counters.values[PERF_INSTRUCTIONS], stats->counters.values[PERF_CYCLES]));
+}
+
+static void timing_report_json(FILE *out)
+{
+    double total_seconds = 0.0;
+    fprintf(out, "{\"phases\": [");
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        total_seconds += pass_timer.phases[i].seconds;
+        fprintf(out, "%s{\"name\": \"%s\", ", i > 0 ? ", " : "", phase_names[i]);
+        timing_json_phase(out, &pass_timer.phases[i]);
+        fprintf(out, ", \"peak_rss_kb\": %ld, \"arena_reserved_bytes\": %zu", pass_timer.phases[i].peak_rss_kb,
+                pass_timer.phases[i].arena_reserved);
+        if (pass_timer.perf_enabled && i != PHASE_LEX)
+        {
+            timing_json_counters(out, &pass_timer.phases[i]);
+        }
+        else if (pass_timer.perf_requested)
+        {
+            fprintf(out, ", \"counters\": null");
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "], \"modules\": [");
+    for (int i = 0; i < pass_timer.module_count; i++)
+    {
+        ModuleTiming *module = &pass_timer.modules[i];
+        fprintf(out, "%s{\"file\": ", i > 0 ? ", " : "");
+        timing_json_string(out, module->filename);
+        fprintf(out, ", \"source_bytes\": %zu, \"source_lines\": %ld", module->source_bytes, module->source_lines);
+        for (int phase = 0; phase < PHASE_IMPORTS; phase++)
+        {
+            fprintf(out, ", \"%s\": {", phase_names[phase]);
+            timing_json_phase(out, &module->phases[phase]);
+            fprintf(out, "}");
+        }
+        fprintf(out, "}");
+    }
+    MemorySummary memory = timing_memory_summary();
+    fprintf(out, "], \"memory\": {\"peak_rss_kb\": %ld, \"arena_reserved_bytes\": %zu, \"source_lines\": %ld, "
+                 "\"arena_bytes_per_line\": %.1f, \"rss_bytes_per_line\": %.1f}",
+            memory.peak_rss_kb, memory.arena_reserved, pass_timer.source_lines, memory.arena_bytes_per_line,
+            memory.rss_bytes_per_line);
+    fprintf(out, ", \"total_seconds\": %.9f}\n", total_seconds);
+}
+
+void timing_report(FILE *out)
+{
+    DEBUG_VERBOSE("Entering timing_report");
+    if (pass_timer.format == TIMING_TEXT)
+        timing_report_text(out);
+    else if (pass_timer.format == TIMING_JSON)
+        timing_report_json(out);
+}
@@ -0,0 +1,97 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include "arena.h"
+#include "ast.h"
+#include "perf.h"
+#include <stdio.h>
+
+typedef enum
+{
+    TIMING_OFF,
+    TIMING_TEXT,
+    TIMING_JSON
+} TimingFormat;
+
+typedef enum
+{
+    PHASE_READ,
+    PHASE_LEX,
+    PHASE_PARSE,
+    PHASE_IMPORTS,
+    PHASE_TYPE_CHECK,
+    PHASE_CODE_GEN,
+    PHASE_COUNT
+} CompilerPhase;
+
+typedef struct
+{
+    double seconds;        // Self time: phases timed inside this one are excluded
+    long tokens;           // Tokens scanned (lex) or consumed (parse)
+    long nodes;            // AST nodes produced or visited
+    size_t arena_bytes;    // Arena bytes allocated, also excluding nested phases
+    PerfSample counters;   // Hardware counter deltas, self only; zero unless --perf-counters
+    long peak_rss_kb;      // Process max RSS when the phase last ended (not tracked for lex)
+    size_t arena_reserved; // Arena block bytes held when the phase last ended
+} PhaseStats;
+
+typedef struct
+{
+    const char *filename;
+    size_t source_bytes;
+    long source_lines;
+    PhaseStats phases[PHASE_IMPORTS]; // Read, lex and parse of this file alone
+} ModuleTiming;
+
+typedef struct
+{
+    CompilerPhase phase;
+    double start;
+    size_t arena_bytes;
+    double child_seconds;
+    size_t child_bytes;
+    PerfSample start_counters;
+    PerfSample child_counters;
+} TimingFrame;
+
+#define TIMING_MAX_DEPTH 16
+
+typedef struct
+{
+    TimingFormat format;
+    int perf_requested;
+    int perf_enabled;
+    PhaseStats phases[PHASE_COUNT];
+    ModuleTiming *modules;
+    int module_count;
+    int module_capacity;
+    int current_module;
+    long source_lines; // All files, imports included
+    TimingFrame frames[TIMING_MAX_DEPTH];
+    int depth;
+    double lex_start; // Open token scan, see timing_lex_begin
+    size_t lex_arena_bytes;
+} PassTimer;
+
+/* Process-wide timer behind --time-passes; every hook is a no-op while the
+ * format is TIMING_OFF. */
+extern PassTimer pass_timer;
+
+void timing_init(TimingFormat format);
+void timing_enable_perf(void);
+void timing_cleanup(void);
+double timing_now(void);
+void timing_begin(CompilerPhase phase, Arena *arena);
+void timing_end(CompilerPhase phase, Arena *arena);
+/* Lexing is interleaved with parsing, one token at a time, so it has no frame:
+ * each scan only reads the clock and the arena, and its time and bytes are
+ * moved from the enclosing frame to the lex phase. Hardware counters are read
+ * at frame boundaries only, so lex counters stay in the enclosing phase. */
+void timing_lex_begin(Arena *arena);
+void timing_lex_end(Arena *arena);
+void timing_begin_module(Arena *arena, const char *filename);
+void timing_count_module(Module *module, const char *source);
+void timing_count_nodes(CompilerPhase phase, Module *module);
+void timing_report(FILE *out);
+
+#endif
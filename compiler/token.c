@@ -1,4 +1,5 @@
 // token.c
+#define DEBUG_CATEGORY DEBUG_CAT_LEXER
 #include "token.h"
 #include "debug.h"
 #include <stdio.h>
@@ -33,6 +34,7 @@ int token_is_type_keyword(TokenType type)
     case TOKEN_STR:
     case TOKEN_BOOL:
     case TOKEN_VOID:
+    case TOKEN_MAP:
         DEBUG_VERBOSE("Exiting token_is_type_keyword: returning 1");
         return 1;
     default:
@@ -114,6 +116,15 @@ void token_set_string_literal(Token *token, const char *value)
     DEBUG_VERBOSE("Exiting token_set_string_literal");
 }
 
+void token_set_bool_literal(Token *token, int value)
+{
+    DEBUG_VERBOSE("Entering token_set_bool_literal: value=%d", value);
+
+    token->literal.bool_value = value;
+
+    DEBUG_VERBOSE("Exiting token_set_bool_literal");
+}
+
 const char *token_type_to_string(TokenType type)
 {
     DEBUG_VERBOSE("Entering token_type_to_string: type=%d", type);
@@ -142,6 +153,9 @@ const char *token_type_to_string(TokenType type)
     case TOKEN_INTERPOL_STRING:
         result = "INTERPOL_STRING";
         break;
+    case TOKEN_BOOL_LITERAL:
+        result = "BOOL_LITERAL";
+        break;
     case TOKEN_TRUE:
         result = "TRUE";
         break;
@@ -220,6 +234,21 @@ const char *token_type_to_string(TokenType type)
     case TOKEN_VOID_ARRAY:
         result = "VOID_ARRAY";
         break;
+    case TOKEN_MAP:
+        result = "MAP";
+        break;
+    case TOKEN_MATCH:
+        result = "MATCH";
+        break;
+    case TOKEN_CONST:
+        result = "CONST";
+        break;
+    case TOKEN_REF:
+        result = "REF";
+        break;
+    case TOKEN_BENCH:
+        result = "BENCH";
+        break;
     case TOKEN_PLUS:
         result = "PLUS";
         break;
@@ -304,6 +333,9 @@ const char *token_type_to_string(TokenType type)
     case TOKEN_ARROW:
         result = "ARROW";
         break;
+    case TOKEN_AT:
+        result = "AT";
+        break;
     case TOKEN_INDENT:
         result = "INDENT";
         break;
@@ -354,6 +386,9 @@ void token_print(Token *token)
     case TOKEN_INTERPOL_STRING:
         DEBUG_VERBOSE(", value: \"%s\"", token->literal.string_value);
         break;
+    case TOKEN_BOOL_LITERAL:
+        DEBUG_VERBOSE(", value: %s", token->literal.bool_value ? "true" : "false");
+        break;
     case TOKEN_TRUE:
         DEBUG_VERBOSE(", value: true");
         break;
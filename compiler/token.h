@@ -16,6 +16,7 @@ typedef enum
     TOKEN_CHAR_LITERAL,
     TOKEN_STRING_LITERAL,
     TOKEN_INTERPOL_STRING,
+    TOKEN_BOOL_LITERAL,
     TOKEN_TRUE,
     TOKEN_FALSE,
     TOKEN_IDENTIFIER,
@@ -27,6 +28,11 @@ typedef enum
     TOKEN_FOR,
     TOKEN_WHILE,
     TOKEN_IMPORT,
+    TOKEN_MAP,
+    TOKEN_MATCH,
+    TOKEN_CONST,
+    TOKEN_REF,
+    TOKEN_BENCH,
     TOKEN_NIL,
     TOKEN_INT,
     TOKEN_LONG,
@@ -70,6 +76,7 @@ typedef enum
     TOKEN_COMMA,
     TOKEN_DOT,
     TOKEN_ARROW,
+    TOKEN_AT,
     TOKEN_ERROR
 } TokenType;
 
@@ -79,6 +86,7 @@ typedef union
     double double_value;
     char char_value;
     const char *string_value;
+    int bool_value;
 } LiteralValue;
 
 typedef struct
@@ -98,6 +106,7 @@ void token_set_int_literal(Token *token, int64_t value);
 void token_set_double_literal(Token *token, double value);
 void token_set_char_literal(Token *token, char value);
 void token_set_string_literal(Token *token, const char *value);
+void token_set_bool_literal(Token *token, int value);
 const char *token_type_to_string(TokenType type);
 void token_print(Token *token);
 
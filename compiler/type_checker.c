@@ -13,6 +13,8 @@ static void type_check_stmt(Stmt *stmt, SymbolTable *table, Type *return_type);
 
 static Type *type_check_expr(Expr *expr, SymbolTable *table);
 
+static bool token_equals(Token a, Token b);
+
 static void type_error(Token *token, const char *msg)
 {
     char error_buffer[256];
@@ -137,6 +139,96 @@ static Type *type_check_unary(Expr *expr, SymbolTable *table)
     return NULL;
 }
 
+/* Checks a format spec against the type of its hole and fills in the
+ * defaults, so code generation only ever sees a complete spec. */
+static bool type_check_format_spec(Expr *expr, FormatSpec *spec, Type *type)
+{
+    bool integral = type->kind == TYPE_INT || type->kind == TYPE_LONG;
+    bool numeric = integral || type->kind == TYPE_DOUBLE;
+    if (spec->conversion == 0)
+    {
+        switch (type->kind)
+        {
+        case TYPE_DOUBLE:
+            spec->conversion = 'f';
+            break;
+        case TYPE_CHAR:
+            spec->conversion = 'c';
+            break;
+        case TYPE_STRING:
+        case TYPE_BOOL:
+            spec->conversion = 's';
+            break;
+        default:
+            spec->conversion = 'd';
+            break;
+        }
+    }
+    switch (spec->conversion)
+    {
+    case 'd':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'b':
+        if (!integral)
+        {
+            type_error(expr->token, "Integer format spec used with a non-integer value");
+            return false;
+        }
+        break;
+    case 'f':
+        if (type->kind != TYPE_DOUBLE)
+        {
+            type_error(expr->token, "'f' format spec requires a double");
+            return false;
+        }
+        break;
+    case 's':
+        if (type->kind != TYPE_STRING && type->kind != TYPE_BOOL)
+        {
+            type_error(expr->token, "'s' format spec requires a str or bool");
+            return false;
+        }
+        break;
+    case 'c':
+        if (type->kind != TYPE_CHAR)
+        {
+            type_error(expr->token, "'c' format spec requires a char");
+            return false;
+        }
+        break;
+    }
+    if (!numeric && (spec->plus || spec->align == '='))
+    {
+        type_error(expr->token, "Sign and zero padding require a numeric value");
+        return false;
+    }
+    if (spec->precision >= 0 && spec->conversion != 'f' && spec->conversion != 's')
+    {
+        type_error(expr->token, "Precision is only allowed for doubles and strings");
+        return false;
+    }
+    if (spec->conversion == 'f')
+    {
+        if (spec->precision > 20)
+        {
+            type_error(expr->token, "Double precision must be at most 20");
+            return false;
+        }
+        if (spec->precision < 0)
+        {
+            // Same number of digits as an unformatted double.
+            spec->precision = 5;
+        }
+    }
+    if (spec->align == 0)
+    {
+        spec->align = numeric ? '>' : '<';
+    }
+    return true;
+}
+
 static Type *type_check_interpolated(Expr *expr, SymbolTable *table)
 {
     for (int i = 0; i < expr->as.interpol.part_count; i++)
@@ -152,6 +244,11 @@ static Type *type_check_interpolated(Expr *expr, SymbolTable *table)
             type_error(expr->token, "Non-printable type in interpolated string");
             return NULL;
         }
+        if (expr->as.interpol.specs && expr->as.interpol.specs[i] &&
+            !type_check_format_spec(expr, expr->as.interpol.specs[i], part_type))
+        {
+            return NULL;
+        }
     }
     return ast_create_primitive_type(table->arena, TYPE_STRING);
 }
@@ -175,6 +272,13 @@ static Type *type_check_variable(Expr *expr, SymbolTable *table)
         type_error(&expr->as.variable.name, "Symbol has no type");
         return NULL;
     }
+    if (sym->const_value && sym->const_value->type == EXPR_LITERAL)
+    {
+        // Scalar consts have no storage; every read becomes the folded literal.
+        Token *token = expr->token;
+        *expr = *sym->const_value;
+        expr->token = token;
+    }
     return ast_clone_type(table->arena, sym->type);
 }
 
@@ -192,14 +296,122 @@ static Type *type_check_assign(Expr *expr, SymbolTable *table)
         type_error(&expr->as.assign.name, "Undefined variable for assignment");
         return NULL;
     }
+    if (sym->const_value)
+    {
+        type_error(&expr->as.assign.name, "Cannot assign to a const");
+        return NULL;
+    }
     if (!ast_type_equals(sym->type, value_type))
     {
         type_error(&expr->as.assign.name, "Type mismatch in assignment");
         return NULL;
     }
+    if (sym->type->kind == TYPE_MAP)
+    {
+        type_error(&expr->as.assign.name, "Maps cannot be reassigned");
+        return NULL;
+    }
     return ast_clone_type(table->arena, sym->type);
 }
 
+static bool expr_mentions(Expr *expr, Token name)
+{
+    if (expr == NULL)
+        return false;
+    switch (expr->type)
+    {
+    case EXPR_VARIABLE:
+        return token_equals(expr->as.variable.name, name);
+    case EXPR_ASSIGN:
+        return token_equals(expr->as.assign.name, name) || expr_mentions(expr->as.assign.value, name);
+    case EXPR_BINARY:
+        return expr_mentions(expr->as.binary.left, name) || expr_mentions(expr->as.binary.right, name);
+    case EXPR_UNARY:
+        return expr_mentions(expr->as.unary.operand, name);
+    case EXPR_CALL:
+        if (expr_mentions(expr->as.call.callee, name))
+            return true;
+        for (int i = 0; i < expr->as.call.arg_count; i++)
+        {
+            if (expr_mentions(expr->as.call.arguments[i], name))
+                return true;
+        }
+        return false;
+    case EXPR_ARRAY:
+        for (int i = 0; i < expr->as.array.element_count; i++)
+        {
+            if (expr_mentions(expr->as.array.elements[i], name))
+                return true;
+        }
+        return false;
+    case EXPR_ARRAY_ACCESS:
+        return expr_mentions(expr->as.array_access.array, name) || expr_mentions(expr->as.array_access.index, name);
+    case EXPR_INCREMENT:
+    case EXPR_DECREMENT:
+        return expr_mentions(expr->as.operand, name);
+    case EXPR_INTERPOLATED:
+        for (int i = 0; i < expr->as.interpol.part_count; i++)
+        {
+            if (expr_mentions(expr->as.interpol.parts[i], name))
+                return true;
+        }
+        return false;
+    case EXPR_MEMBER:
+        return expr_mentions(expr->as.member.object, name);
+    case EXPR_TUPLE:
+        for (int i = 0; i < expr->as.tuple.element_count; i++)
+        {
+            if (expr_mentions(expr->as.tuple.elements[i], name))
+                return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+/* A ref argument must name a mutable local or another ref parameter of the
+ * caller, and may not be read or written by any other argument of the call. */
+static bool type_check_ref_argument(Expr *call, int index, Type *param_type, SymbolTable *table)
+{
+    Expr *arg = call->as.call.arguments[index];
+    if (arg->type != EXPR_VARIABLE)
+    {
+        type_error(arg->token, "ref arguments must be variables");
+        return false;
+    }
+    Symbol *sym = symbol_table_lookup_symbol(table, arg->as.variable.name);
+    if (sym == NULL)
+    {
+        type_error(arg->token, "Undefined variable");
+        return false;
+    }
+    if (sym->const_value != NULL || sym->kind == SYMBOL_GLOBAL)
+    {
+        type_error(arg->token, "Cannot pass a const or global by ref");
+        return false;
+    }
+    if (sym->kind != SYMBOL_LOCAL && sym->kind != SYMBOL_REF_PARAM)
+    {
+        type_error(arg->token, "ref arguments must be locals or ref parameters");
+        return false;
+    }
+    if (!ast_type_equals(sym->type, param_type))
+    {
+        type_error(arg->token, "ref argument type must match the parameter exactly");
+        return false;
+    }
+    for (int j = 0; j < call->as.call.arg_count; j++)
+    {
+        if (j != index && expr_mentions(call->as.call.arguments[j], arg->as.variable.name))
+        {
+            type_error(arg->token, "ref argument aliases another argument of the same call");
+            return false;
+        }
+    }
+    return true;
+}
+
 static Type *type_check_call(Expr *expr, SymbolTable *table)
 {
     Type *callee_type = type_check_expr(expr->as.call.callee, table);
@@ -220,6 +432,12 @@ static Type *type_check_call(Expr *expr, SymbolTable *table)
     }
     for (int i = 0; i < expr->as.call.arg_count; i++)
     {
+        // Ref arguments are checked before type_check_expr folds const reads away.
+        if (callee_type->as.function.param_refs && callee_type->as.function.param_refs[i] &&
+            !type_check_ref_argument(expr, i, callee_type->as.function.param_types[i], table))
+        {
+            return NULL;
+        }
         Type *arg_type = type_check_expr(expr->as.call.arguments[i], table);
         if (arg_type == NULL)
         {
@@ -292,6 +510,62 @@ static Type *type_check_array_access(Expr *expr, SymbolTable *table)
     return ast_clone_type(table->arena, array_type->as.array.element_type);
 }
 
+static Type *type_check_tuple(Expr *expr, SymbolTable *table)
+{
+    int count = expr->as.tuple.element_count;
+    Type **element_types = arena_alloc(table->arena, sizeof(Type *) * count);
+    for (int i = 0; i < count; i++)
+    {
+        Type *t = type_check_expr(expr->as.tuple.elements[i], table);
+        if (t == NULL)
+            return NULL;
+        if (!is_printable_type(t))
+        {
+            type_error(expr->as.tuple.elements[i]->token, "Tuple elements must be a primitive or str");
+            return NULL;
+        }
+        element_types[i] = ast_clone_type(table->arena, t);
+    }
+    return ast_create_tuple_type(table->arena, element_types, count);
+}
+
+static bool is_map_key_type(Type *type)
+{
+    return type && (type->kind == TYPE_INT || type->kind == TYPE_LONG || type->kind == TYPE_CHAR ||
+                    type->kind == TYPE_BOOL || type->kind == TYPE_STRING);
+}
+
+static Type *type_check_map_member(Expr *expr, Type *map_type, SymbolTable *table)
+{
+    Type *key_type = ast_clone_type(table->arena, map_type->as.map.key_type);
+    Type *value_type = ast_clone_type(table->arena, map_type->as.map.value_type);
+    Type *int_type = ast_create_primitive_type(table->arena, TYPE_INT);
+    Type *bool_type = ast_create_primitive_type(table->arena, TYPE_BOOL);
+    Type *void_type = ast_create_primitive_type(table->arena, TYPE_VOID);
+    Type *key_param[1] = {key_type};
+    Type *entry_params[2] = {key_type, value_type};
+    Type *index_param[1] = {int_type};
+
+    const char *member_name = expr->as.member.name.start;
+    if (strcmp(member_name, "length") == 0)
+        return int_type;
+    if (strcmp(member_name, "get") == 0)
+        return ast_create_function_type(table->arena, value_type, key_param, 1);
+    if (strcmp(member_name, "set") == 0)
+        return ast_create_function_type(table->arena, void_type, entry_params, 2);
+    if (strcmp(member_name, "remove") == 0 || strcmp(member_name, "contains") == 0)
+        return ast_create_function_type(table->arena, bool_type, key_param, 1);
+    if (strcmp(member_name, "key_at") == 0)
+        return ast_create_function_type(table->arena, key_type, index_param, 1);
+    if (strcmp(member_name, "value_at") == 0)
+        return ast_create_function_type(table->arena, value_type, index_param, 1);
+
+    char msg[256];
+    snprintf(msg, sizeof(msg), "Unknown map member '%s'", member_name);
+    type_error(expr->token, msg);
+    return NULL;
+}
+
 static Type *type_check_member(Expr *expr, SymbolTable *table)
 {
     Type *object_type = type_check_expr(expr->as.member.object, table);
@@ -301,6 +575,11 @@ static Type *type_check_member(Expr *expr, SymbolTable *table)
         return NULL;
     }
 
+    if (object_type->kind == TYPE_MAP)
+    {
+        return type_check_map_member(expr, object_type, table);
+    }
+
     if (object_type->kind != TYPE_ARRAY)
     {
         type_error(expr->token, "Member access on non-array type");
@@ -314,6 +593,15 @@ static Type *type_check_member(Expr *expr, SymbolTable *table)
     }
     else if (strcmp(member_name, "push") == 0)
     {
+        if (expr->as.member.object->type == EXPR_VARIABLE)
+        {
+            Symbol *sym = symbol_table_lookup_symbol(table, expr->as.member.object->as.variable.name);
+            if (sym && sym->const_value)
+            {
+                type_error(expr->token, "Cannot push to a const array");
+                return NULL;
+            }
+        }
         Type *param_types[1] = {ast_clone_type(table->arena, object_type->as.array.element_type)};
         Type *void_type = ast_create_primitive_type(table->arena, TYPE_VOID);
         return ast_create_function_type(table->arena, void_type, param_types, 1);
@@ -363,6 +651,15 @@ Type *type_check_expr(Expr *expr, SymbolTable *table)
     case EXPR_INCREMENT:
     case EXPR_DECREMENT:
     {
+        if (expr->as.operand->type == EXPR_VARIABLE)
+        {
+            Symbol *sym = symbol_table_lookup_symbol(table, expr->as.operand->as.variable.name);
+            if (sym && sym->const_value)
+            {
+                type_error(expr->token, "Cannot modify a const");
+                break;
+            }
+        }
         Type *operand_type = type_check_expr(expr->as.operand, table);
         t = ast_clone_type(table->arena, operand_type);
         if (operand_type == NULL || !is_numeric_type(operand_type))
@@ -378,15 +675,295 @@ Type *type_check_expr(Expr *expr, SymbolTable *table)
     case EXPR_MEMBER:
         t = type_check_member(expr, table);
         break;
+    case EXPR_TUPLE:
+        t = type_check_tuple(expr, table);
+        break;
     }
     expr->expr_type = t;
     return t;
 }
 
+static Expr *const_literal(SymbolTable *table, Expr *expr, TypeKind kind, LiteralValue value)
+{
+    Type *type = ast_create_primitive_type(table->arena, kind);
+    Expr *result = ast_create_literal_expr(table->arena, value, type, false, expr->token);
+    result->expr_type = type;
+    return result;
+}
+
+static bool const_compare(TokenType op, int cmp)
+{
+    switch (op)
+    {
+    case TOKEN_EQUAL_EQUAL:
+        return cmp == 0;
+    case TOKEN_BANG_EQUAL:
+        return cmp != 0;
+    case TOKEN_LESS:
+        return cmp < 0;
+    case TOKEN_LESS_EQUAL:
+        return cmp <= 0;
+    case TOKEN_GREATER:
+        return cmp > 0;
+    default:
+        return cmp >= 0;
+    }
+}
+
+static Expr *const_fold(Expr *expr, SymbolTable *table);
+
+static Expr *const_fold_binary(Expr *expr, SymbolTable *table)
+{
+    Expr *left = const_fold(expr->as.binary.left, table);
+    Expr *right = const_fold(expr->as.binary.right, table);
+    if (left == NULL || right == NULL)
+        return NULL;
+    TokenType op = expr->as.binary.operator;
+    TypeKind kind = left->as.literal.type->kind;
+    LiteralValue a = left->as.literal.value;
+    LiteralValue b = right->as.literal.value;
+    LiteralValue result;
+    memset(&result, 0, sizeof(result));
+
+    if (is_comparison_operator(op))
+    {
+        int cmp;
+        if (kind == TYPE_STRING)
+            cmp = strcmp(a.string_value, b.string_value);
+        else if (kind == TYPE_DOUBLE)
+            cmp = (a.double_value > b.double_value) - (a.double_value < b.double_value);
+        else if (kind == TYPE_CHAR)
+            cmp = (a.char_value > b.char_value) - (a.char_value < b.char_value);
+        else if (kind == TYPE_BOOL)
+            cmp = (a.bool_value > b.bool_value) - (a.bool_value < b.bool_value);
+        else
+            cmp = (a.int_value > b.int_value) - (a.int_value < b.int_value);
+        result.bool_value = const_compare(op, cmp);
+        return const_literal(table, expr, TYPE_BOOL, result);
+    }
+
+    if (kind == TYPE_STRING && op == TOKEN_PLUS && right->as.literal.type->kind == TYPE_STRING)
+    {
+        size_t left_len = strlen(a.string_value);
+        size_t right_len = strlen(b.string_value);
+        char *joined = arena_alloc(table->arena, left_len + right_len + 1);
+        memcpy(joined, a.string_value, left_len);
+        memcpy(joined + left_len, b.string_value, right_len + 1);
+        result.string_value = joined;
+        return const_literal(table, expr, TYPE_STRING, result);
+    }
+
+    if (kind == TYPE_DOUBLE)
+    {
+        switch (op)
+        {
+        case TOKEN_PLUS:
+            result.double_value = a.double_value + b.double_value;
+            break;
+        case TOKEN_MINUS:
+            result.double_value = a.double_value - b.double_value;
+            break;
+        case TOKEN_STAR:
+            result.double_value = a.double_value * b.double_value;
+            break;
+        case TOKEN_SLASH:
+            if (b.double_value == 0.0)
+            {
+                type_error(expr->token, "Division by zero in constant expression");
+                return NULL;
+            }
+            result.double_value = a.double_value / b.double_value;
+            break;
+        default:
+            type_error(expr->token, "Const initializer must be a compile-time constant");
+            return NULL;
+        }
+        return const_literal(table, expr, kind, result);
+    }
+
+    if (kind == TYPE_INT || kind == TYPE_LONG)
+    {
+        bool overflow = false;
+        switch (op)
+        {
+        case TOKEN_PLUS:
+            overflow = __builtin_add_overflow(a.int_value, b.int_value, &result.int_value);
+            break;
+        case TOKEN_MINUS:
+            overflow = __builtin_sub_overflow(a.int_value, b.int_value, &result.int_value);
+            break;
+        case TOKEN_STAR:
+            overflow = __builtin_mul_overflow(a.int_value, b.int_value, &result.int_value);
+            break;
+        case TOKEN_SLASH:
+        case TOKEN_MODULO:
+            if (b.int_value == 0)
+            {
+                type_error(expr->token, "Division by zero in constant expression");
+                return NULL;
+            }
+            overflow = a.int_value == INT64_MIN && b.int_value == -1;
+            if (!overflow)
+                result.int_value = op == TOKEN_SLASH ? a.int_value / b.int_value : a.int_value % b.int_value;
+            break;
+        default:
+            type_error(expr->token, "Const initializer must be a compile-time constant");
+            return NULL;
+        }
+        if (overflow)
+        {
+            type_error(expr->token, "Overflow in constant expression");
+            return NULL;
+        }
+        return const_literal(table, expr, kind, result);
+    }
+
+    type_error(expr->token, "Const initializer must be a compile-time constant");
+    return NULL;
+}
+
+/* Evaluates a type-checked const initializer to a literal, or reports an error and
+ * returns NULL if it depends on anything other than literals and other consts. */
+static Expr *const_fold(Expr *expr, SymbolTable *table)
+{
+    switch (expr->type)
+    {
+    case EXPR_LITERAL:
+        if (!expr->as.literal.is_interpolated)
+            return expr;
+        break;
+    case EXPR_UNARY:
+    {
+        Expr *operand = const_fold(expr->as.unary.operand, table);
+        if (operand == NULL)
+            return NULL;
+        TypeKind kind = operand->as.literal.type->kind;
+        LiteralValue value = operand->as.literal.value;
+        if (expr->as.unary.operator == TOKEN_BANG)
+        {
+            value.bool_value = !value.bool_value;
+        }
+        else if (kind == TYPE_DOUBLE)
+        {
+            value.double_value = -value.double_value;
+        }
+        else if (value.int_value == INT64_MIN)
+        {
+            type_error(expr->token, "Overflow in constant expression");
+            return NULL;
+        }
+        else
+        {
+            value.int_value = -value.int_value;
+        }
+        return const_literal(table, expr, kind, value);
+    }
+    case EXPR_BINARY:
+        return const_fold_binary(expr, table);
+    default:
+        break;
+    }
+    type_error(expr->token, "Const initializer must be a compile-time constant");
+    return NULL;
+}
+
+static void type_check_const_decl(Stmt *stmt, SymbolTable *table)
+{
+    VarDeclStmt *decl = &stmt->as.var_decl;
+    Type *type = decl->type;
+    Expr *value = NULL;
+    if (type->kind == TYPE_ARRAY)
+    {
+        Type *element_type = type->as.array.element_type;
+        if (!is_printable_type(element_type))
+        {
+            type_error(&decl->name, "Const arrays must hold primitives or str");
+        }
+        else if (decl->initializer->type != EXPR_ARRAY || decl->initializer->as.array.element_count == 0)
+        {
+            type_error(&decl->name, "Const array must be initialized with a non-empty array literal");
+        }
+        else
+        {
+            Type *init_type = type_check_expr(decl->initializer, table);
+            if (init_type && !ast_type_equals(init_type, type))
+            {
+                type_error(&decl->name, "Initializer type does not match variable type");
+            }
+            else if (init_type)
+            {
+                value = decl->initializer;
+                for (int i = 0; value && i < value->as.array.element_count; i++)
+                {
+                    Expr *element = const_fold(value->as.array.elements[i], table);
+                    value->as.array.elements[i] = element;
+                    if (element == NULL)
+                        value = NULL;
+                }
+            }
+        }
+    }
+    else if (!is_printable_type(type))
+    {
+        type_error(&decl->name, "Consts must be a primitive, str or array type");
+    }
+    else
+    {
+        Type *init_type = type_check_expr(decl->initializer, table);
+        if (init_type && !ast_type_equals(init_type, type))
+        {
+            type_error(&decl->name, "Initializer type does not match variable type");
+        }
+        else if (init_type)
+        {
+            value = const_fold(decl->initializer, table);
+            if (value)
+                decl->initializer = value;
+        }
+    }
+
+    // Consts have static storage wherever they are declared, so they are never
+    // freed at scope exit like locals.
+    symbol_table_add_symbol_with_kind(table, decl->name, type, SYMBOL_GLOBAL);
+    Symbol *sym = symbol_table_lookup_symbol_current(table, decl->name);
+    if (sym)
+    {
+        sym->const_value = value;
+    }
+}
+
 static void type_check_var_decl(Stmt *stmt, SymbolTable *table, Type *return_type)
 {
     (void)return_type;
     Type *init_type;
+    if (stmt->as.var_decl.is_const && stmt->as.var_decl.initializer)
+    {
+        type_check_const_decl(stmt, table);
+        return;
+    }
+    if (stmt->as.var_decl.type->kind == TYPE_MAP)
+    {
+        Type *map_type = stmt->as.var_decl.type;
+        if (!is_map_key_type(map_type->as.map.key_type))
+        {
+            type_error(&stmt->as.var_decl.name, "Map keys must be int, long, char, bool or str");
+        }
+        if (!is_printable_type(map_type->as.map.value_type))
+        {
+            type_error(&stmt->as.var_decl.name, "Map values must be a primitive or str");
+        }
+        if (stmt->as.var_decl.initializer)
+        {
+            type_error(&stmt->as.var_decl.name, "Map variables start empty and cannot have an initializer");
+        }
+        symbol_table_add_symbol_with_kind(table, stmt->as.var_decl.name, map_type, SYMBOL_LOCAL);
+        return;
+    }
+    if (stmt->as.var_decl.type->kind == TYPE_TUPLE)
+    {
+        type_error(&stmt->as.var_decl.name, "Tuples must be destructured with var (a, b) = ...");
+        return;
+    }
     if (stmt->as.var_decl.initializer)
     {
         init_type = type_check_expr(stmt->as.var_decl.initializer, table);
@@ -405,14 +982,375 @@ static void type_check_var_decl(Stmt *stmt, SymbolTable *table, Type *return_typ
                                       stmt->as.var_decl.type, SYMBOL_LOCAL);
 }
 
+/* Purity analysis for @memo. A function is pure when it only touches its own
+ * parameters and locals and only calls pure functions (or to_string). Recursive
+ * calls are optimistically assumed pure while they are being analysed, so a
+ * PurityContext (and its "pure" results) is only valid for a single query. */
+typedef struct
+{
+    Arena *arena;
+    Module *module;
+    int *impure;    // Per module statement: known to be impure
+    int *pure;      // Per module statement: proven pure during this query
+    int *visiting;  // Per module statement: currently on the analysis stack
+    Token *names;   // Names declared by the functions being analysed
+    int name_count;
+    int name_capacity;
+} PurityContext;
+
+static Module *checked_module = NULL;
+
+static bool purity_stmt(PurityContext *ctx, int base, Stmt *stmt);
+static bool purity_function(PurityContext *ctx, int index);
+
+static bool token_equals(Token a, Token b)
+{
+    return a.length == b.length && memcmp(a.start, b.start, a.length) == 0;
+}
+
+static void purity_declare(PurityContext *ctx, Token name)
+{
+    if (ctx->name_count >= ctx->name_capacity)
+    {
+        int new_capacity = ctx->name_capacity == 0 ? 16 : ctx->name_capacity * 2;
+        Token *names = arena_alloc(ctx->arena, sizeof(Token) * new_capacity);
+        if (ctx->name_count > 0)
+        {
+            memcpy(names, ctx->names, sizeof(Token) * ctx->name_count);
+        }
+        ctx->names = names;
+        ctx->name_capacity = new_capacity;
+    }
+    ctx->names[ctx->name_count++] = name;
+}
+
+static bool purity_is_local(PurityContext *ctx, int base, Token name)
+{
+    for (int i = ctx->name_count - 1; i >= base; i--)
+    {
+        if (token_equals(ctx->names[i], name))
+            return true;
+    }
+    return false;
+}
+
+static bool purity_is_const(PurityContext *ctx, Token name)
+{
+    for (int i = 0; i < ctx->module->count; i++)
+    {
+        Stmt *stmt = ctx->module->statements[i];
+        if (stmt->type == STMT_VAR_DECL && stmt->as.var_decl.is_const &&
+            token_equals(stmt->as.var_decl.name, name))
+            return true;
+    }
+    return false;
+}
+
+static int purity_find_function(PurityContext *ctx, Token name)
+{
+    for (int i = 0; i < ctx->module->count; i++)
+    {
+        Stmt *stmt = ctx->module->statements[i];
+        if (stmt->type == STMT_FUNCTION && token_equals(stmt->as.function.name, name))
+            return i;
+    }
+    return -1;
+}
+
+static bool purity_expr(PurityContext *ctx, int base, Expr *expr)
+{
+    if (expr == NULL)
+        return true;
+    switch (expr->type)
+    {
+    case EXPR_BINARY:
+        return purity_expr(ctx, base, expr->as.binary.left) &&
+               purity_expr(ctx, base, expr->as.binary.right);
+    case EXPR_UNARY:
+        return purity_expr(ctx, base, expr->as.unary.operand);
+    case EXPR_LITERAL:
+        return true;
+    case EXPR_VARIABLE:
+        return purity_is_local(ctx, base, expr->as.variable.name) ||
+               purity_is_const(ctx, expr->as.variable.name);
+    case EXPR_ASSIGN:
+        return purity_is_local(ctx, base, expr->as.assign.name) &&
+               purity_expr(ctx, base, expr->as.assign.value);
+    case EXPR_CALL:
+    {
+        for (int i = 0; i < expr->as.call.arg_count; i++)
+        {
+            if (!purity_expr(ctx, base, expr->as.call.arguments[i]))
+                return false;
+        }
+        Expr *callee = expr->as.call.callee;
+        if (callee->type == EXPR_MEMBER)
+        {
+            // Methods only mutate their receiver, so a local receiver is fine.
+            return purity_expr(ctx, base, callee->as.member.object);
+        }
+        if (callee->type != EXPR_VARIABLE || purity_is_local(ctx, base, callee->as.variable.name))
+            return false;
+        Token name = callee->as.variable.name;
+        if (name.length == 9 && memcmp(name.start, "to_string", 9) == 0)
+            return true;
+        int index = purity_find_function(ctx, name);
+        return index >= 0 && purity_function(ctx, index);
+    }
+    case EXPR_ARRAY:
+        for (int i = 0; i < expr->as.array.element_count; i++)
+        {
+            if (!purity_expr(ctx, base, expr->as.array.elements[i]))
+                return false;
+        }
+        return true;
+    case EXPR_ARRAY_ACCESS:
+        return purity_expr(ctx, base, expr->as.array_access.array) &&
+               purity_expr(ctx, base, expr->as.array_access.index);
+    case EXPR_INCREMENT:
+    case EXPR_DECREMENT:
+        return expr->as.operand->type == EXPR_VARIABLE &&
+               purity_is_local(ctx, base, expr->as.operand->as.variable.name);
+    case EXPR_INTERPOLATED:
+        for (int i = 0; i < expr->as.interpol.part_count; i++)
+        {
+            if (!purity_expr(ctx, base, expr->as.interpol.parts[i]))
+                return false;
+        }
+        return true;
+    case EXPR_MEMBER:
+        return purity_expr(ctx, base, expr->as.member.object);
+    case EXPR_TUPLE:
+        for (int i = 0; i < expr->as.tuple.element_count; i++)
+        {
+            if (!purity_expr(ctx, base, expr->as.tuple.elements[i]))
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool purity_stmt(PurityContext *ctx, int base, Stmt *stmt)
+{
+    if (stmt == NULL)
+        return true;
+    switch (stmt->type)
+    {
+    case STMT_EXPR:
+        return purity_expr(ctx, base, stmt->as.expression.expression);
+    case STMT_VAR_DECL:
+        if (!purity_expr(ctx, base, stmt->as.var_decl.initializer))
+            return false;
+        purity_declare(ctx, stmt->as.var_decl.name);
+        return true;
+    case STMT_VAR_TUPLE:
+        if (!purity_expr(ctx, base, stmt->as.var_tuple.initializer))
+            return false;
+        for (int i = 0; i < stmt->as.var_tuple.name_count; i++)
+        {
+            purity_declare(ctx, stmt->as.var_tuple.names[i]);
+        }
+        return true;
+    case STMT_RETURN:
+        return purity_expr(ctx, base, stmt->as.return_stmt.value);
+    case STMT_BLOCK:
+    {
+        int saved = ctx->name_count;
+        bool pure = true;
+        for (int i = 0; pure && i < stmt->as.block.count; i++)
+        {
+            pure = purity_stmt(ctx, base, stmt->as.block.statements[i]);
+        }
+        ctx->name_count = saved;
+        return pure;
+    }
+    case STMT_IF:
+        return purity_expr(ctx, base, stmt->as.if_stmt.condition) &&
+               purity_stmt(ctx, base, stmt->as.if_stmt.then_branch) &&
+               purity_stmt(ctx, base, stmt->as.if_stmt.else_branch);
+    case STMT_WHILE:
+        return purity_expr(ctx, base, stmt->as.while_stmt.condition) &&
+               purity_stmt(ctx, base, stmt->as.while_stmt.body);
+    case STMT_FOR:
+    {
+        int saved = ctx->name_count;
+        bool pure = purity_stmt(ctx, base, stmt->as.for_stmt.initializer) &&
+                    purity_expr(ctx, base, stmt->as.for_stmt.condition) &&
+                    purity_expr(ctx, base, stmt->as.for_stmt.increment) &&
+                    purity_stmt(ctx, base, stmt->as.for_stmt.body);
+        ctx->name_count = saved;
+        return pure;
+    }
+    case STMT_MATCH:
+    {
+        MatchStmt *match = &stmt->as.match_stmt;
+        if (!purity_expr(ctx, base, match->subject))
+            return false;
+        for (int i = 0; i < match->case_count; i++)
+        {
+            if (!purity_stmt(ctx, base, match->cases[i].body))
+                return false;
+        }
+        return purity_stmt(ctx, base, match->else_branch);
+    }
+    case STMT_IMPORT:
+        return true;
+    case STMT_FUNCTION:
+    case STMT_BENCH:
+        return false;
+    }
+    return false;
+}
+
+static bool purity_function(PurityContext *ctx, int index)
+{
+    if (ctx->impure[index])
+        return false;
+    if (ctx->visiting[index] || ctx->pure[index])
+        return true;
+
+    FunctionStmt *fn = &ctx->module->statements[index]->as.function;
+    int base = ctx->name_count;
+    ctx->visiting[index] = 1;
+    for (int i = 0; i < fn->param_count; i++)
+    {
+        purity_declare(ctx, fn->params[i].name);
+    }
+    bool pure = true;
+    for (int i = 0; pure && i < fn->body_count; i++)
+    {
+        pure = purity_stmt(ctx, base, fn->body[i]);
+    }
+    ctx->visiting[index] = 0;
+    ctx->name_count = base;
+
+    if (pure)
+        ctx->pure[index] = 1;
+    else
+        ctx->impure[index] = 1;
+    return pure;
+}
+
+static bool is_memo_key_type(Type *type)
+{
+    return type && (type->kind == TYPE_INT || type->kind == TYPE_LONG || type->kind == TYPE_CHAR ||
+                    type->kind == TYPE_BOOL || type->kind == TYPE_STRING);
+}
+
+static void type_check_memo(Stmt *stmt, SymbolTable *table)
+{
+    FunctionStmt *fn = &stmt->as.function;
+    for (int i = 0; i < fn->param_count; i++)
+    {
+        if (!is_memo_key_type(fn->params[i].type))
+        {
+            type_error(&fn->params[i].name, "@memo parameters must be int, long, char, bool or str");
+        }
+        if (fn->params[i].is_ref)
+        {
+            type_error(&fn->params[i].name, "@memo parameters cannot be ref");
+        }
+    }
+    if (!is_printable_type(fn->return_type))
+    {
+        type_error(&fn->name, "@memo functions must return a primitive or str value");
+    }
+    if (checked_module == NULL)
+        return;
+
+    int count = checked_module->count;
+    PurityContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.arena = table->arena;
+    ctx.module = checked_module;
+    ctx.impure = arena_alloc(table->arena, sizeof(int) * count);
+    ctx.pure = arena_alloc(table->arena, sizeof(int) * count);
+    ctx.visiting = arena_alloc(table->arena, sizeof(int) * count);
+    memset(ctx.impure, 0, sizeof(int) * count);
+    memset(ctx.pure, 0, sizeof(int) * count);
+    memset(ctx.visiting, 0, sizeof(int) * count);
+
+    int index = purity_find_function(&ctx, fn->name);
+    if (index < 0 || !purity_function(&ctx, index))
+    {
+        type_error(&fn->name, "@memo function must be pure (no printing, globals or impure calls)");
+    }
+}
+
+static void type_check_var_tuple(Stmt *stmt, SymbolTable *table)
+{
+    VarTupleStmt *decl = &stmt->as.var_tuple;
+    Type *init_type = type_check_expr(decl->initializer, table);
+    if (init_type == NULL)
+        return;
+    if (init_type->kind != TYPE_TUPLE)
+    {
+        type_error(stmt->token, "Destructuring declaration requires a tuple value");
+        return;
+    }
+    if (init_type->as.tuple.element_count != decl->name_count)
+    {
+        type_error(stmt->token, "Destructuring declaration name count does not match tuple size");
+        return;
+    }
+    for (int i = 0; i < decl->name_count; i++)
+    {
+        Token name = decl->names[i];
+        if (name.length == 1 && name.start[0] == '_')
+            continue;
+        for (int j = 0; j < i; j++)
+        {
+            if (token_equals(decl->names[j], name))
+            {
+                type_error(&decl->names[i], "Duplicate name in destructuring declaration");
+            }
+        }
+        symbol_table_add_symbol_with_kind(table, name, init_type->as.tuple.element_types[i], SYMBOL_LOCAL);
+    }
+}
+
 static void type_check_function(Stmt *stmt, SymbolTable *table)
 {
+    Type *return_type = stmt->as.function.return_type;
+    if (return_type && return_type->kind == TYPE_MAP)
+    {
+        type_error(&stmt->as.function.name, "Maps cannot be returned from functions");
+    }
+    if (return_type && return_type->kind == TYPE_TUPLE)
+    {
+        for (int i = 0; i < return_type->as.tuple.element_count; i++)
+        {
+            if (!is_printable_type(return_type->as.tuple.element_types[i]))
+            {
+                type_error(&stmt->as.function.name, "Tuple elements must be a primitive or str");
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < stmt->as.function.param_count; i++)
+    {
+        if (stmt->as.function.params[i].type->kind == TYPE_TUPLE)
+        {
+            type_error(&stmt->as.function.params[i].name, "Tuples cannot be passed as parameters");
+        }
+        else if (stmt->as.function.params[i].is_ref && !is_printable_type(stmt->as.function.params[i].type))
+        {
+            type_error(&stmt->as.function.params[i].name, "ref parameters must be a primitive or str");
+        }
+    }
+    if (stmt->as.function.annotations & FUNC_ANNOTATION_MEMO)
+    {
+        type_check_memo(stmt, table);
+    }
+
     symbol_table_push_scope(table);
 
     for (int i = 0; i < stmt->as.function.param_count; i++)
     {
         Parameter param = stmt->as.function.params[i];
-        symbol_table_add_symbol_with_kind(table, param.name, param.type, SYMBOL_PARAM);
+        symbol_table_add_symbol_with_kind(table, param.name, param.type,
+                                          param.is_ref ? SYMBOL_REF_PARAM : SYMBOL_PARAM);
     }
 
     table->current->next_local_offset = table->current->next_param_offset;
@@ -432,6 +1370,11 @@ static void type_check_return(Stmt *stmt, SymbolTable *table, Type *return_type)
         value_type = type_check_expr(stmt->as.return_stmt.value, table);
         if (value_type == NULL)
             return;
+        if (value_type->kind == TYPE_MAP)
+        {
+            type_error(stmt->token, "Maps cannot be returned from functions");
+            return;
+        }
     }
     else
     {
@@ -500,6 +1443,119 @@ static void type_check_for(Stmt *stmt, SymbolTable *table, Type *return_type)
     symbol_table_pop_scope(table);
 }
 
+static bool is_match_subject_type(Type *type)
+{
+    return type && (type->kind == TYPE_INT || type->kind == TYPE_LONG || type->kind == TYPE_CHAR ||
+                    type->kind == TYPE_BOOL || type->kind == TYPE_STRING);
+}
+
+static bool is_match_case_literal(Expr *value)
+{
+    if (value->type == EXPR_LITERAL)
+        return !value->as.literal.is_interpolated;
+    return value->type == EXPR_UNARY && value->as.unary.operator == TOKEN_MINUS &&
+           value->as.unary.operand->type == EXPR_LITERAL &&
+           (value->as.unary.operand->as.literal.type->kind == TYPE_INT ||
+            value->as.unary.operand->as.literal.type->kind == TYPE_LONG);
+}
+
+static bool match_case_values_equal(Expr *a, Expr *b, Type *subject_type)
+{
+    if (subject_type->kind == TYPE_STRING)
+    {
+        return strcmp(a->as.literal.value.string_value, b->as.literal.value.string_value) == 0;
+    }
+    if (subject_type->kind == TYPE_CHAR)
+    {
+        return a->as.literal.value.char_value == b->as.literal.value.char_value;
+    }
+    if (subject_type->kind == TYPE_BOOL)
+    {
+        return a->as.literal.value.bool_value == b->as.literal.value.bool_value;
+    }
+    int64_t left = a->type == EXPR_UNARY ? -a->as.unary.operand->as.literal.value.int_value
+                                         : a->as.literal.value.int_value;
+    int64_t right = b->type == EXPR_UNARY ? -b->as.unary.operand->as.literal.value.int_value
+                                          : b->as.literal.value.int_value;
+    return left == right;
+}
+
+// A bench body runs as its own void function, so it gets a fresh scope and
+// may only appear at module level.
+static void type_check_bench(Stmt *stmt, SymbolTable *table, Type *return_type)
+{
+    if (return_type != NULL)
+    {
+        type_error(stmt->token, "bench blocks are only allowed at module level");
+        return;
+    }
+    Type *void_type = ast_create_primitive_type(table->arena, TYPE_VOID);
+    symbol_table_push_scope(table);
+    for (int i = 0; i < stmt->as.bench.body_count; i++)
+    {
+        type_check_stmt(stmt->as.bench.body[i], table, void_type);
+    }
+    symbol_table_pop_scope(table);
+}
+
+static void type_check_match(Stmt *stmt, SymbolTable *table, Type *return_type)
+{
+    MatchStmt *match = &stmt->as.match_stmt;
+    Type *subject_type = type_check_expr(match->subject, table);
+    if (subject_type && !is_match_subject_type(subject_type))
+    {
+        type_error(match->subject->token, "Match subject must be int, long, char, bool or str");
+        subject_type = NULL;
+    }
+
+    for (int i = 0; i < match->case_count; i++)
+    {
+        MatchCase *match_case = &match->cases[i];
+        for (int j = 0; j < match_case->value_count; j++)
+        {
+            Expr *value = match_case->values[j];
+            // Checking first folds const references into literals.
+            Type *value_type = type_check_expr(value, table);
+            if (!is_match_case_literal(value))
+            {
+                type_error(value->token, "Match case values must be literals or consts");
+                continue;
+            }
+            if (subject_type == NULL || value_type == NULL)
+                continue;
+            bool integral = (subject_type->kind == TYPE_INT || subject_type->kind == TYPE_LONG) &&
+                            (value_type->kind == TYPE_INT || value_type->kind == TYPE_LONG);
+            if (!integral && !ast_type_equals(subject_type, value_type))
+            {
+                type_error(value->token, "Match case value does not match subject type");
+                continue;
+            }
+            for (int k = 0; k <= i; k++)
+            {
+                int limit = k == i ? j : match->cases[k].value_count;
+                for (int m = 0; m < limit; m++)
+                {
+                    if (is_match_case_literal(match->cases[k].values[m]) &&
+                        match_case_values_equal(match->cases[k].values[m], value, subject_type))
+                    {
+                        type_error(value->token, "Duplicate match case value");
+                    }
+                }
+            }
+        }
+        symbol_table_push_scope(table);
+        type_check_stmt(match_case->body, table, return_type);
+        symbol_table_pop_scope(table);
+    }
+
+    if (match->else_branch)
+    {
+        symbol_table_push_scope(table);
+        type_check_stmt(match->else_branch, table, return_type);
+        symbol_table_pop_scope(table);
+    }
+}
+
 static void type_check_stmt(Stmt *stmt, SymbolTable *table, Type *return_type)
 {
     if (stmt == NULL)
@@ -512,6 +1568,9 @@ static void type_check_stmt(Stmt *stmt, SymbolTable *table, Type *return_type)
     case STMT_VAR_DECL:
         type_check_var_decl(stmt, table, return_type);
         break;
+    case STMT_VAR_TUPLE:
+        type_check_var_tuple(stmt, table);
+        break;
     case STMT_FUNCTION:
         type_check_function(stmt, table);
         break;
@@ -530,6 +1589,12 @@ static void type_check_stmt(Stmt *stmt, SymbolTable *table, Type *return_type)
     case STMT_FOR:
         type_check_for(stmt, table, return_type);
         break;
+    case STMT_MATCH:
+        type_check_match(stmt, table, return_type);
+        break;
+    case STMT_BENCH:
+        type_check_bench(stmt, table, return_type);
+        break;
     case STMT_IMPORT:
         break;
     }
@@ -538,9 +1603,11 @@ static void type_check_stmt(Stmt *stmt, SymbolTable *table, Type *return_type)
 int type_check_module(Module *module, SymbolTable *table)
 {
     had_type_error = 0;
+    checked_module = module;
     for (int i = 0; i < module->count; i++)
     {
         type_check_stmt(module->statements[i], table, NULL);
     }
+    checked_module = NULL;
     return !had_type_error;
 }
\ No newline at end of file
@@ -2,9 +2,18 @@
 
 set -euox pipefail
 
-bin/sn samples/main.sn -o bin/hello-world.c -l 1 &> log/run-output.log
+# PROFILE selects the runtime-check profile (debug, release or unchecked).
+PROFILE="${PROFILE:-debug}"
 
-gcc -no-pie -fsanitize=address -fno-omit-frame-pointer -g -Wall -Wextra -std=c99 -D_GNU_SOURCE bin/hello-world.c bin/arena.o bin/debug.o bin/runtime.o -o bin/hello-world &> log/gcc-output.log
+bin/sn samples/main.sn -o bin/hello-world.c -l 1 --profile="$PROFILE" &> log/run-output.log
+
+if [ "$PROFILE" = "debug" ]; then
+    gcc -no-pie -fsanitize=address -fno-omit-frame-pointer -g -Wall -Wextra -std=c99 -D_GNU_SOURCE bin/hello-world.c bin/arena.o bin/debug.o bin/runtime.o -o bin/hello-world &> log/gcc-output.log
+else
+    # The objects in bin/ are built with AddressSanitizer, so compile the runtime alongside the program.
+    # Unchecked arithmetic is plain C, so -fwrapv makes signed overflow wrap instead of being undefined.
+    gcc -O2 -fwrapv -Wall -Wextra -std=c99 -D_GNU_SOURCE bin/hello-world.c compiler/runtime.c -o bin/hello-world &> log/gcc-output.log
+fi
 
 bin/hello-world &> log/hello-world-output.log
 cat log/hello-world-output.log